@@ -0,0 +1,93 @@
+#include "hpc_ids.h"
+
+// Alert path throughput: producer-side push cost and end-to-end drain rate
+// of the asynchronous writer, compared with the old synchronous fprintf path.
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void make_alert(anomaly_alert_t *alert, int i) {
+    memset(alert, 0, sizeof(anomaly_alert_t));
+    snprintf(alert->application_name, sizeof(alert->application_name), "app_%d", i % 32);
+    strcpy(alert->baseline_type, "per_app");
+    strcpy(alert->feature, feature_table[i % NUM_FEATURES].name);
+    alert->measured_value = 1.0 + i * 1e-3;
+    alert->baseline_median = 0.88;
+    alert->robust_z_score = 6.5;
+    alert->threshold = 5.0;
+    strcpy(alert->severity, "critical");
+    alert->timestamp = 1759420184 + i;
+    alert->count = 1;
+}
+
+static void bench_async(const char *path, int count, fsync_policy_t policy, const char *label) {
+    config_t config;
+    memset(&config, 0, sizeof(config));
+    strcpy(config.alert_output_file, path);
+    config.alert_queue_capacity = ALERT_QUEUE_CAPACITY;
+    config.alert_fsync_policy = policy;
+    config.alert_fsync_interval_ms = 100;
+    config.alert_echo_stderr = false;
+
+    unlink(path);
+    alert_writer_t writer;
+    if (alert_writer_start(&writer, &config) != 0) return;
+
+    anomaly_alert_t alert;
+    uint64_t pushed = 0;
+    double push_time = 0.0;
+    double start = now_seconds();
+
+    for (int i = 0; i < count; i++) {
+        make_alert(&alert, i);
+        double t0 = now_seconds();
+        if (alert_writer_push(&writer, &alert) == 0) pushed++;
+        push_time += now_seconds() - t0;
+    }
+
+    uint64_t dropped = writer.dropped;
+    alert_writer_stop(&writer);
+    double elapsed = now_seconds() - start;
+
+    printf("%-22s %8d alerts  push %7.1f ns/op  drain %10.0f alerts/s  dropped %lu\n",
+           label, count, push_time / count * 1e9, pushed / elapsed, (unsigned long)dropped);
+}
+
+static void bench_sync(const char *path, int count) {
+    unlink(path);
+    FILE *file = fopen(path, "a");
+    if (!file) return;
+
+    char line[ALERT_LINE_LEN];
+    anomaly_alert_t alert;
+    double start = now_seconds();
+    for (int i = 0; i < count; i++) {
+        make_alert(&alert, i);
+        format_alert_json(&alert, line, sizeof(line));
+        fputs(line, file);
+        fflush(file);
+    }
+    double elapsed = now_seconds() - start;
+    fclose(file);
+
+    printf("%-22s %8d alerts  call %7.1f ns/op  drain %10.0f alerts/s\n",
+           "sync fprintf+fflush", count, elapsed / count * 1e9, count / elapsed);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = argc > 1 ? argv[1] : "/tmp/hpc_ids_bench_alerts.jsonl";
+    int sizes[] = {1000, 100000};
+
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        bench_sync(path, sizes[s]);
+        bench_async(path, sizes[s], FSYNC_NONE, "async fsync=none");
+        bench_async(path, sizes[s], FSYNC_INTERVAL, "async fsync=interval");
+        bench_async(path, sizes[s], FSYNC_BATCH, "async fsync=batch");
+    }
+
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,684 @@
+#include "hpc_ids.h"
+#include <getopt.h>
+
+// Hot-path micro-benchmarks over synthetic inputs; no PMU access needed.
+// Each case is calibrated to a minimum trial time and run for several
+// trials, reporting the mean ns/op with a 95% confidence interval,
+// allocations per op and throughput. --json writes the results and
+// --compare checks them against an earlier file with Welch's t-test.
+
+#define TRIALS 10
+#define QUICK_TRIALS 5
+#define TRIAL_NS 20000000.0       // 20 ms per trial after calibration
+#define QUICK_TRIAL_NS 5000000.0
+#define REGRESSION_P 0.01         // significance level for a reported change
+#define REGRESSION_PCT 5.0        // smaller slowdowns are not worth failing on
+#define MAX_CASES 64
+
+// Every allocation in the process, libc-internal ones (strdup, fopen)
+// included, goes through these
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+static uint64_t allocations;
+
+void *malloc(size_t size) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    __atomic_fetch_add(&allocations, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+// Keeps results from being optimized away
+static volatile double sink;
+
+typedef struct {
+    const char *name;
+    int size;                 // case-specific input size, see the case setup
+    double bytes_per_op;      // input bytes per op for MB/s, 0 if not meaningful
+    void (*run)(void *state, uint64_t ops);
+    void *state;
+} bench_case_t;
+
+typedef struct {
+    const char *name;
+    int size;
+    int trials;
+    double mean;              // ns/op
+    double stddev;
+    double ci95;
+    double allocs_per_op;
+    double ops_per_sec;
+    double bytes_per_op;
+} bench_result_t;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Two-sided 95% Student t quantiles for 1..30 degrees of freedom
+static double t_quantile_95(int df) {
+    static const double table[] = {
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+    if (df < 1) return INFINITY;
+    return df <= 30 ? table[df - 1] : 1.960;
+}
+
+// Silence stdout while a case runs (load_config reports every key it reads)
+static int quiet_stdout(void) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDOUT_FILENO);
+        close(null_fd);
+    }
+    return saved;
+}
+
+static void restore_stdout(int saved) {
+    fflush(stdout);
+    if (saved >= 0) {
+        dup2(saved, STDOUT_FILENO);
+        close(saved);
+    }
+}
+
+static void run_case(const bench_case_t *bc, int trials, double trial_ns, bench_result_t *result) {
+    int saved = quiet_stdout();
+
+    // Double the op count until one trial takes long enough to time
+    uint64_t ops = 1;
+    bc->run(bc->state, 1);
+    for (;;) {
+        double start = now_ns();
+        bc->run(bc->state, ops);
+        double elapsed = now_ns() - start;
+        if (elapsed >= trial_ns || ops >= (1ULL << 40)) break;
+        ops = elapsed > trial_ns / 64 ? (uint64_t)(ops * trial_ns / elapsed) + 1 : ops * 8;
+    }
+
+    double samples[TRIALS];
+    uint64_t allocs_before = __atomic_load_n(&allocations, __ATOMIC_RELAXED);
+    for (int t = 0; t < trials; t++) {
+        double start = now_ns();
+        bc->run(bc->state, ops);
+        samples[t] = (now_ns() - start) / ops;
+    }
+    uint64_t allocs = __atomic_load_n(&allocations, __ATOMIC_RELAXED) - allocs_before;
+    restore_stdout(saved);
+
+    double sum = 0.0, sq = 0.0;
+    for (int t = 0; t < trials; t++) sum += samples[t];
+    double mean = sum / trials;
+    for (int t = 0; t < trials; t++) sq += (samples[t] - mean) * (samples[t] - mean);
+
+    result->name = bc->name;
+    result->size = bc->size;
+    result->trials = trials;
+    result->mean = mean;
+    result->stddev = trials > 1 ? sqrt(sq / (trials - 1)) : 0.0;
+    result->ci95 = t_quantile_95(trials - 1) * result->stddev / sqrt(trials);
+    result->allocs_per_op = (double)allocs / ((double)ops * trials);
+    result->ops_per_sec = mean > 0 ? 1e9 / mean : 0.0;
+    result->bytes_per_op = bc->bytes_per_op;
+}
+
+// --- parse_perf_line: size is the line length in bytes
+
+typedef struct {
+    char line[256];
+} parse_state_t;
+
+static void run_parse(void *state, uint64_t ops) {
+    parse_state_t *s = state;
+    hpc_measurement_t m;
+    for (uint64_t i = 0; i < ops; i++) {
+        parse_perf_line(s->line, 0.0, &m);
+        sink += m.value;
+    }
+}
+
+// --- engineer_features: size is the number of counters in the interval
+
+typedef struct {
+    hpc_measurement_t interval[MAX_EVENTS];
+    int count;
+} features_state_t;
+
+static void run_features(void *state, uint64_t ops) {
+    features_state_t *s = state;
+    feature_vector_t features;
+    for (uint64_t i = 0; i < ops; i++) {
+        engineer_features(s->interval, s->count, &features);
+        sink += features.ipc;
+    }
+}
+
+// --- compute_median, compute_mad, compute_baseline_stats: size is the sample count
+
+typedef struct {
+    double *values;
+    int count;
+} sample_state_t;
+
+static void run_median(void *state, uint64_t ops) {
+    sample_state_t *s = state;
+    for (uint64_t i = 0; i < ops; i++) sink += compute_median(s->values, s->count);
+}
+
+static void run_mad(void *state, uint64_t ops) {
+    sample_state_t *s = state;
+    for (uint64_t i = 0; i < ops; i++) sink += compute_mad(s->values, s->count, 1.0);
+}
+
+static void run_baseline_stats(void *state, uint64_t ops) {
+    sample_state_t *s = state;
+    baseline_stats_t stats;
+    for (uint64_t i = 0; i < ops; i++) {
+        compute_baseline_stats(&stats, s->values, s->count);
+        sink += stats.mad;
+    }
+}
+
+// --- detect_anomalies: size is the number of baseline phases
+
+typedef struct {
+    hpc_ids_t *ids;
+    target_state_t target;
+    feature_vector_t features[64];
+} detect_state_t;
+
+static void run_detect(void *state, uint64_t ops) {
+    detect_state_t *s = state;
+    for (uint64_t i = 0; i < ops; i++) {
+        sink += detect_anomalies(s->ids, &s->target, &s->features[i & 63]);
+    }
+}
+
+// --- telemetry_publish: one seqlock slot update per scored interval
+
+typedef struct {
+    pipeline_t pipeline;
+    telemetry_slot_t slot;
+    feature_vector_t features;
+} telemetry_state_t;
+
+static void run_telemetry(void *state, uint64_t ops) {
+    telemetry_state_t *s = state;
+    for (uint64_t i = 0; i < ops; i++) {
+        telemetry_publish(&s->pipeline, &s->features, (int)(i & 1));
+    }
+    sink += s->slot.sequence;
+}
+
+// --- log_alert: size is the alert format (0 jsonl, 1 binary)
+
+typedef struct {
+    hpc_ids_t *ids;
+    anomaly_alert_t alert;
+} alert_state_t;
+
+static void run_log_alert(void *state, uint64_t ops) {
+    alert_state_t *s = state;
+    for (uint64_t i = 0; i < ops; i++) {
+        s->alert.timestamp += 1.0;
+        log_alert(s->ids, &s->alert);
+    }
+}
+
+// --- load_config and load_baseline: size is the file size in bytes
+
+typedef struct {
+    char path[MAX_PATH_LEN];
+    hpc_ids_t *ids;
+} file_state_t;
+
+static void run_load_config(void *state, uint64_t ops) {
+    file_state_t *s = state;
+    for (uint64_t i = 0; i < ops; i++) {
+        load_config(&s->ids->config, s->path);
+        sink += s->ids->config.num_events;
+    }
+}
+
+static void run_load_baseline(void *state, uint64_t ops) {
+    file_state_t *s = state;
+    baseline_t baseline;
+    for (uint64_t i = 0; i < ops; i++) {
+        load_baseline(&baseline, s->path);
+        sink += baseline.ipc.median;
+    }
+}
+
+static long file_size(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : 0;
+}
+
+// Config with `events` perf events and `padding` keys the parser must skip
+static void write_config(const char *path, const char *alert_file, int events, int padding) {
+    static const char *names[] = {
+        "cycles", "instructions", "branches", "branch-misses", "cache-references", "cache-misses",
+        "L1-dcache-loads", "L1-dcache-load-misses", "iTLB-loads", "iTLB-load-misses",
+        "dTLB-loads", "dTLB-load-misses", "cpu-clock"
+    };
+    FILE *file = fopen(path, "w");
+    if (!file) return;
+    fprintf(file, "{\n");
+    for (int i = 0; i < padding; i++) {
+        fprintf(file, "  \"unused_option_%d\": {\"enabled\": true, \"weight\": %d.5},\n", i, i);
+    }
+    fprintf(file, "  \"sampling_interval_ms\": 200,\n  \"app_directory\": \"/tmp\",\n"
+                  "  \"baseline_directory\": \"/tmp\",\n  \"alert_output_file\": \"%s\",\n"
+                  "  \"alert_echo_stderr\": false,\n  \"baseline_hot_reload\": false,\n"
+                  "  \"robust_z_threshold_medium\": 3.0,\n  \"perf_events\": [", alert_file);
+    for (int e = 0; e < events; e++) fprintf(file, "%s\"%s\"", e ? ", " : "", names[e % 13]);
+    fprintf(file, "]\n}\n");
+    fclose(file);
+}
+
+// Baseline file in the collector's layout, optionally with phase sections
+static void write_baseline(const char *path, int phases) {
+    FILE *file = fopen(path, "w");
+    if (!file) return;
+    fprintf(file, "{\n  \"metadata\": {\n    \"application_name\": \"bench\",\n    \"runs_executed\": 10,\n"
+                  "    \"config\": {\"monitor_cpus\": \"2\"}\n  },\n  \"baseline_statistics\": {\n");
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        fprintf(file, "    \"%s\": {\n      \"median\": %.15f,\n      \"mad\": %.15f,\n"
+                      "      \"method\": \"robust_median_mad\",\n      \"min\": %.15f,\n      \"max\": %.15f,\n"
+                      "      \"median_ci\": 0.001,\n      \"mad_ci\": 0.001,\n      \"samples\": 500\n    }%s\n",
+                feature_table[f].name, 1.0 + f, 0.05, 0.5 + f, 1.5 + f, f < NUM_FEATURES - 1 ? "," : "");
+    }
+    fprintf(file, "  }%s\n", phases > 1 ? "," : "");
+    if (phases > 1) {
+        fprintf(file, "  \"phases\": [\n");
+        for (int p = 0; p < phases; p++) {
+            fprintf(file, "    {\n      \"weight\": %.6f,\n      \"centroid\": {", 1.0 / phases);
+            for (int f = 0; f < NUM_FEATURES; f++) {
+                fprintf(file, "%s\"%s\": %.15f", f ? ", " : "", feature_table[f].name, 1.0 + f + 0.3 * p);
+            }
+            fprintf(file, "},\n      \"statistics\": {\n");
+            for (int f = 0; f < NUM_FEATURES; f++) {
+                fprintf(file, "        \"%s\": {\"median\": %.15f, \"mad\": 0.02, \"min\": 0.1, \"max\": 9.0, "
+                              "\"median_ci\": 0.001, \"mad_ci\": 0.001, \"samples\": 100}%s\n",
+                        feature_table[f].name, 1.0 + f + 0.3 * p, f < NUM_FEATURES - 1 ? "," : "");
+            }
+            fprintf(file, "      }\n    }%s\n", p < phases - 1 ? "," : "");
+        }
+        fprintf(file, "  ]\n");
+    }
+    fprintf(file, "}\n");
+    fclose(file);
+}
+
+static hpc_ids_t* make_ids(const char *config_path) {
+    hpc_ids_t *ids = calloc(1, sizeof(hpc_ids_t));
+    int saved = quiet_stdout();
+    int status = load_config(&ids->config, config_path);
+    restore_stdout(saved);
+    if (status != 0) {
+        free(ids);
+        return NULL;
+    }
+    pthread_mutex_init(&ids->baseline_lock, NULL);
+    ids->baseline_epoch = 1;
+    strcpy(ids->global_entry.name, BASELINE_STORE_GLOBAL);
+    ids->global_entry.current = &ids->global_baseline;
+    return ids;
+}
+
+static void free_ids(hpc_ids_t *ids) {
+    int saved = quiet_stdout();
+    alert_writer_stop(&ids->alert_writer);
+    restore_stdout(saved);
+    pthread_mutex_destroy(&ids->baseline_lock);
+    free(ids);
+}
+
+// Whole-run statistics around 1.0 + f, with `phases` nearest-centroid
+// phases spread 0.3 apart when phases > 1
+static void make_baseline(baseline_t *baseline, int phases) {
+    memset(baseline, 0, sizeof(baseline_t));
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        baseline_stats_t *stats = (baseline_stats_t *)((char *)baseline + feature_table[f].baseline_offset);
+        stats->median = 1.0 + f;
+        stats->mad = 0.05;
+        for (int p = 0; p < phases && phases > 1; p++) {
+            baseline->phases[p].stats[f].median = 1.0 + f + 0.3 * p;
+            baseline->phases[p].stats[f].mad = 0.02;
+            baseline->centroids[f][p] = 1.0 + f + 0.3 * p;
+        }
+    }
+    baseline->num_phases = phases > 1 ? phases : 0;
+    prepare_baseline_scoring(baseline);
+}
+
+static int write_json(const char *path, const bench_result_t *results, int count) {
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        fprintf(stderr, "Cannot write %s\n", path);
+        return -1;
+    }
+    fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (int i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        fprintf(file, "    {\"name\": \"%s\", \"size\": %d, \"trials\": %d, \"ns_per_op\": %.3f, "
+                      "\"stddev\": %.3f, \"ci95\": %.3f, \"allocs_per_op\": %.3f, \"ops_per_sec\": %.1f, "
+                      "\"bytes_per_op\": %.1f}%s\n",
+                r->name, r->size, r->trials, r->mean, r->stddev, r->ci95, r->allocs_per_op,
+                r->ops_per_sec, r->bytes_per_op, i < count - 1 ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return 0;
+}
+
+// Returns the number of significant regressions against the reference file
+static int compare_results(const char *path, const bench_result_t *results, int count) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open reference results %s\n", path);
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *text = malloc(size + 1);
+    size_t length = fread(text, 1, size, file);
+    text[length] = '\0';
+    fclose(file);
+
+    json_doc_t doc;
+    if (json_parse(&doc, text, length) != 0) {
+        fprintf(stderr, "Cannot parse reference results %s\n", path);
+        free(text);
+        return -1;
+    }
+
+    printf("\nAgainst %s (Welch t-test, p < %.2f):\n", path, REGRESSION_P);
+    int regressions = 0;
+    int benchmarks = json_find(&doc, 0, "benchmarks");
+    for (int i = 0; i < count; i++) {
+        const bench_result_t *r = &results[i];
+        bool found = false;
+        size_t child = benchmarks + 1;
+        for (uint32_t k = 0; benchmarks >= 0 && k < doc.tokens[benchmarks].size && !found; k++) {
+            char name[64];
+            int size = -1, trials = 0;
+            double mean = 0.0, stddev = 0.0;
+            json_get_string(&doc, child, "name", name, sizeof(name));
+            json_get_int(&doc, child, "size", &size);
+            if (strcmp(name, r->name) == 0 && size == r->size) {
+                found = true;
+                json_get_int(&doc, child, "trials", &trials);
+                json_get_double(&doc, child, "ns_per_op", &mean);
+                json_get_double(&doc, child, "stddev", &stddev);
+
+                double t;
+                double p = welch_t_test(r->mean, r->stddev * r->stddev, r->trials,
+                                        mean, stddev * stddev, trials, &t);
+                double change = mean > 0 ? (r->mean - mean) / mean * 100.0 : 0.0;
+                const char *verdict = "no significant change";
+                if (p < REGRESSION_P && change > REGRESSION_PCT) {
+                    verdict = "REGRESSION";
+                    regressions++;
+                } else if (p < REGRESSION_P && change < -REGRESSION_PCT) {
+                    verdict = "improved";
+                } else if (p < REGRESSION_P) {
+                    verdict = "within tolerance";
+                }
+                printf("  %-24s %6d  %10.1f -> %10.1f ns/op  %+6.1f%%  p=%.4f  %s\n",
+                       r->name, r->size, mean, r->mean, change, p, verdict);
+            }
+            child = doc.tokens[child].next;
+        }
+        if (!found) printf("  %-24s %6d  not in reference\n", r->name, r->size);
+    }
+
+    json_free(&doc);
+    free(text);
+    return regressions;
+}
+
+static void print_usage(const char *program_name) {
+    printf("Usage: %s [OPTIONS]\n", program_name);
+    printf("Hot-path micro-benchmarks (no PMU access needed)\n\n");
+    printf("Options:\n");
+    printf("  -j, --json FILE        Write results as JSON\n");
+    printf("  -c, --compare FILE     Compare with earlier --json results, exit 2 on a regression\n");
+    printf("  -f, --filter NAME      Only run cases whose name contains NAME\n");
+    printf("  -q, --quick            Fewer, shorter trials\n");
+    printf("  -h, --help             Show this help message\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *json_path = NULL;
+    const char *compare_path = NULL;
+    const char *filter = NULL;
+    bool quick = false;
+    int opt;
+
+    static struct option long_options[] = {
+        {"json",    required_argument, 0, 'j'},
+        {"compare", required_argument, 0, 'c'},
+        {"filter",  required_argument, 0, 'f'},
+        {"quick",   no_argument,       0, 'q'},
+        {"help",    no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "j:c:f:qh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'j': json_path = optarg; break;
+            case 'c': compare_path = optarg; break;
+            case 'f': filter = optarg; break;
+            case 'q': quick = true; break;
+            case 'h': print_usage(argv[0]); return 0;
+            default: print_usage(argv[0]); return 1;
+        }
+    }
+
+    char dir[] = "/tmp/hpc_ids_bench_XXXXXX";
+    if (!mkdtemp(dir)) {
+        perror("mkdtemp");
+        return 1;
+    }
+
+    bench_case_t cases[MAX_CASES];
+    int num_cases = 0;
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+
+    // parse_perf_line: minimal, full perf -x , and long raw-event lines
+    static const char *lines[] = {
+        "1.0,1000,,cycles\n",
+        "     1.000362573,1234567890,,instructions,200184635,100.00,,\n",
+        "   123.000362573,98765432101234,,cpu/event=0x3c,umask=0x00,name=unhalted_core_cycles/,"
+        "200184635,100.00,3.45,GHz\n",
+    };
+    parse_state_t parse[3];
+    for (int i = 0; i < 3; i++) {
+        strcpy(parse[i].line, lines[i]);
+        int len = (int)strlen(lines[i]);
+        cases[num_cases++] = (bench_case_t){"parse_perf_line", len, len, run_parse, &parse[i]};
+    }
+
+    // engineer_features: the basic three counters, a full interval, and a
+    // full interval padded with counters it does not use
+    static const char *counters[] = {
+        "cycles", "instructions", "branches", "branch-misses", "cache-references", "cache-misses",
+        "L1-dcache-loads", "L1-dcache-load-misses", "iTLB-loads", "iTLB-load-misses",
+        "dTLB-loads", "dTLB-load-misses", "cpu-clock", "task-clock", "page-faults", "context-switches"
+    };
+    static const int counter_counts[] = {3, 13, 16};
+    features_state_t features[3];
+    for (int i = 0; i < 3; i++) {
+        features[i].count = counter_counts[i];
+        for (int c = 0; c < counter_counts[i]; c++) {
+            hpc_measurement_t *m = &features[i].interval[c];
+            memset(m, 0, sizeof(*m));
+            strcpy(m->counter, counters[c]);
+            m->value = 1000000 + c * 1000;
+            m->perf_time = 1.0;
+        }
+        cases[num_cases++] = (bench_case_t){"engineer_features", counter_counts[i], 0, run_features, &features[i]};
+    }
+
+    // Order statistics over realistic sample counts
+    static const int sample_counts[] = {64, 1024, 16384};
+    sample_state_t samples[3];
+    for (int i = 0; i < 3; i++) {
+        samples[i].count = sample_counts[i];
+        samples[i].values = malloc(sample_counts[i] * sizeof(double));
+        for (int k = 0; k < sample_counts[i]; k++) {
+            rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+            samples[i].values[k] = 1.0 + (rng >> 11) * (1.0 / 9007199254740992.0) * 0.2;
+        }
+    }
+    for (int i = 0; i < 3; i++) {
+        cases[num_cases++] = (bench_case_t){"compute_median", sample_counts[i],
+                                            sample_counts[i] * sizeof(double), run_median, &samples[i]};
+    }
+    for (int i = 0; i < 3; i++) {
+        cases[num_cases++] = (bench_case_t){"compute_mad", sample_counts[i],
+                                            sample_counts[i] * sizeof(double), run_mad, &samples[i]};
+    }
+    for (int i = 0; i < 3; i++) {
+        cases[num_cases++] = (bench_case_t){"compute_baseline_stats", sample_counts[i],
+                                            sample_counts[i] * sizeof(double), run_baseline_stats, &samples[i]};
+    }
+
+    // detect_anomalies on in-range intervals, single-phase and phased baselines
+    char config_path[MAX_PATH_LEN], alert_path[MAX_PATH_LEN];
+    snprintf(config_path, sizeof(config_path), "%s/config.json", dir);
+    snprintf(alert_path, sizeof(alert_path), "%s/alerts.jsonl", dir);
+    write_config(config_path, alert_path, 13, 0);
+
+    static const int phase_counts[] = {1, 2, 4};
+    detect_state_t detect[3];
+    for (int i = 0; i < 3; i++) {
+        detect[i].ids = make_ids(config_path);
+        if (!detect[i].ids) return 1;
+        make_baseline(&detect[i].ids->global_baseline, phase_counts[i]);
+        start_alert_output(detect[i].ids);
+        attach_target(detect[i].ids, &detect[i].target, NULL, 0);
+        for (int k = 0; k < 64; k++) {
+            feature_vector_t *fv = &detect[i].features[k];
+            int phase = k % phase_counts[i];
+            fv->wall_time = 1000.0 + k;
+            for (int f = 0; f < NUM_FEATURES; f++) {
+                *(double *)((char *)fv + feature_table[f].value_offset) = 1.0 + f + 0.3 * phase + 0.001 * (k % 7);
+            }
+        }
+        cases[num_cases++] = (bench_case_t){"detect_anomalies", phase_counts[i], 0, run_detect, &detect[i]};
+    }
+
+    // telemetry_publish into a private slot; the shared mapping costs the same
+    telemetry_state_t *telemetry = calloc(1, sizeof(telemetry_state_t));
+    if (!telemetry) return 1;
+    run_detect(&detect[0], 1);
+    telemetry->pipeline.ids = detect[0].ids;
+    telemetry->pipeline.target = &detect[0].target;
+    telemetry->pipeline.telemetry = &telemetry->slot;
+    telemetry->features = detect[0].features[0];
+    cases[num_cases++] = (bench_case_t){"telemetry_publish", 1, sizeof(telemetry_slot_t), run_telemetry, telemetry};
+
+    // log_alert through the writer thread, blocking so the rate is sustained
+    alert_state_t alerts[2];
+    for (int i = 0; i < 2; i++) {
+        alerts[i].ids = make_ids(config_path);
+        if (!alerts[i].ids) return 1;
+        alerts[i].ids->config.alert_queue_blocking = true;
+        alerts[i].ids->config.alert_format = i == 0 ? ALERT_FORMAT_JSONL : ALERT_FORMAT_BINARY;
+        snprintf(alerts[i].ids->config.alert_output_file, MAX_PATH_LEN, "%s/alerts_%d.%s", dir, i,
+                 i == 0 ? "jsonl" : "hal");
+        if (start_alert_output(alerts[i].ids) != 0) return 1;
+        anomaly_alert_t *alert = &alerts[i].alert;
+        memset(alert, 0, sizeof(*alert));
+        strcpy(alert->target, "pid:4242");
+        strcpy(alert->application_name, "matmul");
+        strcpy(alert->baseline_type, "per_app");
+        strcpy(alert->feature, "ipc");
+        strcpy(alert->severity, "critical");
+        alert->measured_value = 0.42;
+        alert->baseline_median = 1.37;
+        alert->robust_z_score = -7.5;
+        alert->threshold = 5.0;
+        alert->timestamp = 1759420184;
+        alert->count = 1;
+        cases[num_cases++] = (bench_case_t){"log_alert", i, 0, run_log_alert, &alerts[i]};
+    }
+
+    // load_config: the shipped size, and with many keys it has to skip
+    static const int paddings[] = {0, 100, 1000};
+    file_state_t configs[3];
+    hpc_ids_t *config_ids = calloc(1, sizeof(hpc_ids_t));
+    for (int i = 0; i < 3; i++) {
+        snprintf(configs[i].path, sizeof(configs[i].path), "%s/config_%d.json", dir, i);
+        write_config(configs[i].path, alert_path, 13, paddings[i]);
+        configs[i].ids = config_ids;
+        long size = file_size(configs[i].path);
+        cases[num_cases++] = (bench_case_t){"load_config", (int)size, size, run_load_config, &configs[i]};
+    }
+
+    // load_baseline: single-phase and phased baselines
+    static const int baseline_phases[] = {1, 4};
+    file_state_t baselines[2];
+    for (int i = 0; i < 2; i++) {
+        snprintf(baselines[i].path, sizeof(baselines[i].path), "%s/baseline_%d.json", dir, i);
+        write_baseline(baselines[i].path, baseline_phases[i]);
+        long size = file_size(baselines[i].path);
+        cases[num_cases++] = (bench_case_t){"load_baseline", (int)size, size, run_load_baseline, &baselines[i]};
+    }
+
+    int trials = quick ? QUICK_TRIALS : TRIALS;
+    double trial_ns = quick ? QUICK_TRIAL_NS : TRIAL_NS;
+    bench_result_t results[MAX_CASES];
+    int num_results = 0;
+
+    printf("%-24s %6s  %12s %10s  %10s  %12s  %10s\n",
+           "benchmark", "size", "ns/op", "+/- 95%", "allocs/op", "ops/s", "MB/s");
+    for (int i = 0; i < num_cases; i++) {
+        if (filter && !strstr(cases[i].name, filter)) continue;
+        bench_result_t *r = &results[num_results++];
+        run_case(&cases[i], trials, trial_ns, r);
+        printf("%-24s %6d  %12.1f %10.1f  %10.2f  %12.0f  %10.1f\n", r->name, r->size, r->mean, r->ci95,
+               r->allocs_per_op, r->ops_per_sec, r->bytes_per_op * r->ops_per_sec / 1e6);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        detach_target(detect[i].ids, &detect[i].target);
+        free_ids(detect[i].ids);
+        free(samples[i].values);
+    }
+    for (int i = 0; i < 2; i++) free_ids(alerts[i].ids);
+    free(telemetry);
+    free(config_ids);
+
+    int status = 0;
+    if (json_path && write_json(json_path, results, num_results) != 0) status = 1;
+    if (compare_path) {
+        int regressions = compare_results(compare_path, results, num_results);
+        if (regressions < 0) status = 1;
+        else if (regressions > 0) status = 2;
+    }
+
+    // Remove the alert outputs and the scratch directory
+    char command[MAX_PATH_LEN + 16];
+    snprintf(command, sizeof(command), "rm -rf %s", dir);
+    if (system(command) != 0) fprintf(stderr, "Warning: could not remove %s\n", dir);
+    return status;
+}
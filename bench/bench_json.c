@@ -0,0 +1,173 @@
+#include "hpc_ids.h"
+
+// Baseline parsing throughput: the old strstr-per-key extraction against the
+// single-pass tokenizer with path lookups, on baseline-shaped documents, and
+// the tokenizer again with several threads loading documents in parallel.
+
+#define BENCH_THREADS 4
+
+// Keeps the loaders from being optimized away
+static volatile double sink;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Baseline document with `padding` extra metadata entries ahead of the statistics
+static char* make_document(int app, int padding, size_t *length) {
+    size_t capacity = 4096 + (size_t)padding * 64;
+    char *doc = malloc(capacity);
+    size_t len = snprintf(doc, capacity, "{\n  \"metadata\": {\n    \"application_name\": \"app_%d\",\n", app);
+    for (int i = 0; i < padding; i++) {
+        len += snprintf(doc + len, capacity - len, "    \"run_%d\": {\"samples\": %d, \"ok\": true},\n", i, i);
+    }
+    len += snprintf(doc + len, capacity - len, "    \"runs_executed\": 3\n  },\n  \"baseline_statistics\": {\n");
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        len += snprintf(doc + len, capacity - len,
+                        "    \"%s\": {\n      \"median\": %.15f,\n      \"mad\": %.15f,\n"
+                        "      \"method\": \"robust_median_mad\",\n      \"min\": %.15f,\n"
+                        "      \"max\": %.15f,\n      \"samples\": %d\n    }%s\n",
+                        feature_table[f].name, 0.5 + app * 1e-3 + f, 0.02 + f * 1e-3, 0.4 + f, 0.6 + f,
+                        200 + app, f < NUM_FEATURES - 1 ? "," : "");
+    }
+    len += snprintf(doc + len, capacity - len, "  }\n}\n");
+    *length = len;
+    return doc;
+}
+
+// The extraction scheme simple_json.c used before the tokenizer
+static double legacy_double(const char *json, const char *key) {
+    char pattern[128];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *start = strstr(json, pattern);
+    if (!start) return -1.0;
+    start += strlen(pattern);
+    while (*start == ' ' || *start == '\t' || *start == '\n') start++;
+    return atof(start);
+}
+
+static void legacy_load(const char *json, baseline_t *baseline) {
+    const char *stats = strstr(json, "\"baseline_statistics\":");
+    if (!stats) return;
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        char pattern[64];
+        snprintf(pattern, sizeof(pattern), "\"%s\":", feature_table[f].name);
+        const char *section = strstr(stats, pattern);
+        if (!section) continue;
+        baseline_stats_t *s = (baseline_stats_t *)((char *)baseline + feature_table[f].baseline_offset);
+        s->median = legacy_double(section, "median");
+        s->mad = legacy_double(section, "mad");
+        s->min = legacy_double(section, "min");
+        s->max = legacy_double(section, "max");
+        s->samples = (int)legacy_double(section, "samples");
+    }
+}
+
+static void token_load(const char *json, size_t length, baseline_t *baseline) {
+    json_doc_t doc;
+    if (json_parse(&doc, json, length) != 0) return;
+    int statistics = json_find(&doc, 0, "baseline_statistics");
+    for (int f = 0; statistics >= 0 && f < NUM_FEATURES; f++) {
+        int section = json_find(&doc, statistics, feature_table[f].name);
+        if (section < 0) continue;
+        baseline_stats_t *s = (baseline_stats_t *)((char *)baseline + feature_table[f].baseline_offset);
+        json_get_double(&doc, section, "median", &s->median);
+        json_get_double(&doc, section, "mad", &s->mad);
+        json_get_double(&doc, section, "min", &s->min);
+        json_get_double(&doc, section, "max", &s->max);
+        json_get_int(&doc, section, "samples", &s->samples);
+    }
+    json_free(&doc);
+}
+
+typedef struct {
+    char **docs;
+    size_t *lengths;
+    int first;
+    int count;
+    double checksum;
+} worker_t;
+
+static void* token_worker(void *arg) {
+    worker_t *w = arg;
+    baseline_t baseline;
+    for (int i = w->first; i < w->first + w->count; i++) {
+        memset(&baseline, 0, sizeof(baseline));
+        token_load(w->docs[i], w->lengths[i], &baseline);
+        w->checksum += baseline.dtlb_mpki.median;
+    }
+    return NULL;
+}
+
+static void bench_set(int num_docs, int padding) {
+    char **docs = malloc(num_docs * sizeof(char *));
+    size_t *lengths = malloc(num_docs * sizeof(size_t));
+    size_t total_bytes = 0;
+    for (int i = 0; i < num_docs; i++) {
+        docs[i] = make_document(i, padding, &lengths[i]);
+        total_bytes += lengths[i];
+    }
+    double mb = total_bytes / 1e6;
+
+    baseline_t legacy, parsed;
+    double checksum = 0.0;
+    int mismatches = 0;
+
+    double start = now_seconds();
+    for (int i = 0; i < num_docs; i++) {
+        memset(&legacy, 0, sizeof(legacy));
+        legacy_load(docs[i], &legacy);
+        checksum += legacy.dtlb_mpki.median;
+    }
+    double legacy_time = now_seconds() - start;
+
+    start = now_seconds();
+    for (int i = 0; i < num_docs; i++) {
+        memset(&parsed, 0, sizeof(parsed));
+        token_load(docs[i], lengths[i], &parsed);
+        checksum -= parsed.dtlb_mpki.median;
+    }
+    double token_time = now_seconds() - start;
+
+    // Spot-check that both loaders agree
+    memset(&legacy, 0, sizeof(legacy));
+    memset(&parsed, 0, sizeof(parsed));
+    legacy_load(docs[num_docs - 1], &legacy);
+    token_load(docs[num_docs - 1], lengths[num_docs - 1], &parsed);
+    if (memcmp(&legacy, &parsed, sizeof(baseline_t)) != 0) mismatches++;
+
+    pthread_t threads[BENCH_THREADS];
+    worker_t workers[BENCH_THREADS];
+    start = now_seconds();
+    for (int t = 0; t < BENCH_THREADS; t++) {
+        workers[t].docs = docs;
+        workers[t].lengths = lengths;
+        workers[t].first = t * num_docs / BENCH_THREADS;
+        workers[t].count = (t + 1) * num_docs / BENCH_THREADS - workers[t].first;
+        workers[t].checksum = 0.0;
+        pthread_create(&threads[t], NULL, token_worker, &workers[t]);
+    }
+    for (int t = 0; t < BENCH_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        checksum += workers[t].checksum;
+    }
+    double parallel_time = now_seconds() - start;
+
+    printf("%6d docs x %6.1f KB  strstr %8.1f MB/s  tokenizer %8.1f MB/s  %d threads %8.1f MB/s%s\n",
+           num_docs, total_bytes / 1024.0 / num_docs, mb / legacy_time, mb / token_time,
+           BENCH_THREADS, mb / parallel_time, mismatches ? "  MISMATCH" : "");
+    sink = checksum;
+
+    for (int i = 0; i < num_docs; i++) free(docs[i]);
+    free(docs);
+    free(lengths);
+}
+
+int main(void) {
+    bench_set(10000, 0);
+    bench_set(1000, 100);
+    bench_set(100, 2000);
+    return 0;
+}
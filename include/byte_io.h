@@ -0,0 +1,82 @@
+#ifndef BYTE_IO_H
+#define BYTE_IO_H
+
+// Helpers shared by the binary formats (alert log, alert store, counter
+// traces). Include after hpc_ids.h.
+
+#include <stdint.h>
+
+// Little-endian field encoding; a plain memcpy on little-endian hosts
+static inline void put_u16(uint8_t *p, uint16_t v) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    memcpy(p, &v, sizeof(v));
+#else
+    p[0] = v; p[1] = v >> 8;
+#endif
+}
+
+static inline void put_u32(uint8_t *p, uint32_t v) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    memcpy(p, &v, sizeof(v));
+#else
+    for (int i = 0; i < 4; i++) p[i] = v >> (8 * i);
+#endif
+}
+
+static inline void put_u64(uint8_t *p, uint64_t v) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    memcpy(p, &v, sizeof(v));
+#else
+    for (int i = 0; i < 8; i++) p[i] = v >> (8 * i);
+#endif
+}
+
+static inline uint16_t get_u16(const uint8_t *p) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint16_t v; memcpy(&v, p, sizeof(v)); return v;
+#else
+    return p[0] | (p[1] << 8);
+#endif
+}
+
+static inline uint32_t get_u32(const uint8_t *p) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t v; memcpy(&v, p, sizeof(v)); return v;
+#else
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+#endif
+}
+
+static inline uint64_t get_u64(const uint8_t *p) {
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v; memcpy(&v, p, sizeof(v)); return v;
+#else
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+#endif
+}
+
+static inline void put_f64(uint8_t *p, double v) { uint64_t u; memcpy(&u, &v, 8); put_u64(p, u); }
+static inline void put_f32(uint8_t *p, float v) { uint32_t u; memcpy(&u, &v, 4); put_u32(p, u); }
+static inline double get_f64(const uint8_t *p) { uint64_t u = get_u64(p); double v; memcpy(&v, &u, 8); return v; }
+static inline float get_f32(const uint8_t *p) { uint32_t u = get_u32(p); float v; memcpy(&v, &u, 4); return v; }
+
+// write() until all of data is out, retrying on EINTR and short writes
+static inline int write_all(int fd, const void *data, size_t size) {
+    const char *p = data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        size -= n;
+    }
+    return 0;
+}
+
+#endif
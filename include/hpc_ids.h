@@ -13,17 +13,25 @@
 #include <signal.h>
 #include <math.h>
 #include <stdint.h>
+#include <limits.h>
 #include <stdbool.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
 
 #define MAX_EVENTS 16
-#define MAX_APPS 64
-#define MAX_SAMPLES 10000
+#define MAX_PHASES 4
 #define MAX_PATH_LEN 256
 #define MAX_LINE_LEN 1024
+#define CPU_LIST_LEN 64   // cpulist strings such as "0-3,8,10-11"
 #define SAMPLING_INTERVAL_MS 200
+#define ALERT_QUEUE_CAPACITY 4096
+#define ALERT_BATCH_SIZE 64
+#define CACHE_LINE_SIZE 64
+#define PIPELINE_STAGES 4
+#define PIPELINE_QUEUE_CAPACITY 64
 
 typedef struct {
     double wall_time;
@@ -33,6 +41,9 @@ typedef struct {
     int duration_ms;
 } hpc_measurement_t;
 
+// Called with the counters of one complete perf interval; non-zero stops the stream
+typedef int (*perf_interval_fn)(void *context, hpc_measurement_t *measurements, int count);
+
 typedef struct {
     double wall_time;
     double ipc;
@@ -41,17 +52,51 @@ typedef struct {
     double l1d_mpki;
     double itlb_mpki;
     double dtlb_mpki;
+    double package_joules;
+    double core_joules;
+    double dram_joules;
+    double nj_per_instruction;   // package energy per retired instruction
+    uint32_t energy_mask;        // energy features measured in this interval
 } feature_vector_t;
 
+// Scored features, in feature_vector_t/baseline_t field order
+typedef enum {
+    FEATURE_IPC,
+    FEATURE_BRANCH_MISS_RATE,
+    FEATURE_CACHE_MISS_RATE,
+    FEATURE_L1D_MPKI,
+    FEATURE_ITLB_MPKI,
+    FEATURE_DTLB_MPKI,
+    FEATURE_PACKAGE_JOULES,
+    FEATURE_CORE_JOULES,
+    FEATURE_DRAM_JOULES,
+    FEATURE_NJ_PER_INSTRUCTION,
+    NUM_FEATURES
+} feature_id_t;
+
+// Energy features are optional: they are scored only when both the interval
+// and the baseline have them, so baselines collected without RAPL still work
+#define ENERGY_FEATURE_MASK (((1u << NUM_FEATURES) - 1) & ~((1u << FEATURE_PACKAGE_JOULES) - 1))
+
 typedef struct {
     double median;
     double mad;
     double min;
     double max;
     int samples;
+    double inv_mad;      // precomputed 1 / max(mad, epsilon) for scoring
+    double median_ci;    // 95% confidence half-widths of median and mad
+    double mad_ci;
 } baseline_stats_t;
 
+// One execution phase of an app (e.g. I/O, compute, communication)
+typedef struct {
+    double weight;                        // fraction of baseline samples in the phase
+    baseline_stats_t stats[NUM_FEATURES]; // indexed by feature_id_t
+} baseline_phase_t;
+
 typedef struct {
+    char target[64];
     char application_name[128];
     char baseline_type[32];
     char feature[64];
@@ -61,8 +106,50 @@ typedef struct {
     double threshold;
     char severity[16];
     double timestamp;
+    char placement[CPU_LIST_LEN];   // monitor CPU list in effect, empty if unpinned
+    int phase;            // 1-based baseline phase the interval matched, 0 if single-phase
+    // Set on records covering several anomalies: the features of an interval
+    // that left cooldown together, or those suppressed during cooldown
+    bool aggregated;
+    int count;
+    double first_seen;
+    double last_seen;
+    uint32_t feature_mask;
 } anomaly_alert_t;
 
+// Longest line format_alert_json can produce: the fixed text and integers,
+// every string at its field size, seven %f numbers (a finite double prints
+// up to 309 integer digits) and every feature in an aggregate's list
+#define ALERT_FIELD_SIZE(field) sizeof(((anomaly_alert_t *)0)->field)
+#define ALERT_NUMBER_LEN 320
+#define ALERT_LINE_LEN (320 + ALERT_FIELD_SIZE(application_name) + ALERT_FIELD_SIZE(baseline_type) + \
+                        ALERT_FIELD_SIZE(feature) + ALERT_FIELD_SIZE(severity) + ALERT_FIELD_SIZE(placement) + \
+                        7 * ALERT_NUMBER_LEN + NUM_FEATURES * (ALERT_FIELD_SIZE(feature) + 3))
+
+typedef enum {
+    ALERT_FORMAT_JSONL,
+    ALERT_FORMAT_BINARY
+} alert_format_t;
+
+typedef enum {
+    FSYNC_NONE,
+    FSYNC_BATCH,
+    FSYNC_INTERVAL
+} fsync_policy_t;
+
+typedef enum {
+    ENERGY_SOURCE_OFF,
+    ENERGY_SOURCE_RAPL,    // powercap zones only
+    ENERGY_SOURCE_MODEL    // RAPL, else package power modeled from utilization
+} energy_source_t;
+
+// How far apart concurrent collection runs are kept
+typedef enum {
+    ISOLATION_NONE,   // any allowed CPU
+    ISOLATION_SMT,    // one CPU per physical core
+    ISOLATION_LLC     // one CPU per last-level cache
+} isolation_policy_t;
+
 typedef struct {
     char app_directory[MAX_PATH_LEN];
     char baseline_directory[MAX_PATH_LEN];
@@ -71,12 +158,44 @@ typedef struct {
     int runs_per_app;
     int min_samples_per_app;
     int max_runtime_seconds;
-    int core_affinity;
+    double warmup_seconds;        // intervals this early in a collection run are dropped
+    int max_phases;               // upper bound on baseline phases, 1 = single-phase
+    double convergence_tolerance; // stop collecting once CIs are this tight (MAD units), 0 = fixed runs
+    int min_runs_per_app;         // runs before convergence is first checked
+    int max_runs_per_app;         // cap on runs in convergence mode
+    int collection_memory_mb;     // budget for collected feature samples
+    int core_affinity;            // single monitor CPU when monitor_cpus is empty, -1 = unpinned
+    char monitor_cpus[CPU_LIST_LEN];       // cpulist for the monitored workload
+    char housekeeping_cpus[CPU_LIST_LEN];  // cpulist for the IDS, perf and helper threads
     double robust_z_threshold_medium;
     double robust_z_threshold_high;
     double robust_z_threshold_critical;
     int alert_cooldown_seconds;
+    alert_format_t alert_format;
+    char alert_store_directory[MAX_PATH_LEN];
+    int alert_segment_max_mb;
+    int alert_segment_max_seconds;
+    int alert_retention_days;
+    char baseline_store_file[MAX_PATH_LEN];
+    char trace_directory[MAX_PATH_LEN];   // raw counter traces per target, empty = off
+    char telemetry_shm[64];       // shared-memory name for hpc_ids_top, empty = off
+    int baseline_cache_size;
+    bool baseline_hot_reload;
+    int alert_queue_capacity;
+    bool alert_queue_blocking;    // wait for room instead of dropping (replay)
+    bool quiet;                   // embedded: nothing on stdout, warnings still on stderr
+    fsync_policy_t alert_fsync_policy;
+    int alert_fsync_interval_ms;
+    bool alert_echo_stderr;
+    int collection_parallelism;   // concurrent runs, 0 = one per isolated CPU
+    isolation_policy_t collection_isolation;
     bool use_robust_statistics;
+    energy_source_t energy_source;
+    double energy_idle_watts;     // utilization model at 0% and 100% busy
+    double energy_max_watts;
+    bool pipeline_threads;        // feature and scoring stages on their own threads
+    int pipeline_queue_capacity;  // intervals between stages
+    int pipeline_cpus[PIPELINE_STAGES]; // per pipeline_stage_id_t, -1 = inherit
     char perf_events[MAX_EVENTS][64];
     int num_events;
 } config_t;
@@ -88,56 +207,789 @@ typedef struct {
     baseline_stats_t l1d_mpki;
     baseline_stats_t itlb_mpki;
     baseline_stats_t dtlb_mpki;
+    baseline_stats_t package_joules;
+    baseline_stats_t core_joules;
+    baseline_stats_t dram_joules;
+    baseline_stats_t nj_per_instruction;
+    uint32_t energy_mask;  // energy features with statistics
+    char placement[CPU_LIST_LEN];   // monitor CPU list used during collection
+    // Phase-aware scoring: intervals are matched to the nearest centroid
+    // (distance in units of each feature's whole-run MAD) and scored against
+    // that phase's statistics. num_phases < 2 scores against the fields above.
+    int num_phases;
+    double phase_scale[NUM_FEATURES];
+    double centroids[NUM_FEATURES][MAX_PHASES];   // feature-major so the phase loop vectorizes
+    baseline_phase_t phases[MAX_PHASES];
 } baseline_t;
 
+typedef struct app_baseline {
+    char name[128];
+    uint64_t name_hash;
+    baseline_t *current;  // published version, NULL marks a cached negative lookup
+    bool owns_current;    // current is heap allocated (not the store mapping)
+    int pins;             // attached targets; pinned entries are never evicted
+    struct app_baseline *lru_prev;
+    struct app_baseline *lru_next;
+} app_baseline_t;
+
+// Open-addressing (linear probing) table of per-app baselines keyed by name.
+// Doubles as the lazy baseline cache: entries sit on an LRU list (head is
+// most recent) and the table is trimmed to max_entries on insert.
+typedef struct {
+    app_baseline_t **slots;
+    size_t capacity;      // always a power of two
+    size_t count;
+    size_t max_entries;   // 0 = unbounded
+    size_t collisions;    // inserts whose home slot was taken
+    size_t max_probe;
+    size_t duplicates;
+    app_baseline_t *lru_head;
+    app_baseline_t *lru_tail;
+    uint64_t hits;
+    uint64_t negative_hits;
+    uint64_t misses;
+    uint64_t evictions;
+} baseline_table_t;
+
+typedef struct {
+    const char *name;
+    size_t value_offset;     // offset into feature_vector_t
+    size_t baseline_offset;  // offset into baseline_t
+} feature_desc_t;
+
+extern const feature_desc_t feature_table[NUM_FEATURES];
+int feature_index(const char *name);  // feature_id_t, or -1 if unknown
+
+// Anomalies suppressed by cooldown, folded into one record per target window
+typedef struct {
+    uint32_t count;
+    uint32_t first_seen;
+    uint32_t last_seen;
+    uint32_t feature_mask;
+    float max_z;
+    uint8_t feature;
+    double measured_value;
+    double baseline_median;
+} alert_aggregate_t;
+
+// Per-target state; the baseline is resolved once when the target is attached
+typedef struct {
+    char name[128];
+    char label[64];     // "pid:<n>" for attached processes, otherwise the name
+    pid_t pid;
+    app_baseline_t *entry;  // pinned per-app entry, or the global entry
+    int reader;             // epoch reader slot, -1 if none was free
+    bool per_app;
+    char placement[CPU_LIST_LEN];   // monitor CPUs the target is pinned to, empty if unpinned
+    uint32_t cooldown_until[NUM_FEATURES]; // per-feature cooldown expiry (interval seconds)
+    alert_aggregate_t aggregate;
+    double time_base;       // added to interval times on alerts: replay epoch, 0 when live
+    // Last scored interval: z-score of every feature (NAN if not scored) and
+    // the worst deviation, for telemetry and the verdicts embedders get
+    double last_z[NUM_FEATURES];
+    double last_max_z;
+    int8_t last_feature;    // -1 if every feature was within the baseline
+    int8_t last_phase;
+} target_state_t;
+
+// Binary alert log: 32-byte header followed by fixed 64-byte little-endian
+// records. Strings are interned into a side segment (<log>.str) made of
+// {u32 id, u16 len, bytes} entries written before any record using them.
+#define ALERT_LOG_MAGIC "HPCALOG"
+#define ALERT_LOG_VERSION 2
+#define ALERT_LOG_HEADER_SIZE 32
+#define ALERT_LOG_RECORD_SIZE 64
+
+#define ALERT_FLAG_PER_APP 0x01
+#define ALERT_FLAG_AGGREGATED 0x02
+#define ALERT_FLAG_PHASE_SHIFT 4       // bits 4-6: 1-based baseline phase, 0 if single-phase
+#define ALERT_FLAG_PHASE_MASK 0x70
+
+typedef struct {
+    uint64_t timestamp_ns;
+    uint32_t target_id;
+    uint32_t app_id;
+    uint16_t feature_id;     // feature_id_t; feature names are not interned
+    uint8_t severity;        // 1 medium, 2 high, 3 critical
+    uint8_t flags;
+    uint32_t count;
+    double measured_value;
+    double baseline_median;
+    double robust_z_score;
+    float threshold;
+    uint32_t feature_mask;
+    uint32_t span_seconds;   // last_seen - first_seen for aggregated records
+    uint32_t placement_id;   // string id + 1 of the monitor CPU list, 0 if unpinned
+} alert_log_record_t;
+
+typedef struct {
+    char **names;
+    uint64_t *hashes;
+    uint32_t *slots;         // open addressing, value is id + 1
+    size_t slot_capacity;
+    uint32_t count;
+    uint32_t capacity;
+} string_table_t;
+
+typedef struct {
+    int fd;
+    int str_fd;
+    string_table_t strings;
+    char *pending;           // string entries not yet written to the side segment
+    size_t pending_len;
+    size_t pending_capacity;
+} alert_log_t;
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t record_count;
+    char **strings;
+    uint32_t num_strings;
+} alert_log_reader_t;
+
+// Raw counter trace: a 32-byte header plus length-prefixed target and event
+// names, then blocks of up to TRACE_BLOCK_INTERVALS intervals. A block is a
+// 16-byte header {magic, intervals, payload bytes, footer bytes}, the time
+// (us), presence mask and per-event columns as delta + zig-zag varints, and
+// a footer of {u32 column bytes, u64 min, u64 max} per column.
+#define TRACE_MAGIC "HPCTRAC"
+#define TRACE_VERSION 1
+#define TRACE_HEADER_SIZE 32
+#define TRACE_BLOCK_MAGIC 0x4b4c4254u     // "TBLK"
+#define TRACE_BLOCK_HEADER 16
+#define TRACE_BLOCK_INTERVALS 256
+#define TRACE_FIXED_COLUMNS 2             // time and presence mask precede the events
+#define TRACE_FOOTER_ENTRY 20
+#define TRACE_MAX_COLUMNS (TRACE_FIXED_COLUMNS + MAX_EVENTS)
+
+typedef struct {
+    int fd;
+    int num_events;
+    char events[MAX_EVENTS][64];
+    uint32_t count;                      // intervals buffered in the open block
+    uint64_t times[TRACE_BLOCK_INTERVALS];
+    uint64_t masks[TRACE_BLOCK_INTERVALS];
+    uint64_t values[MAX_EVENTS][TRACE_BLOCK_INTERVALS];
+    uint64_t intervals;
+    uint64_t readings;
+    uint64_t blocks;
+    uint64_t bytes;
+    uint64_t write_errors;
+    uint8_t buffer[TRACE_BLOCK_HEADER + TRACE_MAX_COLUMNS * (TRACE_BLOCK_INTERVALS * 10 + TRACE_FOOTER_ENTRY)];
+} trace_writer_t;
+
+typedef struct {
+    const uint8_t *data;
+    size_t size;
+    size_t offset;                       // next block
+    int num_events;
+    char target[256];
+    char events[MAX_EVENTS][64];
+    uint64_t start_ns;                   // wall clock when recording began
+    int sampling_interval_ms;
+    uint32_t count;                      // intervals in the decoded block
+    uint64_t times[TRACE_BLOCK_INTERVALS];
+    uint64_t masks[TRACE_BLOCK_INTERVALS];
+    uint64_t values[MAX_EVENTS][TRACE_BLOCK_INTERVALS];
+    uint64_t min[TRACE_MAX_COLUMNS];
+    uint64_t max[TRACE_MAX_COLUMNS];
+    uint64_t blocks;
+    uint64_t intervals;
+} trace_reader_t;
+
+// Segmented alert store: a directory of seg_<start_ns>.hal binary logs.
+// Sealed segments get a .idx file holding per-block time ranges and
+// (app, feature) postings. The index is a derived artifact written in
+// native byte order and rebuilt from the segment if it does not match.
+#define ALERT_INDEX_MAGIC "HPCAIDX"
+#define ALERT_INDEX_VERSION 1
+#define ALERT_INDEX_STRIDE 64
+#define ALERT_INDEX_BYTE_ORDER 0x01020304u
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t record_count;
+    uint64_t min_timestamp_ns;
+    uint64_t max_timestamp_ns;
+    uint32_t stride;
+    uint32_t num_blocks;
+    uint32_t num_postings;
+    uint32_t num_entries;
+} alert_index_header_t;
+
+// Block i covers records [i * stride, (i + 1) * stride). prefix_max and
+// suffix_min are monotonic so both ends of a time range can be bisected.
+typedef struct {
+    uint64_t min_ts;
+    uint64_t max_ts;
+    uint64_t prefix_max;
+    uint64_t suffix_min;
+} alert_index_block_t;
+
+// Sorted by (app_id, feature_id); entries[offset .. offset + count) are record numbers
+typedef struct {
+    uint32_t app_id;
+    uint32_t feature_id;
+    uint32_t offset;
+    uint32_t count;
+} alert_index_posting_t;
+
+// A store directory plus "/seg_<20 digits>.hal"; side files add a suffix
+#define ALERT_SEGMENT_PATH_LEN (MAX_PATH_LEN + 32)
+#define ALERT_SIDE_PATH_LEN (ALERT_SEGMENT_PATH_LEN + 16)
+
+typedef struct {
+    char directory[MAX_PATH_LEN];
+    size_t segment_max_bytes;
+    int segment_max_seconds;
+    int retention_days;
+    alert_log_t active;
+    bool active_open;
+    char active_path[ALERT_SEGMENT_PATH_LEN];
+    uint64_t active_start_ns;
+    size_t active_bytes;
+    uint64_t segments_sealed;
+    uint64_t segments_dropped;
+    bool quiet;
+} alert_store_t;
+
+// Bounded single-producer/single-consumer ring drained by a writer thread.
+// The detection thread only copies records in; formatting and I/O happen
+// on the writer thread, which sleeps on a futex while the ring is empty.
+typedef struct {
+    anomaly_alert_t *records;
+    size_t capacity;      // power of two
+    size_t head __attribute__((aligned(CACHE_LINE_SIZE)));  // written by producer
+    uint64_t dropped;
+    size_t tail __attribute__((aligned(CACHE_LINE_SIZE)));  // written by consumer
+    uint32_t writer_sleeping;
+    uint64_t written;
+    uint64_t batches;
+    uint64_t write_errors;
+    pthread_t thread __attribute__((aligned(CACHE_LINE_SIZE)));
+    int fd;
+    alert_format_t format;
+    alert_log_t log;
+    alert_store_t store;
+    bool use_store;
+    bool running;
+    bool stop;
+    bool echo_stderr;
+    bool blocking;
+    bool quiet;           // no summary on stdout when stopped
+    fsync_policy_t fsync_policy;
+    int fsync_interval_ms;
+} alert_writer_t;
+
+// CPUs this process may use (plus kernel-isolated ones). core_id and
+// llc_id are the lowest CPU sharing the physical core / last-level cache.
+#define MAX_CPUS 1024
+
+typedef struct {
+    int cpu;
+    int core_id;
+    int llc_id;
+    bool isolated;
+} cpu_info_t;
+
+typedef struct {
+    cpu_info_t cpus[MAX_CPUS];
+    int num_cpus;
+    bool has_isolated;
+} cpu_topology_t;
+
+// Bump allocator over a reserved, lazily committed region. The region size
+// is the memory budget; allocations are released in stack order via marks.
+typedef struct {
+    const char *name;
+    uint8_t *base;
+    size_t size;
+    size_t used;
+    size_t last;          // offset of the most recent allocation (growable in place)
+    size_t peak;
+    size_t touched;       // high-water mark of pages still resident
+    size_t page_size;
+    uint64_t failures;
+} arena_t;
+
+// Resolved CPU placement: the workload on monitor, everything the IDS
+// runs (including perf) on housekeeping
+typedef struct {
+    cpu_set_t allowed;    // process affinity before the IDS pinned itself
+    cpu_set_t monitor;
+    cpu_set_t housekeeping;
+    char monitor_list[CPU_LIST_LEN];
+    char housekeeping_list[CPU_LIST_LEN];
+    bool pin_monitor;
+    bool pin_housekeeping;
+    bool shared_core;     // some physical core carries both sides
+} placement_t;
+
+#define MAX_ENERGY_DOMAINS 16
+#define ENERGY_EVENTS 3   // pseudo-counters added to each interval: energy-pkg, energy-cores, energy-ram (uJ)
+
+// One powercap zone (RAPL package, core, uncore, dram, psys), read through a
+// descriptor kept open for the meter's lifetime
+typedef struct {
+    char name[64];          // zone name, prefixed with its parent for subzones ("package-0:core")
+    int fd;
+    uint64_t max_range_uj;  // energy_uj wraps to 0 past this
+    uint64_t last_uj;
+    bool package;           // top-level zone, summed into package power
+    bool stale;             // last read failed, last_uj is older than one interval
+} energy_domain_t;
+
+typedef struct {
+    energy_domain_t domains[MAX_ENERGY_DOMAINS];
+    int num_domains;
+    // Per-interval utilization model when no powercap zone is readable
+    bool modeled;
+    int stat_fd;
+    uint64_t last_busy;
+    uint64_t last_total;
+    double idle_watts;
+    double max_watts;
+    struct timespec last;
+    uint64_t wraps;
+    uint64_t samples;       // successful readings since open
+} energy_meter_t;
+
+typedef struct {
+    double interval;                          // seconds since the previous sample
+    double joules[MAX_ENERGY_DOMAINS];        // indexed like energy_meter_t.domains
+    double watts[MAX_ENERGY_DOMAINS];
+    double package_watts;
+    double utilization;                       // modeled meter only
+    uint32_t valid_mask;                      // bit d set if domain d was read for this interval
+} energy_sample_t;
+
+// JSON document parsed in one pass into a flat token array. Tokens refer
+// back into the source text (no copies); a container's children follow it
+// directly and `next` is the index just past its subtree, so siblings are
+// skipped in O(1). Object children alternate key, value.
+typedef enum {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+} json_type_t;
+
+typedef struct {
+    json_type_t type;
+    uint32_t start;
+    uint32_t end;
+    uint32_t size;
+    uint32_t next;
+} json_token_t;
+
+typedef struct {
+    const char *text;
+    size_t length;
+    json_token_t *tokens;
+    size_t num_tokens;
+    size_t capacity;
+} json_doc_t;
+
+typedef struct {
+    const char *ptr;
+    size_t len;
+} json_view_t;
+
+// Compiled baseline store (baseline_compile output), mapped read-only and
+// shared through the page cache. Layout: header, hash index of u32 slots
+// (record number + 1, linear probing on name_hash), then fixed records.
+// Records embed baseline_t directly, so the header pins byte order and
+// struct sizes and the file is rejected on any mismatch.
+#define BASELINE_STORE_MAGIC "HPCBASE"
+#define BASELINE_STORE_VERSION 2
+#define BASELINE_STORE_BYTE_ORDER 0x01020304u
+#define BASELINE_STORE_GLOBAL "__global__"
+#define BASELINE_STORE_PATH_LEN (MAX_PATH_LEN + 16)
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t record_size;
+    uint32_t baseline_size;
+    uint32_t num_records;
+    uint32_t index_capacity;
+    uint64_t created;
+    uint32_t num_features;
+    uint32_t reserved[5];
+} baseline_store_header_t;
+
 typedef struct {
     char name[128];
+    uint64_t name_hash;
     baseline_t baseline;
-    bool has_baseline;
-} app_baseline_t;
+} baseline_record_t;
+
+typedef struct {
+    void *map;
+    size_t size;
+    const baseline_store_header_t *header;
+    const uint32_t *index;
+    const baseline_record_t *records;
+} baseline_store_t;
+
+// Baselines are replaced while scoring runs by publishing a new version
+// with an atomic pointer swap. Readers announce the epoch they entered in
+// a private slot; a replaced version is freed once every active reader
+// entered after it was retired.
+#define MAX_BASELINE_READERS 64
+
+typedef struct {
+    uint64_t epoch;   // 0 while quiescent
+    bool used;
+} __attribute__((aligned(CACHE_LINE_SIZE))) baseline_reader_t;
+
+typedef struct retired_baseline {
+    baseline_t *baseline;
+    uint64_t epoch;
+    struct retired_baseline *next;
+} retired_baseline_t;
+
+typedef struct {
+    int fd;
+    int stop_fd;        // eventfd written to end the thread
+    pthread_t thread;
+    bool running;
+    uint64_t reloads;
+    uint64_t failures;
+} baseline_watcher_t;
+
+// Live telemetry: a POSIX shared-memory segment with one fixed-layout slot
+// per monitored target. Each slot is a seqlock: the scoring thread makes
+// seq odd, copies the interval in and makes it even again, and readers
+// retry a copy that straddled an update, so they never hold up scoring.
+#define TELEMETRY_MAGIC 0x31544948u   // "HIT1"
+#define TELEMETRY_VERSION 2
+#define TELEMETRY_SLOTS 64
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_slots;
+    uint32_t slot_size;
+    uint32_t num_features;
+    int32_t pid;                        // publishing hpc_ids
+    double started;                     // CLOCK_REALTIME
+    char feature_names[NUM_FEATURES][32];
+} __attribute__((aligned(CACHE_LINE_SIZE))) telemetry_header_t;
+
+typedef struct {
+    uint32_t seq;                       // odd while being written
+    uint32_t active;                    // 0 once the target's monitoring ended
+    char target[64];
+    char name[128];                     // same size as target_state_t.name
+    int32_t phase;                      // 0 for single-phase baselines
+    int32_t severity;                   // worst of the interval, 0 normal .. 3 critical
+    uint32_t anomalies;                 // features flagged in the latest interval
+    uint32_t present_mask;              // features scored (energy may be missing)
+    uint64_t sequence;                  // intervals scored so far
+    uint64_t total_anomalies;
+    double timestamp;                   // interval time
+    double updated;                     // CLOCK_REALTIME of the update
+    double features[NUM_FEATURES];
+    double z_scores[NUM_FEATURES];
+    uint64_t stage_processed[PIPELINE_STAGES];
+    uint64_t stage_busy_ns[PIPELINE_STAGES];
+    uint32_t queue_depth[PIPELINE_STAGES];    // queue in front of each stage
+    uint32_t queue_capacity[PIPELINE_STAGES];
+} __attribute__((aligned(CACHE_LINE_SIZE))) telemetry_slot_t;
+
+typedef struct {
+    telemetry_header_t header;
+    telemetry_slot_t slots[TELEMETRY_SLOTS];
+} telemetry_segment_t;
+
+typedef struct {
+    telemetry_segment_t *segment;       // NULL when not publishing
+    char name[64];
+    ino_t inode;                        // to unlink only our own segment
+} telemetry_t;
 
 typedef struct {
     config_t config;
     baseline_t global_baseline;
-    app_baseline_t app_baselines[MAX_APPS];
+    app_baseline_t global_entry;   // current starts at &global_baseline
+    baseline_store_t baseline_store;
+    baseline_table_t app_baselines;
+    pthread_mutex_t baseline_lock; // table structure and pins, not scoring
+    uint64_t baseline_epoch;
+    baseline_reader_t baseline_readers[MAX_BASELINE_READERS];
+    retired_baseline_t *retired;
+    bool reclaim_pending;          // retired versions wait for a reader to leave
+    baseline_watcher_t watcher;
+    placement_t placement;
     int num_apps;
-    feature_vector_t feature_samples[MAX_SAMPLES];
-    int num_samples;
-    FILE *alert_file;
-    time_t last_alert_time;
+    arena_t collection_arena;   // feature samples gathered by the baseline collector
+    alert_writer_t alert_writer;
+    bool alert_output_failed;   // the writer could not start; alerts are not written
+    telemetry_t telemetry;
 } hpc_ids_t;
 
+// Bounded single-producer/single-consumer ring of fixed-size slots. Slots
+// are filled and drained in place (reserve/commit, peek/release). A side
+// that finds the ring full or empty sleeps on a futex and is woken by the
+// other, so an idle pipeline costs no CPU and a busy one no system calls.
+typedef struct {
+    uint8_t *slots;
+    size_t slot_size;
+    size_t capacity;            // power of two
+    size_t head __attribute__((aligned(CACHE_LINE_SIZE)));  // written by producer
+    size_t max_depth;
+    uint64_t full_waits;        // times the producer had to wait: backpressure
+    uint32_t producer_sleeping;
+    bool closed;
+    size_t tail __attribute__((aligned(CACHE_LINE_SIZE)));  // written by consumer
+    uint64_t empty_waits;
+    uint32_t consumer_sleeping;
+} spsc_ring_t;
+
+// Monitoring runs as collection (the perf reader) -> features -> scoring ->
+// output (the alert writer). Each stage's counters sit on their own cache line.
+typedef enum {
+    STAGE_COLLECTION,
+    STAGE_FEATURES,
+    STAGE_SCORING,
+    STAGE_OUTPUT
+} pipeline_stage_id_t;
+
+typedef struct {
+    uint64_t processed __attribute__((aligned(CACHE_LINE_SIZE)));
+    uint64_t busy_ns;           // time spent working, waits excluded
+    pthread_t thread;
+    bool started;
+} pipeline_stage_t;
+
+typedef struct {
+    int counters;               // perf readings; energy pseudo-counters follow them
+    int count;
+    hpc_measurement_t measurements[MAX_EVENTS + ENERGY_EVENTS];
+} pipeline_interval_t;
+
+typedef struct {
+    hpc_ids_t *ids;
+    target_state_t *target;
+    trace_writer_t *trace;      // raw counters of every interval, NULL if not recording
+    int min_counters;
+    bool replay;                // intervals come from a recording, time is perf_time
+    bool threaded;
+    spsc_ring_t intervals;      // collection -> features
+    spsc_ring_t features;       // features -> scoring
+    pipeline_stage_t stages[PIPELINE_STAGES];
+    uint64_t anomalies;
+    pipeline_interval_t scratch;  // the only slot when running on one thread
+    uint64_t reserved_ns;
+    cpu_set_t saved_affinity;     // collection thread mask before pinning
+    bool restore_affinity;
+    telemetry_slot_t *telemetry;  // this target's live slot, NULL if not publishing
+} pipeline_t;
+
 // Core functions
 int hpc_ids_init(hpc_ids_t *ids, const char *config_file);
+int hpc_ids_init_embedded(hpc_ids_t *ids, const char *config_file);
 void hpc_ids_cleanup(hpc_ids_t *ids);
 int load_config(config_t *config, const char *config_file);
+int load_config_quiet(config_t *config, const char *config_file);
 int load_baseline(baseline_t *baseline, const char *baseline_file);
 int load_app_baselines(hpc_ids_t *ids);
+int load_global_baseline(hpc_ids_t *ids);
+int load_json_baselines(hpc_ids_t *ids, bool *has_global);
+
+// Baseline table functions
+uint64_t hash_app_name(const char *name);
+int baseline_table_init(baseline_table_t *table, size_t initial_capacity);
+void baseline_table_free(baseline_table_t *table);
+app_baseline_t* baseline_table_insert(baseline_table_t *table, const char *name);
+app_baseline_t* baseline_table_find(const baseline_table_t *table, const char *name);
+void baseline_table_remove(baseline_table_t *table, app_baseline_t *entry);
+void baseline_table_report(const baseline_table_t *table);
+app_baseline_t* baseline_cache_lookup(hpc_ids_t *ids, const char *app_name);
+int attach_target(hpc_ids_t *ids, target_state_t *target, const char *app_name, pid_t pid);
+void detach_target(hpc_ids_t *ids, target_state_t *target);
+
+// Baseline hot reload functions
+const baseline_t* baseline_acquire(hpc_ids_t *ids, target_state_t *target);
+void baseline_release(hpc_ids_t *ids, target_state_t *target);
+void baseline_publish(hpc_ids_t *ids, app_baseline_t *entry, baseline_t *next);
+void baseline_reclaim(hpc_ids_t *ids);
+int baseline_watcher_start(hpc_ids_t *ids);
+void baseline_watcher_stop(hpc_ids_t *ids);
+
+// Compiled baseline store functions
+int baseline_store_open(baseline_store_t *store, const char *path);
+void baseline_store_close(baseline_store_t *store);
+const baseline_record_t* baseline_store_find(const baseline_store_t *store, const char *name);
+int baseline_store_write(const char *path, const baseline_t *global_baseline, bool has_global,
+                         const baseline_table_t *table);
 
 // Monitoring functions
 int monitor_system(hpc_ids_t *ids, int duration_seconds);
 int monitor_pid(hpc_ids_t *ids, pid_t pid, int duration_seconds);
 int monitor_app(hpc_ids_t *ids, const char *app_name, int duration_seconds);
+int replay_perf_recording(hpc_ids_t *ids, const char *path, const char *app_name, bool realtime,
+                          double epoch);
 
 // Statistical functions
 int compute_baseline_stats(baseline_stats_t *stats, double *values, int count);
 double compute_median(double *values, int count);
 double compute_mad(double *values, int count, double median);
 double compute_robust_z_score(double value, double median, double mad);
+void prepare_baseline_scoring(baseline_t *baseline);
+double baseline_precision(const baseline_t *baseline);
+double ks_two_sample(const double *a, int n, const double *b, int m, double *statistic);
+double mann_whitney_u(const double *a, int n, const double *b, int m, double *z_score);
+double welch_t_test(double mean_a, double var_a, int n, double mean_b, double var_b, int m,
+                    double *t_stat);
+double student_t_quantile(double confidence, double df);
+
+// Phase functions
+int compute_baseline_phases(baseline_t *baseline, const feature_vector_t *features, int count,
+                            int max_phases, int min_samples, arena_t *scratch);
+int baseline_nearest_phase(const baseline_t *baseline, const feature_vector_t *features);
+void prepare_phase_scoring(baseline_t *baseline);
 
 // Detection functions
-int detect_anomalies(hpc_ids_t *ids, const feature_vector_t *features, const char *app_name);
+int detect_anomalies(hpc_ids_t *ids, target_state_t *target, const feature_vector_t *features);
+int flush_target_alerts(hpc_ids_t *ids, target_state_t *target);
+int get_severity_level(double z_score, const config_t *config);
+
+// Alert writer functions
+int alert_writer_start(alert_writer_t *writer, const config_t *config);
+int alert_writer_push(alert_writer_t *writer, const anomaly_alert_t *alert);
+void alert_writer_stop(alert_writer_t *writer);
+int format_alert_json(const anomaly_alert_t *alert, char *buffer, size_t size);
+int format_alert_text(const anomaly_alert_t *alert, char *buffer, size_t size);
+
+// Counter trace functions
+int trace_writer_open(trace_writer_t *writer, const char *path, const char *target,
+                      const config_t *config, bool energy);
+int trace_writer_append(trace_writer_t *writer, const hpc_measurement_t *measurements, int count);
+void trace_writer_close(trace_writer_t *writer);
+void trace_writer_report(const trace_writer_t *writer);
+int trace_reader_open(trace_reader_t *reader, const char *path);
+void trace_reader_close(trace_reader_t *reader);
+int trace_reader_next(trace_reader_t *reader);
+bool trace_file_detect(const char *path);
+int stream_trace_file(const char *path, perf_interval_fn on_interval, void *context);
+
+// Binary alert log functions
+int alert_log_open(alert_log_t *log, const char *path);
+void alert_log_close(alert_log_t *log);
+int alert_log_encode(alert_log_t *log, const anomaly_alert_t *alert, uint8_t *record);
+int alert_log_write(alert_log_t *log, const uint8_t *records, size_t count);
+int alert_log_reader_open(alert_log_reader_t *reader, const char *path);
+void alert_log_reader_close(alert_log_reader_t *reader);
+int alert_log_read(const alert_log_reader_t *reader, size_t index, alert_log_record_t *record);
+const char* alert_log_string(const alert_log_reader_t *reader, uint32_t id);
+void alert_log_to_alert(const alert_log_reader_t *reader, const alert_log_record_t *record,
+                        anomaly_alert_t *alert);
+void alert_log_decode_record(const uint8_t *data, alert_log_record_t *record);
+int alert_log_preallocate(alert_log_t *log, size_t bytes);
+int64_t alert_log_find_string(const alert_log_reader_t *reader, const char *str);
+
+// Segmented alert store functions
+int alert_store_open(alert_store_t *store, const config_t *config);
+alert_log_t* alert_store_prepare(alert_store_t *store, size_t records);
+void alert_store_commit(alert_store_t *store, size_t records);
+void alert_store_close(alert_store_t *store);
+int alert_store_seal_segment(const char *segment_path);
+int alert_store_apply_retention(alert_store_t *store);
+int start_alert_output(hpc_ids_t *ids);
 int log_alert(hpc_ids_t *ids, const anomaly_alert_t *alert);
 
+// JSON functions (paths are dot separated, e.g. "baseline_statistics.ipc.median",
+// and resolved below token parent; 0 is the document root)
+int json_parse(json_doc_t *doc, const char *text, size_t length);
+void json_free(json_doc_t *doc);
+int json_find(const json_doc_t *doc, int parent, const char *path);
+int json_get_view(const json_doc_t *doc, int parent, const char *path, json_view_t *view);
+int json_get_string(const json_doc_t *doc, int parent, const char *path, char *buffer, size_t size);
+int json_get_double(const json_doc_t *doc, int parent, const char *path, double *value);
+int json_get_int(const json_doc_t *doc, int parent, const char *path, int *value);
+int json_get_bool(const json_doc_t *doc, int parent, const char *path, bool *value);
+int json_get_string_array(const json_doc_t *doc, int parent, const char *path, char results[][64], int max_items);
+
 // Baseline collection functions
 int collect_baseline(hpc_ids_t *ids, const char *app_name);
 int collect_all_baselines(hpc_ids_t *ids);
+int collect_baselines_parallel(hpc_ids_t *ids, char apps[][128], int app_count);
+int validate_parallel_collection(hpc_ids_t *ids, const char *app_name);
+
+// CPU topology functions
+int topology_load(cpu_topology_t *topology, const cpu_set_t *allowed);
+const cpu_info_t* topology_find(const cpu_topology_t *topology, int cpu);
+int topology_select_cpus(const cpu_topology_t *topology, isolation_policy_t policy,
+                         int *cpus, int max_cpus);
+int parse_cpu_list(const char *list, cpu_set_t *set);
+int parse_isolation_policy(const char *name, isolation_policy_t *policy);
+const char* isolation_policy_name(isolation_policy_t policy);
+
+// Arena functions
+int arena_init(arena_t *arena, const char *name, size_t budget);
+void arena_destroy(arena_t *arena);
+void* arena_alloc(arena_t *arena, size_t size);
+void* arena_grow(arena_t *arena, void *ptr, size_t size);
+size_t arena_available(const arena_t *arena);
+size_t arena_mark(const arena_t *arena);
+void arena_release(arena_t *arena, size_t mark);
+void arena_report(const arena_t *arena);
+
+// CPU placement functions
+int placement_init(placement_t *placement, config_t *config);
+int placement_apply_self(const placement_t *placement);
+int placement_pin_pid(const placement_t *placement, pid_t pid);
+int placement_pin_thread(pthread_t thread, int cpu);
+int format_cpu_list(const cpu_set_t *set, char *buffer, size_t size);
+
+// Monitoring pipeline functions
+int spsc_ring_init(spsc_ring_t *ring, size_t slot_size, size_t capacity);
+void spsc_ring_destroy(spsc_ring_t *ring);
+void* spsc_ring_reserve(spsc_ring_t *ring);
+void spsc_ring_commit(spsc_ring_t *ring);
+void* spsc_ring_peek(spsc_ring_t *ring);
+void spsc_ring_release(spsc_ring_t *ring);
+void spsc_ring_close(spsc_ring_t *ring);
+size_t spsc_ring_depth(const spsc_ring_t *ring);
+int pipeline_start(pipeline_t *pipeline, hpc_ids_t *ids, target_state_t *target, trace_writer_t *trace,
+                   int min_counters, bool replay);
+pipeline_interval_t* pipeline_reserve(pipeline_t *pipeline);
+void pipeline_submit(pipeline_t *pipeline);
+void pipeline_finish(pipeline_t *pipeline);
+void pipeline_report(const pipeline_t *pipeline);
+const char* pipeline_stage_name(pipeline_stage_id_t stage);
+
+// Live telemetry functions
+int telemetry_open(telemetry_t *telemetry, const char *name);
+void telemetry_close(telemetry_t *telemetry);
+telemetry_slot_t* telemetry_claim(telemetry_t *telemetry, const target_state_t *target);
+void telemetry_release(telemetry_slot_t *slot);
+void telemetry_publish(const pipeline_t *pipeline, const feature_vector_t *features, int anomalies);
+const telemetry_segment_t* telemetry_map(const char *name, size_t *size);
+bool telemetry_snapshot(const telemetry_slot_t *slot, telemetry_slot_t *copy);
+
+// Energy measurement functions
+int energy_meter_open(energy_meter_t *meter, double idle_watts, double max_watts);
+int energy_meter_sample(energy_meter_t *meter, energy_sample_t *sample);
+void energy_meter_close(energy_meter_t *meter);
+int energy_source_open(energy_meter_t *meter, const config_t *config);
+int energy_meter_append(energy_meter_t *meter, hpc_measurement_t *measurements, int count);
 
 // Utility functions
-int execute_perf_command(const char *cmd, hpc_measurement_t *measurements, int *count, int timeout);
+int stream_perf_command(const char *cmd, int timeout, int expected, perf_interval_fn on_interval, void *context);
+int stream_perf_file(const char *path, perf_interval_fn on_interval, void *context);
+int build_perf_command(const config_t *config, const char *target, char *cmd_buffer, size_t buffer_size);
 int parse_perf_line(const char *line, double wall_time, hpc_measurement_t *measurement);
 int engineer_features(hpc_measurement_t *measurements, int count, feature_vector_t *features);
-char* get_app_name_from_pid(pid_t pid);
-int get_available_apps(const char *app_dir, char apps[][128], int max_apps);
+char* get_app_name_from_pid(pid_t pid, char *app_name, size_t size);
+int get_available_apps(const char *app_dir, char (**apps)[128]);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,91 @@
+#ifndef HPCIDS_H
+#define HPCIDS_H
+
+// Embeddable HPC-IDS detector. A host that already reads performance
+// counters hands them over in batches and gets a verdict per interval,
+// without running hpc_ids or parsing its output.
+//
+// Every handle carries its own configuration, baselines, targets and alert
+// writer; the library keeps no global state, so any number of handles can
+// coexist in one process. A handle is used by one thread at a time.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(__GNUC__)
+#define HPCIDS_API __attribute__((visibility("default")))
+#else
+#define HPCIDS_API
+#endif
+
+typedef struct hpcids hpcids_t;
+
+typedef enum {
+    HPCIDS_NORMAL,
+    HPCIDS_MEDIUM,
+    HPCIDS_HIGH,
+    HPCIDS_CRITICAL
+} hpcids_severity_t;
+
+// One interval of one target. counts[i] is the count of event
+// hpcids_event_name(ids, i) over the interval.
+typedef struct {
+    int target;               // from hpcids_target_add
+    double timestamp;         // seconds; cooldowns and alert times follow it
+    const uint64_t *counts;
+    int num_counts;           // at most hpcids_num_events
+} hpcids_interval_t;
+
+typedef struct {
+    int scored;               // 0 if the interval lacked cycles or instructions
+    int anomalies;            // features outside the baseline
+    hpcids_severity_t severity;
+    const char *feature;      // furthest from the baseline, NULL if none
+    double z_score;           // robust z-score of that feature
+    int phase;                // baseline phase scored against, 0 if single-phase
+} hpcids_verdict_t;
+
+// Load a JSON configuration. Baselines come from its baseline_directory or
+// compiled store; per-app ones are read when a target first needs them.
+// Unlike hpc_ids, the calling process is never pinned to other CPUs, nothing
+// is printed to stdout (warnings go to stderr) and the only thread started
+// is the alert writer; baseline_hot_reload is ignored. Alerts are echoed to
+// stderr only if the configuration sets alert_echo_stderr.
+HPCIDS_API hpcids_t *hpcids_create(const char *config_file);
+HPCIDS_API void hpcids_destroy(hpcids_t *ids);
+
+// Read every per-app baseline now rather than on first use. Returns the
+// number of apps with a baseline, or -1.
+HPCIDS_API int hpcids_load_baselines(hpcids_t *ids);
+
+// Start a thread that swaps in baseline files rewritten in the baseline
+// directory while the handle is in use. Returns 0, or -1 if it could not
+// be started.
+HPCIDS_API int hpcids_watch_baselines(hpcids_t *ids);
+
+HPCIDS_API int hpcids_num_events(const hpcids_t *ids);
+HPCIDS_API const char *hpcids_event_name(const hpcids_t *ids, int event);
+
+// Start tracking a monitored entity. app_name selects its baseline (NULL
+// for the global one). Returns a target id for hpcids_interval_t, or -1.
+HPCIDS_API int hpcids_target_add(hpcids_t *ids, const char *app_name);
+
+// Score count intervals, writing verdicts[i] for intervals[i]. Anomalies
+// are also logged to the configured alert output. Returns the number of
+// anomalous features in the batch, or -1 if any interval is invalid, in
+// which case nothing in the batch is scored and verdicts is untouched.
+HPCIDS_API int hpcids_push(hpcids_t *ids, const hpcids_interval_t *intervals, size_t count,
+                           hpcids_verdict_t *verdicts);
+
+// Emit anomalies still held back by cooldown aggregation for every target
+HPCIDS_API void hpcids_flush(hpcids_t *ids);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,455 @@
+#include "hpc_ids.h"
+#include "byte_io.h"
+#include <sys/mman.h>
+#include <sys/uio.h>
+
+static const char *severity_names[] = {"normal", "medium", "high", "critical"};
+
+static uint8_t severity_code(const char *severity) {
+    for (uint8_t i = 1; i < 4; i++) {
+        if (strcmp(severity, severity_names[i]) == 0) return i;
+    }
+    return 0;
+}
+
+// String interning: open-addressing index over a growable name array
+static void string_table_free(string_table_t *table) {
+    for (uint32_t i = 0; i < table->count; i++) free(table->names[i]);
+    free(table->names);
+    free(table->hashes);
+    free(table->slots);
+    memset(table, 0, sizeof(string_table_t));
+}
+
+static int string_table_rehash(string_table_t *table, size_t slot_capacity) {
+    uint32_t *slots = calloc(slot_capacity, sizeof(uint32_t));
+    if (!slots) return -1;
+    for (uint32_t id = 0; id < table->count; id++) {
+        size_t idx = table->hashes[id] & (slot_capacity - 1);
+        while (slots[idx]) idx = (idx + 1) & (slot_capacity - 1);
+        slots[idx] = id + 1;
+    }
+    free(table->slots);
+    table->slots = slots;
+    table->slot_capacity = slot_capacity;
+    return 0;
+}
+
+// Returns the id for str; *added is set when a new id was assigned
+static int64_t string_table_intern(string_table_t *table, const char *str, bool *added) {
+    uint64_t hash = hash_app_name(str);
+    *added = false;
+
+    if (table->slot_capacity) {
+        size_t idx = hash & (table->slot_capacity - 1);
+        while (table->slots[idx]) {
+            uint32_t id = table->slots[idx] - 1;
+            if (table->hashes[id] == hash && strcmp(table->names[id], str) == 0) return id;
+            idx = (idx + 1) & (table->slot_capacity - 1);
+        }
+    }
+
+    if (table->count == table->capacity) {
+        uint32_t capacity = table->capacity ? table->capacity * 2 : 64;
+        char **names = realloc(table->names, capacity * sizeof(char *));
+        if (!names) return -1;
+        table->names = names;
+        uint64_t *hashes = realloc(table->hashes, capacity * sizeof(uint64_t));
+        if (!hashes) return -1;
+        table->hashes = hashes;
+        table->capacity = capacity;
+    }
+    if ((table->count + 1) * 2 > table->slot_capacity) {
+        if (string_table_rehash(table, table->slot_capacity ? table->slot_capacity * 2 : 128) != 0) {
+            return -1;
+        }
+    }
+
+    uint32_t id = table->count;
+    table->names[id] = strdup(str);
+    if (!table->names[id]) return -1;
+    table->hashes[id] = hash;
+    table->count++;
+
+    size_t idx = hash & (table->slot_capacity - 1);
+    while (table->slots[idx]) idx = (idx + 1) & (table->slot_capacity - 1);
+    table->slots[idx] = id + 1;
+
+    *added = true;
+    return id;
+}
+
+static int read_whole_file(int fd, char **data, size_t *size) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return -1;
+    *size = st.st_size;
+    *data = malloc(*size + 1);
+    if (!*data) return -1;
+    size_t off = 0;
+    while (off < *size) {
+        ssize_t n = pread(fd, *data + off, *size - off, off);
+        if (n <= 0) break;
+        off += n;
+    }
+    *size = off;
+    return 0;
+}
+
+// Walk {u32 id, u16 len, bytes} entries, calling fn for each complete one
+static int parse_string_segment(const char *data, size_t size,
+                                int (*fn)(void *ctx, uint32_t id, const char *str, uint16_t len),
+                                void *ctx) {
+    size_t off = 0;
+    while (off + 6 <= size) {
+        uint32_t id = get_u32((const uint8_t *)data + off);
+        uint16_t len = get_u16((const uint8_t *)data + off + 4);
+        if (off + 6 + len > size) break; // torn tail entry
+        if (fn(ctx, id, data + off + 6, len) != 0) return -1;
+        off += 6 + len;
+    }
+    return 0;
+}
+
+static int intern_existing(void *ctx, uint32_t id, const char *str, uint16_t len) {
+    alert_log_t *log = ctx;
+    char name[256];
+    if (len >= sizeof(name)) len = sizeof(name) - 1;
+    memcpy(name, str, len);
+    name[len] = '\0';
+
+    bool added;
+    int64_t assigned = string_table_intern(&log->strings, name, &added);
+    if (assigned != (int64_t)id) {
+        fprintf(stderr, "Warning: inconsistent alert string table (id %u)\n", id);
+    }
+    return 0;
+}
+
+int alert_log_open(alert_log_t *log, const char *path) {
+    char str_path[ALERT_SIDE_PATH_LEN];
+    memset(log, 0, sizeof(alert_log_t));
+    log->fd = -1;
+    log->str_fd = -1;
+
+    log->fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (log->fd < 0) {
+        fprintf(stderr, "Failed to open binary alert log: %s\n", path);
+        return -1;
+    }
+
+    if (snprintf(str_path, sizeof(str_path), "%s.str", path) >= (int)sizeof(str_path)) {
+        fprintf(stderr, "Alert log path too long: %s\n", path);
+        close(log->fd);
+        log->fd = -1;
+        return -1;
+    }
+    log->str_fd = open(str_path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (log->str_fd < 0) {
+        fprintf(stderr, "Failed to open alert string table: %s\n", str_path);
+        close(log->fd);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(log->fd, &st) != 0) {
+        alert_log_close(log);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        uint8_t header[ALERT_LOG_HEADER_SIZE];
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+
+        memset(header, 0, sizeof(header));
+        memcpy(header, ALERT_LOG_MAGIC, strlen(ALERT_LOG_MAGIC));
+        put_u16(header + 8, ALERT_LOG_VERSION);
+        put_u16(header + 10, ALERT_LOG_RECORD_SIZE);
+        put_u64(header + 16, (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+        if (write(log->fd, header, sizeof(header)) != sizeof(header)) {
+            alert_log_close(log);
+            return -1;
+        }
+    } else {
+        // Appending: only to a log with this exact layout
+        uint8_t header[ALERT_LOG_HEADER_SIZE];
+        if (st.st_size < ALERT_LOG_HEADER_SIZE ||
+            pread(log->fd, header, sizeof(header), 0) != sizeof(header) ||
+            memcmp(header, ALERT_LOG_MAGIC, strlen(ALERT_LOG_MAGIC)) != 0 ||
+            get_u16(header + 8) != ALERT_LOG_VERSION ||
+            get_u16(header + 10) != ALERT_LOG_RECORD_SIZE) {
+            fprintf(stderr, "%s is not a version %d binary alert log, not appending to it\n",
+                    path, ALERT_LOG_VERSION);
+            alert_log_close(log);
+            return -1;
+        }
+        // A torn last record would misalign every record appended after it
+        off_t whole = st.st_size - (st.st_size - ALERT_LOG_HEADER_SIZE) % ALERT_LOG_RECORD_SIZE;
+        if (whole != st.st_size) {
+            fprintf(stderr, "Warning: dropping a partial record at the end of %s\n", path);
+            if (ftruncate(log->fd, whole) != 0) {
+                alert_log_close(log);
+                return -1;
+            }
+        }
+
+        // Reload interned strings so ids stay stable
+        char *data;
+        size_t size;
+        if (read_whole_file(log->str_fd, &data, &size) == 0) {
+            parse_string_segment(data, size, intern_existing, log);
+            free(data);
+        }
+    }
+
+    return 0;
+}
+
+void alert_log_close(alert_log_t *log) {
+    if (log->fd >= 0) close(log->fd);
+    if (log->str_fd >= 0) close(log->str_fd);
+    string_table_free(&log->strings);
+    free(log->pending);
+    memset(log, 0, sizeof(alert_log_t));
+    log->fd = -1;
+    log->str_fd = -1;
+}
+
+static int64_t intern_string(alert_log_t *log, const char *str) {
+    bool added;
+    int64_t id = string_table_intern(&log->strings, str, &added);
+    if (id < 0 || !added) return id;
+
+    size_t len = strlen(str);
+    if (len > UINT16_MAX) len = UINT16_MAX;
+    size_t need = log->pending_len + 6 + len;
+    if (need > log->pending_capacity) {
+        size_t capacity = log->pending_capacity ? log->pending_capacity * 2 : 1024;
+        while (capacity < need) capacity *= 2;
+        char *pending = realloc(log->pending, capacity);
+        if (!pending) return -1;
+        log->pending = pending;
+        log->pending_capacity = capacity;
+    }
+
+    uint8_t *entry = (uint8_t *)log->pending + log->pending_len;
+    put_u32(entry, (uint32_t)id);
+    put_u16(entry + 4, (uint16_t)len);
+    memcpy(entry + 6, str, len);
+    log->pending_len = need;
+    return id;
+}
+
+int alert_log_encode(alert_log_t *log, const anomaly_alert_t *alert, uint8_t *record) {
+    int feature_id = feature_index(alert->feature);
+    if (feature_id < 0) return -1;
+    int64_t target_id = intern_string(log, alert->target[0] ? alert->target : alert->application_name);
+    int64_t app_id = intern_string(log, alert->application_name);
+    int64_t placement_id = alert->placement[0] ? intern_string(log, alert->placement) : -1;
+    if (target_id < 0 || app_id < 0 || (alert->placement[0] && placement_id < 0)) return -1;
+
+    uint8_t flags = 0;
+    if (strcmp(alert->baseline_type, "per_app") == 0) flags |= ALERT_FLAG_PER_APP;
+    if (alert->aggregated) flags |= ALERT_FLAG_AGGREGATED;
+    flags |= (alert->phase << ALERT_FLAG_PHASE_SHIFT) & ALERT_FLAG_PHASE_MASK;
+
+    memset(record, 0, ALERT_LOG_RECORD_SIZE);
+    put_u64(record + 0, (uint64_t)(alert->timestamp * 1e9));
+    put_u32(record + 8, (uint32_t)target_id);
+    put_u32(record + 12, (uint32_t)app_id);
+    put_u16(record + 16, (uint16_t)feature_id);
+    record[18] = severity_code(alert->severity);
+    record[19] = flags;
+    put_u32(record + 20, alert->count > 0 ? (uint32_t)alert->count : 1);
+    put_f64(record + 24, alert->measured_value);
+    put_f64(record + 32, alert->baseline_median);
+    put_f64(record + 40, alert->robust_z_score);
+    put_f32(record + 48, (float)alert->threshold);
+    put_u32(record + 52, alert->feature_mask);
+    put_u32(record + 56, alert->aggregated ? (uint32_t)(alert->last_seen - alert->first_seen) : 0);
+    // Formerly reserved and zero, so older logs decode as unpinned
+    put_u32(record + 60, (uint32_t)(placement_id + 1));
+    return 0;
+}
+
+// Strings go out before the records that reference them so a reader never
+// sees an unresolvable id
+int alert_log_write(alert_log_t *log, const uint8_t *records, size_t count) {
+    if (log->pending_len > 0) {
+        const char *p = log->pending;
+        size_t left = log->pending_len;
+        while (left > 0) {
+            ssize_t n = write(log->str_fd, p, left);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return -1;
+            }
+            p += n;
+            left -= n;
+        }
+        log->pending_len = 0;
+    }
+
+    const uint8_t *p = records;
+    size_t left = count * ALERT_LOG_RECORD_SIZE;
+    while (left > 0) {
+        ssize_t n = write(log->fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        p += n;
+        left -= n;
+    }
+    return 0;
+}
+
+void alert_log_decode_record(const uint8_t *data, alert_log_record_t *record) {
+    record->timestamp_ns = get_u64(data + 0);
+    record->target_id = get_u32(data + 8);
+    record->app_id = get_u32(data + 12);
+    record->feature_id = get_u16(data + 16);
+    record->severity = data[18];
+    record->flags = data[19];
+    record->count = get_u32(data + 20);
+    record->measured_value = get_f64(data + 24);
+    record->baseline_median = get_f64(data + 32);
+    record->robust_z_score = get_f64(data + 40);
+    record->threshold = get_f32(data + 48);
+    record->feature_mask = get_u32(data + 52);
+    record->span_seconds = get_u32(data + 56);
+    record->placement_id = get_u32(data + 60);
+}
+
+// Reserve disk space for a segment without changing its visible size, so
+// readers still see exactly the bytes written
+int alert_log_preallocate(alert_log_t *log, size_t bytes) {
+    if (fallocate(log->fd, FALLOC_FL_KEEP_SIZE, 0, bytes) != 0) {
+        return -1; // not supported by every filesystem; appends still work
+    }
+    return 0;
+}
+
+static int store_string(void *ctx, uint32_t id, const char *str, uint16_t len) {
+    alert_log_reader_t *reader = ctx;
+    if (id >= reader->num_strings) {
+        uint32_t count = id + 1;
+        char **strings = realloc(reader->strings, count * sizeof(char *));
+        if (!strings) return -1;
+        memset(strings + reader->num_strings, 0, (count - reader->num_strings) * sizeof(char *));
+        reader->strings = strings;
+        reader->num_strings = count;
+    }
+    free(reader->strings[id]);
+    reader->strings[id] = strndup(str, len);
+    return 0;
+}
+
+int alert_log_reader_open(alert_log_reader_t *reader, const char *path) {
+    memset(reader, 0, sizeof(alert_log_reader_t));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open alert log: %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < ALERT_LOG_HEADER_SIZE) {
+        fprintf(stderr, "Not a binary alert log: %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Cannot map alert log: %s\n", path);
+        return -1;
+    }
+
+    const uint8_t *header = data;
+    if (memcmp(header, ALERT_LOG_MAGIC, strlen(ALERT_LOG_MAGIC)) != 0 ||
+        get_u16(header + 8) != ALERT_LOG_VERSION ||
+        get_u16(header + 10) != ALERT_LOG_RECORD_SIZE) {
+        fprintf(stderr, "Unsupported alert log format: %s\n", path);
+        munmap(data, st.st_size);
+        return -1;
+    }
+
+    reader->data = data;
+    reader->size = st.st_size;
+    reader->record_count = (st.st_size - ALERT_LOG_HEADER_SIZE) / ALERT_LOG_RECORD_SIZE;
+
+    char str_path[ALERT_SIDE_PATH_LEN];
+    int str_fd = -1;
+    if (snprintf(str_path, sizeof(str_path), "%s.str", path) < (int)sizeof(str_path)) {
+        str_fd = open(str_path, O_RDONLY | O_CLOEXEC);
+    }
+    if (str_fd >= 0) {
+        char *strings;
+        size_t size;
+        if (read_whole_file(str_fd, &strings, &size) == 0) {
+            parse_string_segment(strings, size, store_string, reader);
+            free(strings);
+        }
+        close(str_fd);
+    } else {
+        fprintf(stderr, "Warning: missing string table %s\n", str_path);
+    }
+
+    return 0;
+}
+
+void alert_log_reader_close(alert_log_reader_t *reader) {
+    if (reader->data) munmap((void *)reader->data, reader->size);
+    for (uint32_t i = 0; i < reader->num_strings; i++) free(reader->strings[i]);
+    free(reader->strings);
+    memset(reader, 0, sizeof(alert_log_reader_t));
+}
+
+int alert_log_read(const alert_log_reader_t *reader, size_t index, alert_log_record_t *record) {
+    if (index >= reader->record_count) return -1;
+    alert_log_decode_record(reader->data + ALERT_LOG_HEADER_SIZE + index * ALERT_LOG_RECORD_SIZE,
+                            record);
+    return 0;
+}
+
+int64_t alert_log_find_string(const alert_log_reader_t *reader, const char *str) {
+    for (uint32_t i = 0; i < reader->num_strings; i++) {
+        if (reader->strings[i] && strcmp(reader->strings[i], str) == 0) return i;
+    }
+    return -1;
+}
+
+const char* alert_log_string(const alert_log_reader_t *reader, uint32_t id) {
+    if (id >= reader->num_strings || !reader->strings[id]) return "unknown";
+    return reader->strings[id];
+}
+
+void alert_log_to_alert(const alert_log_reader_t *reader, const alert_log_record_t *record,
+                        anomaly_alert_t *alert) {
+    memset(alert, 0, sizeof(anomaly_alert_t));
+    strncpy(alert->target, alert_log_string(reader, record->target_id), sizeof(alert->target) - 1);
+    strncpy(alert->application_name, alert_log_string(reader, record->app_id),
+            sizeof(alert->application_name) - 1);
+    strcpy(alert->feature, record->feature_id < NUM_FEATURES ? feature_table[record->feature_id].name : "unknown");
+    strcpy(alert->baseline_type, (record->flags & ALERT_FLAG_PER_APP) ? "per_app" : "global");
+    strcpy(alert->severity, severity_names[record->severity < 4 ? record->severity : 0]);
+    alert->timestamp = record->timestamp_ns / 1e9;
+    alert->measured_value = record->measured_value;
+    alert->baseline_median = record->baseline_median;
+    alert->robust_z_score = record->robust_z_score;
+    alert->threshold = record->threshold;
+    alert->count = record->count;
+    alert->feature_mask = record->feature_mask;
+    alert->phase = (record->flags & ALERT_FLAG_PHASE_MASK) >> ALERT_FLAG_PHASE_SHIFT;
+    if (record->placement_id > 0) {
+        strncpy(alert->placement, alert_log_string(reader, record->placement_id - 1),
+                sizeof(alert->placement) - 1);
+    }
+    if (record->flags & ALERT_FLAG_AGGREGATED) {
+        alert->aggregated = true;
+        alert->last_seen = (double)(record->timestamp_ns / 1000000000ULL);
+        alert->first_seen = alert->last_seen - record->span_seconds;
+    }
+}
@@ -0,0 +1,315 @@
+#include "hpc_ids.h"
+#include "byte_io.h"
+#include <sys/mman.h>
+
+#define DEFAULT_SEGMENT_MAX_MB 64
+#define DEFAULT_SEGMENT_MAX_SECONDS 3600
+
+typedef struct {
+    uint32_t app_id;
+    uint32_t feature_id;
+    uint32_t record;
+} posting_entry_t;
+
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static int compare_postings(const void *a, const void *b) {
+    const posting_entry_t *pa = a, *pb = b;
+    if (pa->app_id != pb->app_id) return pa->app_id < pb->app_id ? -1 : 1;
+    if (pa->feature_id != pb->feature_id) return pa->feature_id < pb->feature_id ? -1 : 1;
+    return (pa->record > pb->record) - (pa->record < pb->record);
+}
+
+// Build <segment>.idx from a closed segment; written to a temp file and
+// renamed so a crash never leaves a half-written index behind
+int alert_store_seal_segment(const char *segment_path) {
+    alert_log_reader_t reader;
+    if (alert_log_reader_open(&reader, segment_path) != 0) {
+        return -1;
+    }
+
+    size_t count = reader.record_count;
+    uint32_t num_blocks = (count + ALERT_INDEX_STRIDE - 1) / ALERT_INDEX_STRIDE;
+    alert_index_block_t *blocks = calloc(num_blocks ? num_blocks : 1, sizeof(alert_index_block_t));
+    posting_entry_t *entries = malloc((count ? count : 1) * sizeof(posting_entry_t));
+    if (!blocks || !entries) {
+        free(blocks);
+        free(entries);
+        alert_log_reader_close(&reader);
+        return -1;
+    }
+
+    alert_index_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ALERT_INDEX_MAGIC, strlen(ALERT_INDEX_MAGIC));
+    header.version = ALERT_INDEX_VERSION;
+    header.byte_order = ALERT_INDEX_BYTE_ORDER;
+    header.record_count = count;
+    header.min_timestamp_ns = UINT64_MAX;
+    header.stride = ALERT_INDEX_STRIDE;
+    header.num_blocks = num_blocks;
+    header.num_entries = count;
+
+    alert_log_record_t record;
+    for (size_t i = 0; i < count; i++) {
+        alert_log_read(&reader, i, &record);
+        alert_index_block_t *block = &blocks[i / ALERT_INDEX_STRIDE];
+        if (i % ALERT_INDEX_STRIDE == 0) {
+            block->min_ts = record.timestamp_ns;
+            block->max_ts = record.timestamp_ns;
+        }
+        if (record.timestamp_ns < block->min_ts) block->min_ts = record.timestamp_ns;
+        if (record.timestamp_ns > block->max_ts) block->max_ts = record.timestamp_ns;
+        if (record.timestamp_ns < header.min_timestamp_ns) header.min_timestamp_ns = record.timestamp_ns;
+        if (record.timestamp_ns > header.max_timestamp_ns) header.max_timestamp_ns = record.timestamp_ns;
+
+        entries[i].app_id = record.app_id;
+        entries[i].feature_id = record.feature_id;
+        entries[i].record = (uint32_t)i;
+    }
+    if (count == 0) header.min_timestamp_ns = 0;
+
+    // Monotonic envelopes so time bounds can be bisected despite slight reordering
+    for (uint32_t b = 0; b < num_blocks; b++) {
+        blocks[b].prefix_max = blocks[b].max_ts;
+        if (b > 0 && blocks[b - 1].prefix_max > blocks[b].prefix_max) {
+            blocks[b].prefix_max = blocks[b - 1].prefix_max;
+        }
+    }
+    for (uint32_t b = num_blocks; b-- > 0;) {
+        blocks[b].suffix_min = blocks[b].min_ts;
+        if (b + 1 < num_blocks && blocks[b + 1].suffix_min < blocks[b].suffix_min) {
+            blocks[b].suffix_min = blocks[b + 1].suffix_min;
+        }
+    }
+
+    qsort(entries, count, sizeof(posting_entry_t), compare_postings);
+
+    alert_index_posting_t *postings = malloc((count ? count : 1) * sizeof(alert_index_posting_t));
+    uint32_t *records = malloc((count ? count : 1) * sizeof(uint32_t));
+    uint32_t num_postings = 0;
+    for (size_t i = 0; postings && records && i < count; i++) {
+        if (num_postings == 0 ||
+            postings[num_postings - 1].app_id != entries[i].app_id ||
+            postings[num_postings - 1].feature_id != entries[i].feature_id) {
+            postings[num_postings].app_id = entries[i].app_id;
+            postings[num_postings].feature_id = entries[i].feature_id;
+            postings[num_postings].offset = (uint32_t)i;
+            postings[num_postings].count = 0;
+            num_postings++;
+        }
+        postings[num_postings - 1].count++;
+        records[i] = entries[i].record;
+    }
+    header.num_postings = num_postings;
+
+    int result = -1;
+    char index_path[ALERT_SIDE_PATH_LEN];
+    char tmp_path[ALERT_SIDE_PATH_LEN];
+    bool paths_fit = snprintf(index_path, sizeof(index_path), "%s.idx", segment_path) < (int)sizeof(index_path) &&
+                     snprintf(tmp_path, sizeof(tmp_path), "%s.idx.tmp", segment_path) < (int)sizeof(tmp_path);
+
+    int fd = paths_fit && postings && records ? open(tmp_path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644) : -1;
+    if (fd >= 0) {
+        if (write_all(fd, &header, sizeof(header)) == 0 &&
+            write_all(fd, blocks, num_blocks * sizeof(alert_index_block_t)) == 0 &&
+            write_all(fd, postings, num_postings * sizeof(alert_index_posting_t)) == 0 &&
+            write_all(fd, records, count * sizeof(uint32_t)) == 0 &&
+            fdatasync(fd) == 0) {
+            result = 0;
+        }
+        close(fd);
+        if (result == 0 && rename(tmp_path, index_path) != 0) result = -1;
+        if (result != 0) unlink(tmp_path);
+    }
+
+    if (result != 0) {
+        fprintf(stderr, "Failed to write alert index: %s\n", index_path);
+    }
+
+    free(blocks);
+    free(entries);
+    free(postings);
+    free(records);
+    alert_log_reader_close(&reader);
+    return result;
+}
+
+static bool is_segment_name(const char *name) {
+    size_t len = strlen(name);
+    return strncmp(name, "seg_", 4) == 0 && len > 8 && strcmp(name + len - 4, ".hal") == 0;
+}
+
+static bool index_exists(const char *segment_path) {
+    char index_path[ALERT_SIDE_PATH_LEN];
+    if (snprintf(index_path, sizeof(index_path), "%s.idx", segment_path) >= (int)sizeof(index_path)) return false;
+    return access(index_path, F_OK) == 0;
+}
+
+static void remove_segment(const char *segment_path) {
+    char path[ALERT_SIDE_PATH_LEN];
+    unlink(segment_path);
+    if (snprintf(path, sizeof(path), "%s.str", segment_path) < (int)sizeof(path)) unlink(path);
+    if (snprintf(path, sizeof(path), "%s.idx", segment_path) < (int)sizeof(path)) unlink(path);
+}
+
+static int segment_filter(const struct dirent *entry) {
+    return is_segment_name(entry->d_name);
+}
+
+// Wall-clock creation time from the seg_<start_ns> name. Record timestamps
+// are not used: replayed or embedded alerts carry whatever time they were given.
+static uint64_t segment_start_ns(const char *name) {
+    return strtoull(name + 4, NULL, 10);
+}
+
+// Whole segments past the retention window are unlinked; nothing is rewritten.
+// Names are zero-padded, so sorted order is creation order and a segment
+// stopped taking records when the next one was created. The newest segment
+// has no such bound and is always kept.
+int alert_store_apply_retention(alert_store_t *store) {
+    if (store->retention_days <= 0) return 0;
+
+    uint64_t cutoff = realtime_ns() - (uint64_t)store->retention_days * 86400ULL * 1000000000ULL;
+    struct dirent **segments;
+    int num_segments = scandir(store->directory, &segments, segment_filter, alphasort);
+    if (num_segments < 0) return -1;
+
+    int dropped = 0;
+    char path[ALERT_SEGMENT_PATH_LEN];
+    for (int i = 0; i < num_segments; i++) {
+        if (i + 1 < num_segments && segment_start_ns(segments[i + 1]->d_name) < cutoff &&
+            snprintf(path, sizeof(path), "%s/%s", store->directory, segments[i]->d_name) < (int)sizeof(path)) {
+            if (!store->active_open || strcmp(path, store->active_path) != 0) {
+                remove_segment(path);
+                dropped++;
+            }
+        }
+        free(segments[i]);
+    }
+    free(segments);
+
+    if (dropped > 0) {
+        store->segments_dropped += dropped;
+        if (!store->quiet) {
+            printf("Alert store: dropped %d segments older than %d days\n", dropped, store->retention_days);
+        }
+    }
+    return dropped;
+}
+
+static int open_active_segment(alert_store_t *store) {
+    store->active_start_ns = realtime_ns();
+    if (snprintf(store->active_path, sizeof(store->active_path), "%s/seg_%020llu.hal",
+                 store->directory, (unsigned long long)store->active_start_ns) >= (int)sizeof(store->active_path)) {
+        return -1;
+    }
+
+    if (alert_log_open(&store->active, store->active_path) != 0) {
+        return -1;
+    }
+    alert_log_preallocate(&store->active, store->segment_max_bytes);
+
+    store->active_bytes = ALERT_LOG_HEADER_SIZE;
+    store->active_open = true;
+    return 0;
+}
+
+static int seal_active_segment(alert_store_t *store) {
+    if (!store->active_open) return 0;
+
+    // Release preallocated space beyond the data before indexing
+    struct stat st;
+    if (fstat(store->active.fd, &st) == 0) {
+        if (ftruncate(store->active.fd, st.st_size) != 0) {
+            fprintf(stderr, "Warning: failed to trim segment %s\n", store->active_path);
+        }
+    }
+    fdatasync(store->active.fd);
+    alert_log_close(&store->active);
+    store->active_open = false;
+
+    if (alert_store_seal_segment(store->active_path) != 0) {
+        return -1;
+    }
+    store->segments_sealed++;
+    return 0;
+}
+
+int alert_store_open(alert_store_t *store, const config_t *config) {
+    memset(store, 0, sizeof(alert_store_t));
+    memcpy(store->directory, config->alert_store_directory, sizeof(store->directory));
+    store->directory[sizeof(store->directory) - 1] = '\0';
+    store->segment_max_bytes = (size_t)(config->alert_segment_max_mb > 0 ?
+                                        config->alert_segment_max_mb : DEFAULT_SEGMENT_MAX_MB) << 20;
+    store->segment_max_seconds = config->alert_segment_max_seconds > 0 ?
+                                 config->alert_segment_max_seconds : DEFAULT_SEGMENT_MAX_SECONDS;
+    store->retention_days = config->alert_retention_days;
+    store->quiet = config->quiet;
+
+    if (mkdir(store->directory, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Cannot create alert store directory: %s\n", store->directory);
+        return -1;
+    }
+
+    // Seal segments left open by a previous run before starting a new one
+    DIR *dir = opendir(store->directory);
+    if (!dir) {
+        fprintf(stderr, "Cannot open alert store directory: %s\n", store->directory);
+        return -1;
+    }
+    struct dirent *entry;
+    char path[ALERT_SEGMENT_PATH_LEN];
+    while ((entry = readdir(dir)) != NULL) {
+        if (!is_segment_name(entry->d_name)) continue;
+        if (snprintf(path, sizeof(path), "%s/%s", store->directory, entry->d_name) >= (int)sizeof(path)) continue;
+        if (!index_exists(path)) {
+            int fd = open(path, O_RDWR | O_CLOEXEC);
+            struct stat st;
+            if (fd >= 0 && fstat(fd, &st) == 0 && ftruncate(fd, st.st_size) == 0) {
+                if (!store->quiet) printf("Alert store: sealing leftover segment %s\n", entry->d_name);
+            }
+            if (fd >= 0) close(fd);
+            alert_store_seal_segment(path);
+        }
+    }
+    closedir(dir);
+
+    alert_store_apply_retention(store);
+    return open_active_segment(store);
+}
+
+// Rotate if the next batch would overflow the size or age bound, then
+// return the log the caller should encode into
+alert_log_t* alert_store_prepare(alert_store_t *store, size_t records) {
+    size_t incoming = records * ALERT_LOG_RECORD_SIZE;
+    uint64_t age_ns = realtime_ns() - store->active_start_ns;
+
+    if (store->active_open && store->active_bytes > ALERT_LOG_HEADER_SIZE &&
+        (store->active_bytes + incoming > store->segment_max_bytes ||
+         age_ns >= (uint64_t)store->segment_max_seconds * 1000000000ULL)) {
+        seal_active_segment(store);
+        alert_store_apply_retention(store);
+    }
+
+    if (!store->active_open && open_active_segment(store) != 0) {
+        return NULL;
+    }
+    return &store->active;
+}
+
+void alert_store_commit(alert_store_t *store, size_t records) {
+    store->active_bytes += records * ALERT_LOG_RECORD_SIZE;
+}
+
+void alert_store_close(alert_store_t *store) {
+    seal_active_segment(store);
+    if ((store->segments_sealed > 0 || store->segments_dropped > 0) && !store->quiet) {
+        printf("Alert store: %lu segments sealed, %lu dropped\n",
+               (unsigned long)store->segments_sealed, (unsigned long)store->segments_dropped);
+    }
+}
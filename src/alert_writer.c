@@ -0,0 +1,318 @@
+#include "hpc_ids.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+int format_alert_json(const anomaly_alert_t *alert, char *buffer, size_t size) {
+    int len = snprintf(buffer, size,
+        "{\"timestamp\":%.0f,\"application_name\":\"%s\",\"baseline_type\":\"%s\","
+        "\"feature\":\"%s\",\"measured_value\":%.6f,\"baseline_median\":%.6f,"
+        "\"robust_z_score\":%.3f,\"threshold\":%.1f,\"severity\":\"%s\"",
+        alert->timestamp, alert->application_name, alert->baseline_type,
+        alert->feature, alert->measured_value, alert->baseline_median,
+        alert->robust_z_score, alert->threshold, alert->severity);
+
+    if (alert->placement[0] && len > 0 && (size_t)len < size) {
+        len += snprintf(buffer + len, size - len, ",\"placement\":\"%s\"", alert->placement);
+    }
+
+    if (alert->phase > 0 && len > 0 && (size_t)len < size) {
+        len += snprintf(buffer + len, size - len, ",\"phase\":%d", alert->phase);
+    }
+
+    if (alert->aggregated && len > 0 && (size_t)len < size) {
+        len += snprintf(buffer + len, size - len,
+                        ",\"aggregated\":true,\"count\":%d,\"first_seen\":%.0f,"
+                        "\"last_seen\":%.0f,\"features\":[",
+                        alert->count, alert->first_seen, alert->last_seen);
+        bool first = true;
+        for (int f = 0; f < NUM_FEATURES && (size_t)len < size; f++) {
+            if (alert->feature_mask & (1u << f)) {
+                len += snprintf(buffer + len, size - len, "%s\"%s\"",
+                                first ? "" : ",", feature_table[f].name);
+                first = false;
+            }
+        }
+        if ((size_t)len < size) {
+            len += snprintf(buffer + len, size - len, "]");
+        }
+    }
+
+    if (len > 0 && (size_t)len < size) {
+        len += snprintf(buffer + len, size - len, "}\n");
+    }
+
+    return ((size_t)len < size) ? len : (int)size - 1;
+}
+
+int format_alert_text(const anomaly_alert_t *alert, char *buffer, size_t size) {
+    int len;
+    if (alert->aggregated) {
+        len = snprintf(buffer, size, "[%s] %s anomaly in %s: %d anomalies on %d features (max z=%.3f on %s)\n",
+                       alert->severity, alert->baseline_type, alert->application_name,
+                       alert->count, __builtin_popcount(alert->feature_mask), alert->robust_z_score,
+                       alert->feature);
+    } else {
+        len = snprintf(buffer, size, "[%s] %s anomaly in %s: %s=%.6f (baseline=%.6f, z=%.3f)\n",
+                       alert->severity, alert->baseline_type, alert->application_name,
+                       alert->feature, alert->measured_value, alert->baseline_median,
+                       alert->robust_z_score);
+    }
+    return ((size_t)len < size) ? len : (int)size - 1;
+}
+
+// writev until every iovec has been written or a hard error occurs
+static int writev_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+static double monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Sleep until the producer wakes us, or for at most timeout_ms if >= 0
+static void futex_wait_ms(uint32_t *word, uint32_t expected, double timeout_ms) {
+    struct timespec timeout;
+    if (timeout_ms >= 0) {
+        timeout.tv_sec = (time_t)(timeout_ms / 1000);
+        timeout.tv_nsec = (long)((timeout_ms - timeout.tv_sec * 1000.0) * 1e6);
+    }
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, timeout_ms >= 0 ? &timeout : NULL, NULL, 0);
+}
+
+// Same protocol as spsc_ring: the writer stores its flag before re-checking
+// the ring, the producer publishes before checking the flag
+static void wake_writer(alert_writer_t *writer) {
+    if (__atomic_load_n(&writer->writer_sleeping, __ATOMIC_SEQ_CST)) {
+        __atomic_store_n(&writer->writer_sleeping, 0, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, &writer->writer_sleeping, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+static int current_fd(const alert_writer_t *writer) {
+    if (writer->use_store) {
+        return writer->store.active_open ? writer->store.active.fd : -1;
+    }
+    return writer->fd;
+}
+
+static void *alert_writer_thread(void *arg) {
+    alert_writer_t *writer = arg;
+    char lines[ALERT_BATCH_SIZE][ALERT_LINE_LEN];
+    char text[ALERT_BATCH_SIZE][ALERT_LINE_LEN];
+    uint8_t records[ALERT_BATCH_SIZE][ALERT_LOG_RECORD_SIZE];
+    struct iovec file_iov[ALERT_BATCH_SIZE];
+    struct iovec text_iov[ALERT_BATCH_SIZE];
+    double last_sync = monotonic_ms();
+    bool unsynced = false;
+
+    for (;;) {
+        size_t tail = writer->tail;
+        size_t head = __atomic_load_n(&writer->head, __ATOMIC_ACQUIRE);
+        size_t available = head - tail;
+
+        if (available == 0) {
+            if (__atomic_load_n(&writer->stop, __ATOMIC_ACQUIRE)) {
+                // Producer has stopped; re-check once so nothing pushed before stop is lost
+                if (__atomic_load_n(&writer->head, __ATOMIC_ACQUIRE) == tail) break;
+                continue;
+            }
+            // Only a pending interval fsync needs a deadline; otherwise sleep
+            // until alert_writer_push or alert_writer_stop wakes us
+            double timeout_ms = -1;
+            if (unsynced && writer->fsync_policy == FSYNC_INTERVAL) {
+                timeout_ms = writer->fsync_interval_ms - (monotonic_ms() - last_sync);
+                if (timeout_ms <= 0) {
+                    fdatasync(current_fd(writer));
+                    last_sync = monotonic_ms();
+                    unsynced = false;
+                    timeout_ms = -1;
+                }
+            }
+            __atomic_store_n(&writer->writer_sleeping, 1, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&writer->head, __ATOMIC_SEQ_CST) == tail &&
+                !__atomic_load_n(&writer->stop, __ATOMIC_SEQ_CST)) {
+                futex_wait_ms(&writer->writer_sleeping, 1, timeout_ms);
+            }
+            __atomic_store_n(&writer->writer_sleeping, 0, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        int batch = available > ALERT_BATCH_SIZE ? ALERT_BATCH_SIZE : (int)available;
+        int encoded = 0;
+        alert_log_t *log = &writer->log;
+        if (writer->use_store) {
+            // May seal the current segment and start a new one
+            log = alert_store_prepare(&writer->store, batch);
+        }
+        for (int i = 0; i < batch; i++) {
+            const anomaly_alert_t *alert = &writer->records[(tail + i) & (writer->capacity - 1)];
+            if (writer->format == ALERT_FORMAT_BINARY) {
+                if (log && alert_log_encode(log, alert, records[encoded]) == 0) encoded++;
+            } else {
+                file_iov[i].iov_base = lines[i];
+                file_iov[i].iov_len = format_alert_json(alert, lines[i], ALERT_LINE_LEN);
+            }
+            if (writer->echo_stderr) {
+                text_iov[i].iov_base = text[i];
+                text_iov[i].iov_len = format_alert_text(alert, text[i], ALERT_LINE_LEN);
+            }
+        }
+
+        // Records are formatted, release the slots to the producer before doing I/O
+        __atomic_store_n(&writer->tail, tail + batch, __ATOMIC_RELEASE);
+
+        if (writer->format == ALERT_FORMAT_BINARY) {
+            if (!log || alert_log_write(log, records[0], encoded) != 0) {
+                writer->write_errors++;
+            } else if (writer->use_store) {
+                alert_store_commit(&writer->store, encoded);
+            }
+        } else if (writev_all(writer->fd, file_iov, batch) != 0) {
+            writer->write_errors++;
+        }
+        if (writer->echo_stderr) {
+            writev_all(STDERR_FILENO, text_iov, batch);
+        }
+        writer->written += batch;
+        writer->batches++;
+        unsynced = true;
+
+        if (writer->fsync_policy == FSYNC_BATCH) {
+            fdatasync(current_fd(writer));
+            unsynced = false;
+        } else if (writer->fsync_policy == FSYNC_INTERVAL &&
+                   monotonic_ms() - last_sync >= writer->fsync_interval_ms) {
+            fdatasync(current_fd(writer));
+            last_sync = monotonic_ms();
+            unsynced = false;
+        }
+    }
+
+    if (unsynced && writer->fsync_policy != FSYNC_NONE) {
+        fdatasync(current_fd(writer));
+    }
+
+    return NULL;
+}
+
+int alert_writer_start(alert_writer_t *writer, const config_t *config) {
+    memset(writer, 0, sizeof(alert_writer_t));
+
+    size_t capacity = 1;
+    size_t requested = config->alert_queue_capacity > 0 ? (size_t)config->alert_queue_capacity
+                                                        : ALERT_QUEUE_CAPACITY;
+    while (capacity < requested) capacity <<= 1;
+
+    writer->records = calloc(capacity, sizeof(anomaly_alert_t));
+    if (!writer->records) {
+        fprintf(stderr, "Failed to allocate alert queue (%zu records)\n", capacity);
+        return -1;
+    }
+    writer->capacity = capacity;
+    writer->echo_stderr = config->alert_echo_stderr;
+    writer->blocking = config->alert_queue_blocking;
+    writer->fsync_policy = config->alert_fsync_policy;
+    writer->fsync_interval_ms = config->alert_fsync_interval_ms;
+    writer->quiet = config->quiet;
+
+    writer->format = config->alert_format;
+    if (config->alert_store_directory[0]) {
+        // The segmented store always uses the binary record format
+        writer->format = ALERT_FORMAT_BINARY;
+        writer->use_store = true;
+        writer->fd = alert_store_open(&writer->store, config) == 0 ? writer->store.active.fd : -1;
+    } else if (writer->format == ALERT_FORMAT_BINARY) {
+        writer->fd = alert_log_open(&writer->log, config->alert_output_file) == 0 ? writer->log.fd : -1;
+    } else {
+        writer->fd = open(config->alert_output_file, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    }
+    if (writer->fd < 0) {
+        fprintf(stderr, "Failed to open alert file: %s\n", config->alert_output_file);
+        free(writer->records);
+        writer->records = NULL;
+        return -1;
+    }
+
+    if (pthread_create(&writer->thread, NULL, alert_writer_thread, writer) != 0) {
+        fprintf(stderr, "Failed to start alert writer thread\n");
+        if (writer->use_store) {
+            alert_store_close(&writer->store);
+        } else if (writer->format == ALERT_FORMAT_BINARY) {
+            alert_log_close(&writer->log);
+        } else {
+            close(writer->fd);
+        }
+        free(writer->records);
+        writer->records = NULL;
+        return -1;
+    }
+
+    placement_pin_thread(writer->thread, config->pipeline_cpus[STAGE_OUTPUT]);
+    writer->running = true;
+    return 0;
+}
+
+// Called from the detection thread: drops the record if the ring is full,
+// unless the writer is blocking, where it waits for the consumer instead
+int alert_writer_push(alert_writer_t *writer, const anomaly_alert_t *alert) {
+    size_t head = writer->head;
+    size_t tail = __atomic_load_n(&writer->tail, __ATOMIC_ACQUIRE);
+
+    while (head - tail >= writer->capacity) {
+        if (!writer->blocking) {
+            __atomic_fetch_add(&writer->dropped, 1, __ATOMIC_RELAXED);
+            return -1;
+        }
+        sched_yield();
+        tail = __atomic_load_n(&writer->tail, __ATOMIC_ACQUIRE);
+    }
+
+    writer->records[head & (writer->capacity - 1)] = *alert;
+    __atomic_store_n(&writer->head, head + 1, __ATOMIC_SEQ_CST);
+    wake_writer(writer);
+    return 0;
+}
+
+void alert_writer_stop(alert_writer_t *writer) {
+    if (!writer->running) return;
+
+    __atomic_store_n(&writer->stop, true, __ATOMIC_SEQ_CST);
+    wake_writer(writer);
+    pthread_join(writer->thread, NULL);
+    if (writer->use_store) {
+        alert_store_close(&writer->store);
+    } else if (writer->format == ALERT_FORMAT_BINARY) {
+        alert_log_close(&writer->log);
+    } else {
+        close(writer->fd);
+    }
+
+    if ((writer->written > 0 || writer->dropped > 0) && !writer->quiet) {
+        printf("Alert writer: %lu written in %lu batches, %lu dropped, %lu write errors\n",
+               (unsigned long)writer->written, (unsigned long)writer->batches,
+               (unsigned long)writer->dropped, (unsigned long)writer->write_errors);
+    }
+
+    free(writer->records);
+    writer->records = NULL;
+    writer->running = false;
+}
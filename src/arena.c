@@ -0,0 +1,95 @@
+#include "hpc_ids.h"
+#include <sys/mman.h>
+
+#define ARENA_ALIGN 16
+#define ARENA_TRIM_BYTES (1u << 20)   // only return pages to the kernel in 1 MB steps
+
+static size_t align_up(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Reserve `budget` bytes of address space. Nothing is committed until it is
+// touched, so the budget bounds resident memory without costing any up front.
+int arena_init(arena_t *arena, const char *name, size_t budget) {
+    memset(arena, 0, sizeof(arena_t));
+    arena->name = name;
+    arena->page_size = (size_t)sysconf(_SC_PAGESIZE);
+    arena->size = align_up(budget > 0 ? budget : arena->page_size, arena->page_size);
+
+    void *base = mmap(NULL, arena->size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (base == MAP_FAILED) {
+        perror("mmap arena");
+        arena->size = 0;
+        return -1;
+    }
+    arena->base = base;
+    return 0;
+}
+
+void arena_destroy(arena_t *arena) {
+    if (arena->base) {
+        munmap(arena->base, arena->size);
+    }
+    arena->base = NULL;
+    arena->size = 0;
+    arena->used = 0;
+}
+
+static void note_usage(arena_t *arena) {
+    if (arena->used > arena->peak) arena->peak = arena->used;
+    if (arena->used > arena->touched) arena->touched = arena->used;
+}
+
+// 16-byte aligned block, or NULL once the budget is exhausted
+void* arena_alloc(arena_t *arena, size_t size) {
+    size_t start = align_up(arena->used, ARENA_ALIGN);
+    if (!arena->base || start > arena->size || size > arena->size - start) {
+        arena->failures++;
+        return NULL;
+    }
+    arena->last = start;
+    arena->used = start + size;
+    note_usage(arena);
+    return arena->base + start;
+}
+
+// Resize the most recent allocation in place; the data never moves
+void* arena_grow(arena_t *arena, void *ptr, size_t size) {
+    if (!ptr) return arena_alloc(arena, size);
+    if ((uint8_t *)ptr != arena->base + arena->last || size > arena->size - arena->last) {
+        arena->failures++;
+        return NULL;
+    }
+    arena->used = arena->last + size;
+    note_usage(arena);
+    return ptr;
+}
+
+// Bytes still available to the most recent allocation if it grows
+size_t arena_available(const arena_t *arena) {
+    return arena->base ? arena->size - arena->used : 0;
+}
+
+size_t arena_mark(const arena_t *arena) {
+    return arena->used;
+}
+
+// Drop everything allocated after mark. Large releases hand their pages
+// back so a long collection does not keep its peak resident forever.
+void arena_release(arena_t *arena, size_t mark) {
+    if (mark >= arena->used) return;
+    arena->used = mark;
+    arena->last = mark;
+
+    size_t keep = align_up(mark, arena->page_size);
+    if (arena->touched > keep && arena->touched - keep >= ARENA_TRIM_BYTES) {
+        madvise(arena->base + keep, arena->touched - keep, MADV_DONTNEED);
+        arena->touched = keep;
+    }
+}
+
+void arena_report(const arena_t *arena) {
+    printf("%s memory: peak %.1f KB of %.1f MB budget%s\n", arena->name, arena->peak / 1024.0,
+           arena->size / (1024.0 * 1024.0), arena->failures ? ", budget exhausted" : "");
+}
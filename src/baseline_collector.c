@@ -5,61 +5,114 @@ int save_baseline(const baseline_t *baseline, const char *filename, const char *
                  const config_t *config, int sample_count);
 int build_perf_command(const config_t *config, const char *target, char *cmd_buffer, size_t buffer_size);
 
-int collect_baseline(hpc_ids_t *ids, const char *app_name) {
-    char app_path[MAX_PATH_LEN];
-    char cmd[1024];
-    hpc_measurement_t measurements[MAX_SAMPLES];
-    int measurement_count;
-    feature_vector_t feature_samples[MAX_SAMPLES];
-    int feature_count = 0;
+// Feature samples kept contiguous at the top of an arena, growing in place.
+// The arena's budget is the only limit on how many samples a collection keeps.
+typedef struct {
+    const config_t *config;
+    arena_t *arena;
+    feature_vector_t *features;
+    int count;
+    int capacity;
+    int warmup_skipped;     // intervals dropped as start-up transients
+    bool exhausted;
+    energy_meter_t *energy; // read at every interval boundary, NULL if off
+} sample_buffer_t;
+
+static void sample_buffer_init(sample_buffer_t *buffer, const config_t *config, arena_t *arena) {
+    memset(buffer, 0, sizeof(sample_buffer_t));
+    buffer->config = config;
+    buffer->arena = arena;
+}
+
+static int sample_buffer_append(sample_buffer_t *buffer, const feature_vector_t *features) {
+    if (buffer->count == buffer->capacity) {
+        size_t room = arena_available(buffer->arena) / sizeof(feature_vector_t);
+        size_t grow = buffer->capacity ? (size_t)buffer->capacity : 1024;
+        if (grow > room) grow = room;
+        if (grow > (size_t)(INT_MAX - buffer->capacity)) grow = INT_MAX - buffer->capacity;
+        
+        feature_vector_t *grown = grow > 0 ? arena_grow(buffer->arena, buffer->features,
+                                                        (buffer->capacity + grow) * sizeof(feature_vector_t))
+                                           : NULL;
+        if (!grown) {
+            buffer->exhausted = true;
+            fprintf(stderr, "Error: %s memory budget exhausted after %d samples, "
+                            "raise collection_memory_mb (%d MB)\n",
+                    buffer->arena->name, buffer->count, buffer->config->collection_memory_mb);
+            return -1;
+        }
+        buffer->features = grown;
+        buffer->capacity += grow;
+    }
+    buffer->features[buffer->count++] = *features;
+    return 0;
+}
+
+static int collect_interval(void *context, hpc_measurement_t *measurements, int count) {
+    sample_buffer_t *buffer = context;
+    feature_vector_t features;
+    hpc_measurement_t interval[MAX_EVENTS + ENERGY_EVENTS];
+    
+    // Read at every boundary, dropped intervals included, so each reading
+    // covers exactly one interval. The interval arrives as soon as its last
+    // counter does, so the reading ends where its counters end.
+    int total = count;
+    if (buffer->energy) {
+        memcpy(interval, measurements, count * sizeof(hpc_measurement_t));
+        total = energy_meter_append(buffer->energy, interval, count);
+        measurements = interval;
+    }
     
-    snprintf(app_path, sizeof(app_path), "%s/%s", ids->config.app_directory, app_name);
+    // Loader, page-fault and cache-fill transients at start-up are not part
+    // of the app's steady-state behaviour: drop every interval that began
+    // inside the warm-up window
+    double interval_start = count > 0 ? measurements[0].perf_time - buffer->config->sampling_interval_ms / 1000.0 : 0;
+    if (count > 0 && interval_start < buffer->config->warmup_seconds) {
+        buffer->warmup_skipped++;
+        return 0;
+    }
+    if (count != buffer->config->num_events || engineer_features(measurements, total, &features) != 0) {
+        return 0;
+    }
+    return sample_buffer_append(buffer, &features);
+}
+
+// One perf run of an app, streamed into buffer. Returns how many samples
+// were added, or -1 if perf failed.
+static int collect_run(const config_t *config, const char *app_path, int run, sample_buffer_t *buffer) {
+    char cmd[1024];
     
-    if (access(app_path, X_OK) != 0) {
-        fprintf(stderr, "Application not found: %s\n", app_path);
+    if (build_perf_command(config, app_path, cmd, sizeof(cmd)) != 0) {
+        fprintf(stderr, "Failed to build perf command\n");
         return -1;
     }
     
-    printf("Collecting baseline for %s...\n", app_name);
+    char timed_cmd[1200];
+    snprintf(timed_cmd, sizeof(timed_cmd), "timeout %d %s", 
+            config->max_runtime_seconds, cmd);
     
-    for (int run = 0; run < ids->config.runs_per_app; run++) {
-        printf("Run %d/%d for %s\n", run + 1, ids->config.runs_per_app, app_name);
-        
-        if (build_perf_command(&ids->config, app_path, cmd, sizeof(cmd)) != 0) {
-            fprintf(stderr, "Failed to build perf command\n");
-            continue;
-        }
-        
-        char timed_cmd[1200];
-        snprintf(timed_cmd, sizeof(timed_cmd), "timeout %d %s", 
-                ids->config.max_runtime_seconds, cmd);
-        
-        if (execute_perf_command(timed_cmd, measurements, &measurement_count, 
-                                ids->config.max_runtime_seconds) != 0) {
-            fprintf(stderr, "Failed to execute perf command for run %d\n", run + 1);
-            continue;
-        }
-        
-        // Process measurements into features
-        for (int i = 0; i < measurement_count && feature_count < MAX_SAMPLES; 
-             i += ids->config.num_events) {
-            
-            int interval_count = 0;
-            for (int j = 0; j < ids->config.num_events && (i + j) < measurement_count; j++) {
-                interval_count++;
-            }
-            
-            if (interval_count == ids->config.num_events) {
-                if (engineer_features(&measurements[i], interval_count, 
-                                    &feature_samples[feature_count]) == 0) {
-                    feature_count++;
-                }
-            }
-        }
-        
-        printf("Run %d collected %d total feature samples\n", run + 1, feature_count);
+    // Opened per run so the first reading does not span the gap between runs
+    energy_meter_t energy;
+    buffer->energy = energy_source_open(&energy, config) == 0 ? &energy : NULL;
+    
+    int before = buffer->count;
+    int result = stream_perf_command(timed_cmd, config->max_runtime_seconds, config->num_events,
+                                     collect_interval, buffer);
+    if (buffer->energy) {
+        energy_meter_close(&energy);
+        buffer->energy = NULL;
+    }
+    if (result < 0) {
+        fprintf(stderr, "Failed to execute perf command for run %d\n", run + 1);
+        return -1;
     }
     
+    return buffer->count - before;
+}
+
+// Compute and save the baseline for samples gathered over all runs
+static int finish_baseline(hpc_ids_t *ids, const config_t *config, const char *app_name,
+                           feature_vector_t *feature_samples, int feature_count) {
     if (feature_count < ids->config.min_samples_per_app) {
         fprintf(stderr, "Insufficient samples for %s: %d < %d\n", 
                 app_name, feature_count, ids->config.min_samples_per_app);
@@ -70,18 +123,26 @@ int collect_baseline(hpc_ids_t *ids, const char *app_name) {
     
     // Compute baseline statistics
     baseline_t baseline;
+    memset(&baseline, 0, sizeof(baseline));
     if (compute_baseline_from_features(&baseline, feature_samples, feature_count) != 0) {
         fprintf(stderr, "Failed to compute baseline statistics\n");
         return -1;
     }
     
+    int phases = compute_baseline_phases(&baseline, feature_samples, feature_count, config->max_phases,
+                                         config->min_samples_per_app, &ids->collection_arena);
+    if (phases < 0) {
+        fprintf(stderr, "Warning: no memory left for phase detection, saving a single-phase baseline\n");
+    } else if (phases > 1) {
+        printf("Detected %d execution phases for %s\n", phases, app_name);
+    }
+    
     // Save baseline to file
     char baseline_file[MAX_PATH_LEN];
     snprintf(baseline_file, sizeof(baseline_file), "%s/baseline_%s.json", 
              ids->config.baseline_directory, app_name);
     
-    if (save_baseline(&baseline, baseline_file, app_name, &ids->config, 
-                     feature_count) != 0) {
+    if (save_baseline(&baseline, baseline_file, app_name, config, feature_count) != 0) {
         fprintf(stderr, "Failed to save baseline to %s\n", baseline_file);
         return -1;
     }
@@ -90,44 +151,405 @@ int collect_baseline(hpc_ids_t *ids, const char *app_name) {
     return 0;
 }
 
-int compute_baseline_from_features(baseline_t *baseline, feature_vector_t *features, int count) {
-    double *values = malloc(count * sizeof(double));
+int collect_baseline(hpc_ids_t *ids, const char *app_name) {
+    char app_path[MAX_PATH_LEN];
+    
+    if (ids->config.collection_parallelism != 1) {
+        char apps[1][128];
+        strncpy(apps[0], app_name, sizeof(apps[0]) - 1);
+        apps[0][sizeof(apps[0]) - 1] = '\0';
+        return collect_baselines_parallel(ids, apps, 1) == 1 ? 0 : -1;
+    }
+    
+    snprintf(app_path, sizeof(app_path), "%s/%s", ids->config.app_directory, app_name);
+    
+    if (access(app_path, X_OK) != 0) {
+        fprintf(stderr, "Application not found: %s\n", app_path);
+        return -1;
+    }
+    
+    printf("Collecting baseline for %s...\n", app_name);
+    
+    // Sequential mode: after every run, stop once all medians and MADs are
+    // known to within convergence_tolerance MADs. Samples within a run are
+    // autocorrelated, which makes the intervals optimistic; min_runs_per_app
+    // keeps a single lucky run from ending collection.
+    config_t used = ids->config;
+    double tolerance = ids->config.convergence_tolerance;
+    int max_runs = ids->config.runs_per_app;
+    if (tolerance > 0) {
+        max_runs = ids->config.max_runs_per_app > 0 ? ids->config.max_runs_per_app
+                                                    : 2 * ids->config.runs_per_app;
+    }
+    
+    arena_t *arena = &ids->collection_arena;
+    size_t mark = arena_mark(arena);
+    sample_buffer_t samples;
+    sample_buffer_init(&samples, &ids->config, arena);
+    
+    int runs = 0;
+    bool converged = false;
+    for (int run = 0; run < max_runs && !samples.exhausted; run++) {
+        printf("Run %d/%d for %s\n", run + 1, max_runs, app_name);
+        runs = run + 1;
+        
+        if (collect_run(&ids->config, app_path, run, &samples) < 0) {
+            continue;
+        }
+        
+        printf("Run %d collected %d total feature samples\n", run + 1, samples.count);
+        
+        if (tolerance > 0 && runs >= ids->config.min_runs_per_app &&
+            samples.count >= ids->config.min_samples_per_app) {
+            baseline_t partial;
+            if (compute_baseline_from_features(&partial, samples.features, samples.count) != 0) continue;
+            double precision = baseline_precision(&partial);
+            printf("Precision after run %d: %.3f MAD (target %.3f)\n", runs, precision, tolerance);
+            if (precision <= tolerance) {
+                printf("Converged after %d of at most %d runs\n", runs, max_runs);
+                converged = true;
+                break;
+            }
+        }
+    }
+    
+    if (samples.warmup_skipped > 0) {
+        printf("Discarded %d warm-up intervals (first %.1f s of each run)\n",
+               samples.warmup_skipped, ids->config.warmup_seconds);
+    }
+    if (tolerance > 0 && !converged) {
+        fprintf(stderr, "Warning: %s did not converge within %d runs\n", app_name, runs);
+    }
+    used.runs_per_app = runs;
+    int result = finish_baseline(ids, &used, app_name, samples.features, samples.count);
+    arena_release(arena, mark);
+    return result;
+}
+
+// Parallel collection: every (app, run) pair is an independent job. Workers
+// are pinned to CPUs chosen under the isolation policy and perf inherits the
+// worker's affinity through popen, so concurrent runs never share a core
+// (or a last-level cache). Each worker streams a run into its own scratch
+// arena, then copies the finished run into the shared collection arena.
+// Runs are merged back in run order afterwards.
+typedef struct {
+    int app;
+    int run;
+    feature_vector_t *features;   // in the shared collection arena
+    int count;              // -1 if the run failed
+} collection_job_t;
+
+typedef struct {
+    const config_t *config;
+    arena_t *arena;         // shared, allocated from under lock
+    size_t scratch_budget;  // per-worker limit for the run in progress
+    char (*apps)[128];
+    collection_job_t *jobs;
+    int num_jobs;
+    int next_job;
+    pthread_mutex_t lock;
+} collection_queue_t;
+
+typedef struct {
+    collection_queue_t *queue;
+    int cpu;
+    pthread_t thread;
+} collection_worker_t;
+
+static void* collection_worker(void *arg) {
+    collection_worker_t *worker = arg;
+    collection_queue_t *queue = worker->queue;
+    
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(worker->cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        fprintf(stderr, "Warning: cannot pin collection worker to CPU %d\n", worker->cpu);
+    }
+    
+    // The app runs on the worker's CPU rather than the configured monitor CPUs.
+    // Package energy is shared by every concurrent run, so none of them gets it.
+    config_t config = *queue->config;
+    snprintf(config.monitor_cpus, sizeof(config.monitor_cpus), "%d", worker->cpu);
+    config.energy_source = ENERGY_SOURCE_OFF;
     
-    // Extract IPC values
-    for (int i = 0; i < count; i++) {
-        values[i] = features[i].ipc;
+    arena_t scratch;
+    bool have_scratch = arena_init(&scratch, "Run scratch", queue->scratch_budget) == 0;
+    
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        collection_job_t *job = queue->next_job < queue->num_jobs ? &queue->jobs[queue->next_job++] : NULL;
+        pthread_mutex_unlock(&queue->lock);
+        if (!job) break;
+        
+        job->count = -1;
+        if (!have_scratch) continue;
+        
+        char app_path[MAX_PATH_LEN + 128];
+        if (snprintf(app_path, sizeof(app_path), "%s/%s", queue->config->app_directory,
+                     queue->apps[job->app]) >= (int)sizeof(app_path)) {
+            fprintf(stderr, "Application path too long: %s\n", queue->apps[job->app]);
+            continue;
+        }
+        printf("Run %d/%d for %s on CPU %d\n", job->run + 1, queue->config->runs_per_app,
+               queue->apps[job->app], worker->cpu);
+        
+        sample_buffer_t samples;
+        sample_buffer_init(&samples, &config, &scratch);
+        int added = collect_run(&config, app_path, job->run, &samples);
+        if (added > 0) {
+            pthread_mutex_lock(&queue->lock);
+            job->features = arena_alloc(queue->arena, added * sizeof(feature_vector_t));
+            pthread_mutex_unlock(&queue->lock);
+            if (job->features) {
+                memcpy(job->features, samples.features, added * sizeof(feature_vector_t));
+                job->count = added;
+            } else {
+                fprintf(stderr, "Error: collection memory budget exhausted, run %d of %s dropped\n",
+                        job->run + 1, queue->apps[job->app]);
+            }
+        } else if (added == 0) {
+            job->count = 0;
+        }
+        arena_release(&scratch, 0);
+    }
+    
+    if (have_scratch) arena_destroy(&scratch);
+    return NULL;
+}
+
+static void run_collection_jobs(const config_t *config, arena_t *arena, char apps[][128],
+                                collection_job_t *jobs, int num_jobs, const int *cpus, int num_cpus) {
+    int num_workers = num_cpus < num_jobs ? num_cpus : num_jobs;
+    if (num_workers <= 0) return;
+    // Runs in flight share one more collection budget between them
+    collection_queue_t queue = { config, arena, arena->size / num_workers, apps, jobs, num_jobs, 0,
+                                 PTHREAD_MUTEX_INITIALIZER };
+    collection_worker_t *workers = calloc(num_workers, sizeof(collection_worker_t));
+    if (!workers) return;
+    
+    int started = 0;
+    for (int w = 0; w < num_workers; w++) {
+        workers[w].queue = &queue;
+        workers[w].cpu = cpus[w];
+        if (pthread_create(&workers[w].thread, NULL, collection_worker, &workers[w]) != 0) break;
+        started++;
+    }
+    for (int w = 0; w < started; w++) {
+        pthread_join(workers[w].thread, NULL);
+    }
+    free(workers);
+}
+
+static int select_collection_cpus(const hpc_ids_t *ids, int *cpus, int max_cpus) {
+    // Choose from the whole process mask, not the housekeeping CPUs this thread runs on
+    const config_t *config = &ids->config;
+    const cpu_set_t *allowed = CPU_COUNT(&ids->placement.allowed) > 0 ? &ids->placement.allowed : NULL;
+    cpu_topology_t *topology = malloc(sizeof(cpu_topology_t));
+    if (!topology || topology_load(topology, allowed) <= 0) {
+        free(topology);
+        return -1;
     }
-    compute_baseline_stats(&baseline->ipc, values, count);
     
-    // Extract branch miss rate values
-    for (int i = 0; i < count; i++) {
-        values[i] = features[i].branch_miss_rate;
+    if (config->collection_parallelism > 0 && config->collection_parallelism < max_cpus) {
+        max_cpus = config->collection_parallelism;
+    }
+    int count = topology_select_cpus(topology, config->collection_isolation, cpus, max_cpus);
+    
+    printf("Collection CPUs (%s isolation%s):", isolation_policy_name(config->collection_isolation),
+           topology->has_isolated ? ", isolcpus only" : "");
+    for (int i = 0; i < count; i++) printf(" %d", cpus[i]);
+    printf("\n");
+    if (config->collection_parallelism > count) {
+        fprintf(stderr, "Warning: only %d CPUs satisfy the isolation policy, %d runs requested\n",
+                count, config->collection_parallelism);
     }
-    compute_baseline_stats(&baseline->branch_miss_rate, values, count);
     
-    // Extract cache miss rate values
-    for (int i = 0; i < count; i++) {
-        values[i] = features[i].cache_miss_rate;
+    free(topology);
+    return count;
+}
+
+static collection_job_t* make_collection_jobs(const config_t *config, int app_count, int *num_jobs) {
+    *num_jobs = app_count * config->runs_per_app;
+    collection_job_t *jobs = calloc(*num_jobs > 0 ? *num_jobs : 1, sizeof(collection_job_t));
+    if (!jobs) return NULL;
+    for (int i = 0; i < *num_jobs; i++) {
+        jobs[i].app = i / config->runs_per_app;
+        jobs[i].run = i % config->runs_per_app;
+    }
+    return jobs;
+}
+
+// Concatenate one app's runs in run order, as the serial collector would.
+// The result is allocated from arena; NULL if there are no samples.
+static feature_vector_t* merge_runs(arena_t *arena, const collection_job_t *jobs, int num_jobs, int app,
+                                    int *count) {
+    size_t total = 0;
+    for (int i = 0; i < num_jobs; i++) {
+        if (jobs[i].app == app && jobs[i].count > 0) total += jobs[i].count;
     }
-    compute_baseline_stats(&baseline->cache_miss_rate, values, count);
+    *count = 0;
+    if (total == 0 || total > INT_MAX) return NULL;
     
-    // Extract L1D MPKI values
-    for (int i = 0; i < count; i++) {
-        values[i] = features[i].l1d_mpki;
+    feature_vector_t *out = arena_alloc(arena, total * sizeof(feature_vector_t));
+    if (!out) {
+        fprintf(stderr, "Error: collection memory budget exhausted merging %zu samples\n", total);
+        return NULL;
+    }
+    for (int i = 0; i < num_jobs; i++) {
+        if (jobs[i].app != app || jobs[i].count <= 0) continue;
+        memcpy(&out[*count], jobs[i].features, jobs[i].count * sizeof(feature_vector_t));
+        *count += jobs[i].count;
+    }
+    return out;
+}
+
+int collect_baselines_parallel(hpc_ids_t *ids, char apps[][128], int app_count) {
+    if (ids->config.convergence_tolerance > 0) {
+        fprintf(stderr, "Warning: convergence_tolerance applies to serial collection only, "
+                        "running %d runs per app\n", ids->config.runs_per_app);
     }
-    compute_baseline_stats(&baseline->l1d_mpki, values, count);
     
-    // Extract iTLB MPKI values
-    for (int i = 0; i < count; i++) {
-        values[i] = features[i].itlb_mpki;
+    int cpus[MAX_CPUS];
+    int num_cpus = select_collection_cpus(ids, cpus, MAX_CPUS);
+    if (num_cpus <= 0) {
+        fprintf(stderr, "No CPUs available for collection\n");
+        return -1;
     }
-    compute_baseline_stats(&baseline->itlb_mpki, values, count);
     
-    // Extract dTLB MPKI values
-    for (int i = 0; i < count; i++) {
-        values[i] = features[i].dtlb_mpki;
+    int num_jobs;
+    collection_job_t *jobs = make_collection_jobs(&ids->config, app_count, &num_jobs);
+    if (!jobs) {
+        return -1;
+    }
+    
+    arena_t *arena = &ids->collection_arena;
+    size_t mark = arena_mark(arena);
+    int num_workers = num_cpus < num_jobs ? num_cpus : num_jobs;
+    printf("Running %d collection jobs on %d CPUs\n", num_jobs, num_workers);
+    run_collection_jobs(&ids->config, arena, apps, jobs, num_jobs, cpus, num_cpus);
+    
+    // Record the CPUs the runs actually used as the baseline's placement
+    config_t used = ids->config;
+    cpu_set_t used_cpus;
+    CPU_ZERO(&used_cpus);
+    for (int i = 0; i < num_workers; i++) CPU_SET(cpus[i], &used_cpus);
+    format_cpu_list(&used_cpus, used.monitor_cpus, sizeof(used.monitor_cpus));
+    
+    int success_count = 0;
+    for (int a = 0; a < app_count; a++) {
+        size_t app_mark = arena_mark(arena);
+        int count;
+        feature_vector_t *samples = merge_runs(arena, jobs, num_jobs, a, &count);
+        if (finish_baseline(ids, &used, apps[a], samples, count) == 0) {
+            success_count++;
+        }
+        arena_release(arena, app_mark);
+    }
+    
+    free(jobs);
+    arena_release(arena, mark);
+    return success_count;
+}
+
+// Collect an app once with runs one at a time on a single pinned CPU and once
+// with runs spread over all selected CPUs, then test each feature for a
+// distribution shift. A feature passes when neither the KS nor the
+// Mann-Whitney test rejects at 5% and the medians differ by at most half a
+// serial MAD (a robust z of 0.5, far below any alert threshold).
+int validate_parallel_collection(hpc_ids_t *ids, const char *app_name) {
+    int cpus[MAX_CPUS];
+    int num_cpus = select_collection_cpus(ids, cpus, MAX_CPUS);
+    if (num_cpus <= 0) {
+        fprintf(stderr, "No CPUs available for collection\n");
+        return -1;
+    }
+    if (num_cpus == 1) {
+        fprintf(stderr, "Warning: only one CPU selected, parallel and serial runs are identical\n");
+    }
+    
+    char apps[1][128];
+    strncpy(apps[0], app_name, sizeof(apps[0]) - 1);
+    apps[0][sizeof(apps[0]) - 1] = '\0';
+    
+    int num_jobs;
+    collection_job_t *serial_jobs = make_collection_jobs(&ids->config, 1, &num_jobs);
+    collection_job_t *parallel_jobs = make_collection_jobs(&ids->config, 1, &num_jobs);
+    arena_t *arena = &ids->collection_arena;
+    size_t mark = arena_mark(arena);
+    int failures = -1;
+    
+    if (serial_jobs && parallel_jobs) {
+        printf("=== Serial collection of %s on CPU %d ===\n", app_name, cpus[0]);
+        run_collection_jobs(&ids->config, arena, apps, serial_jobs, num_jobs, cpus, 1);
+        printf("=== Parallel collection of %s on %d CPUs ===\n", app_name, num_cpus);
+        run_collection_jobs(&ids->config, arena, apps, parallel_jobs, num_jobs, cpus, num_cpus);
+        
+        int n, m;
+        feature_vector_t *serial = merge_runs(arena, serial_jobs, num_jobs, 0, &n);
+        feature_vector_t *parallel = merge_runs(arena, parallel_jobs, num_jobs, 0, &m);
+        double *a = n > 0 ? arena_alloc(arena, n * sizeof(double)) : NULL;
+        double *b = m > 0 ? arena_alloc(arena, m * sizeof(double)) : NULL;
+        printf("\nSerial samples: %d, parallel samples: %d\n", n, m);
+        
+        if (serial && parallel && a && b) {
+            failures = 0;
+            printf("%-18s %12s %12s %8s %8s %8s %8s  %s\n", "feature", "serial_med", "parallel_med",
+                   "d_med/mad", "ks_D", "ks_p", "mw_p", "verdict");
+            for (int f = 0; f < NUM_FEATURES; f++) {
+                if (ENERGY_FEATURE_MASK & (1u << f)) continue;   // not measured by parallel runs
+                size_t offset = feature_table[f].value_offset;
+                for (int i = 0; i < n; i++) a[i] = *(const double *)((const char *)&serial[i] + offset);
+                for (int i = 0; i < m; i++) b[i] = *(const double *)((const char *)&parallel[i] + offset);
+                
+                double med_a = compute_median(a, n);
+                double med_b = compute_median(b, m);
+                double mad = compute_mad(a, n, med_a);
+                double shift = fabs(med_b - med_a) / (mad > 1e-12 ? mad : 1e-12);
+                double ks_d;
+                double ks_p = ks_two_sample(a, n, b, m, &ks_d);
+                double mw_p = mann_whitney_u(a, n, b, m, NULL);
+                bool equivalent = ks_p > 0.05 && mw_p > 0.05 && shift <= 0.5;
+                if (!equivalent) failures++;
+                
+                printf("%-18s %12.6g %12.6g %8.3f %8.3f %8.3f %8.3f  %s\n", feature_table[f].name,
+                       med_a, med_b, shift, ks_d, ks_p, mw_p, equivalent ? "equivalent" : "DIFFERENT");
+            }
+            printf("%s\n", failures == 0 ? "Parallel collection is statistically equivalent"
+                                          : "Parallel collection perturbs the baseline");
+        } else {
+            fprintf(stderr, "Not enough samples to compare\n");
+        }
+    }
+    
+    free(serial_jobs);
+    free(parallel_jobs);
+    arena_release(arena, mark);
+    return failures;
+}
+
+int compute_baseline_from_features(baseline_t *baseline, feature_vector_t *features, int count) {
+    double *values = malloc(count * sizeof(double));
+    if (!values) return -1;
+    
+    baseline->energy_mask = 0;
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        uint32_t bit = 1u << f;
+        baseline_stats_t *stats = (baseline_stats_t *)((char *)baseline + feature_table[f].baseline_offset);
+        
+        // Energy features only exist in intervals where the meter was read
+        int n = 0;
+        for (int i = 0; i < count; i++) {
+            if ((ENERGY_FEATURE_MASK & bit) && !(features[i].energy_mask & bit)) continue;
+            values[n++] = *(const double *)((const char *)&features[i] + feature_table[f].value_offset);
+        }
+        if (n == 0) {
+            memset(stats, 0, sizeof(baseline_stats_t));
+            continue;
+        }
+        compute_baseline_stats(stats, values, n);
+        if (ENERGY_FEATURE_MASK & bit) baseline->energy_mask |= bit;
     }
-    compute_baseline_stats(&baseline->dtlb_mpki, values, count);
     
     free(values);
     return 0;
@@ -151,6 +573,18 @@ int save_baseline(const baseline_t *baseline, const char *filename, const char *
     fprintf(file, "    \"collection_timestamp\": \"%s\",\n", timestamp);
     fprintf(file, "    \"runs_executed\": %d,\n", config->runs_per_app);
     fprintf(file, "    \"samples_collected\": %d,\n", sample_count);
+    
+    // Worst 95% CI half-width over all medians and MADs, in MAD units
+    double precision = baseline_precision(baseline);
+    if (isfinite(precision)) {
+        fprintf(file, "    \"precision\": %.6f,\n", precision);
+    } else {
+        fprintf(file, "    \"precision\": null,\n");
+    }
+    if (config->convergence_tolerance > 0) {
+        fprintf(file, "    \"convergence_tolerance\": %.6f,\n", config->convergence_tolerance);
+        fprintf(file, "    \"converged\": %s,\n", precision <= config->convergence_tolerance ? "true" : "false");
+    }
     fprintf(file, "    \"events\": [");
     
     for (int i = 0; i < config->num_events; i++) {
@@ -161,67 +595,64 @@ int save_baseline(const baseline_t *baseline, const char *filename, const char *
     fprintf(file, "],\n");
     fprintf(file, "    \"config\": {\n");
     fprintf(file, "      \"sampling_interval_ms\": %d,\n", config->sampling_interval_ms);
-    fprintf(file, "      \"core_affinity\": %d\n", config->core_affinity);
+    fprintf(file, "      \"core_affinity\": %d,\n", config->core_affinity);
+    fprintf(file, "      \"monitor_cpus\": \"%s\",\n", config->monitor_cpus);
+    fprintf(file, "      \"housekeeping_cpus\": \"%s\",\n", config->housekeeping_cpus);
+    fprintf(file, "      \"collection_parallelism\": %d,\n", config->collection_parallelism);
+    fprintf(file, "      \"collection_isolation\": \"%s\"\n", isolation_policy_name(config->collection_isolation));
     fprintf(file, "    }\n");
     fprintf(file, "  },\n");
     
     fprintf(file, "  \"baseline_statistics\": {\n");
     
-    fprintf(file, "    \"ipc\": {\n");
-    fprintf(file, "      \"median\": %.15f,\n", baseline->ipc.median);
-    fprintf(file, "      \"mad\": %.15f,\n", baseline->ipc.mad);
-    fprintf(file, "      \"method\": \"robust_median_mad\",\n");
-    fprintf(file, "      \"min\": %.15f,\n", baseline->ipc.min);
-    fprintf(file, "      \"max\": %.15f,\n", baseline->ipc.max);
-    fprintf(file, "      \"samples\": %d\n", baseline->ipc.samples);
-    fprintf(file, "    },\n");
-    
-    fprintf(file, "    \"branch_miss_rate\": {\n");
-    fprintf(file, "      \"median\": %.15f,\n", baseline->branch_miss_rate.median);
-    fprintf(file, "      \"mad\": %.15f,\n", baseline->branch_miss_rate.mad);
-    fprintf(file, "      \"method\": \"robust_median_mad\",\n");
-    fprintf(file, "      \"min\": %.15f,\n", baseline->branch_miss_rate.min);
-    fprintf(file, "      \"max\": %.15f,\n", baseline->branch_miss_rate.max);
-    fprintf(file, "      \"samples\": %d\n", baseline->branch_miss_rate.samples);
-    fprintf(file, "    },\n");
-    
-    fprintf(file, "    \"cache_miss_rate\": {\n");
-    fprintf(file, "      \"median\": %.15f,\n", baseline->cache_miss_rate.median);
-    fprintf(file, "      \"mad\": %.15f,\n", baseline->cache_miss_rate.mad);
-    fprintf(file, "      \"method\": \"robust_median_mad\",\n");
-    fprintf(file, "      \"min\": %.15f,\n", baseline->cache_miss_rate.min);
-    fprintf(file, "      \"max\": %.15f,\n", baseline->cache_miss_rate.max);
-    fprintf(file, "      \"samples\": %d\n", baseline->cache_miss_rate.samples);
-    fprintf(file, "    },\n");
-    
-    fprintf(file, "    \"l1d_mpki\": {\n");
-    fprintf(file, "      \"median\": %.15f,\n", baseline->l1d_mpki.median);
-    fprintf(file, "      \"mad\": %.15f,\n", baseline->l1d_mpki.mad);
-    fprintf(file, "      \"method\": \"robust_median_mad\",\n");
-    fprintf(file, "      \"min\": %.15f,\n", baseline->l1d_mpki.min);
-    fprintf(file, "      \"max\": %.15f,\n", baseline->l1d_mpki.max);
-    fprintf(file, "      \"samples\": %d\n", baseline->l1d_mpki.samples);
-    fprintf(file, "    },\n");
-    
-    fprintf(file, "    \"itlb_mpki\": {\n");
-    fprintf(file, "      \"median\": %.15f,\n", baseline->itlb_mpki.median);
-    fprintf(file, "      \"mad\": %.15f,\n", baseline->itlb_mpki.mad);
-    fprintf(file, "      \"method\": \"robust_median_mad\",\n");
-    fprintf(file, "      \"min\": %.15f,\n", baseline->itlb_mpki.min);
-    fprintf(file, "      \"max\": %.15f,\n", baseline->itlb_mpki.max);
-    fprintf(file, "      \"samples\": %d\n", baseline->itlb_mpki.samples);
-    fprintf(file, "    },\n");
-    
-    fprintf(file, "    \"dtlb_mpki\": {\n");
-    fprintf(file, "      \"median\": %.15f,\n", baseline->dtlb_mpki.median);
-    fprintf(file, "      \"mad\": %.15f,\n", baseline->dtlb_mpki.mad);
-    fprintf(file, "      \"method\": \"robust_median_mad\",\n");
-    fprintf(file, "      \"min\": %.15f,\n", baseline->dtlb_mpki.min);
-    fprintf(file, "      \"max\": %.15f,\n", baseline->dtlb_mpki.max);
-    fprintf(file, "      \"samples\": %d\n", baseline->dtlb_mpki.samples);
-    fprintf(file, "    }\n");
+    // Energy features are written only when the collection measured them
+    int last = NUM_FEATURES - 1;
+    while (last > 0 && ((ENERGY_FEATURE_MASK & ~baseline->energy_mask) & (1u << last))) last--;
+    for (int f = 0; f <= last; f++) {
+        if ((ENERGY_FEATURE_MASK & ~baseline->energy_mask) & (1u << f)) continue;
+        const baseline_stats_t *stats =
+            (const baseline_stats_t *)((const char *)baseline + feature_table[f].baseline_offset);
+        fprintf(file, "    \"%s\": {\n", feature_table[f].name);
+        fprintf(file, "      \"median\": %.15f,\n", stats->median);
+        fprintf(file, "      \"mad\": %.15f,\n", stats->mad);
+        fprintf(file, "      \"method\": \"robust_median_mad\",\n");
+        fprintf(file, "      \"min\": %.15f,\n", stats->min);
+        fprintf(file, "      \"max\": %.15f,\n", stats->max);
+        fprintf(file, "      \"median_ci\": %.15f,\n", stats->median_ci);
+        fprintf(file, "      \"mad_ci\": %.15f,\n", stats->mad_ci);
+        fprintf(file, "      \"samples\": %d\n", stats->samples);
+        fprintf(file, "    }%s\n", f < last ? "," : "");
+    }
     
-    fprintf(file, "  }\n");
+    fprintf(file, "  }%s\n", baseline->num_phases > 1 ? "," : "");
+    
+    // Per-phase statistics; the centroid is the phase mean of each feature
+    if (baseline->num_phases > 1) {
+        fprintf(file, "  \"phases\": [\n");
+        for (int p = 0; p < baseline->num_phases; p++) {
+            const baseline_phase_t *phase = &baseline->phases[p];
+            fprintf(file, "    {\n");
+            fprintf(file, "      \"weight\": %.6f,\n", phase->weight);
+            fprintf(file, "      \"centroid\": {");
+            for (int f = 0; f <= last; f++) {
+                if ((ENERGY_FEATURE_MASK & ~baseline->energy_mask) & (1u << f)) continue;
+                fprintf(file, "%s\"%s\": %.15f", f ? ", " : "", feature_table[f].name, baseline->centroids[f][p]);
+            }
+            fprintf(file, "},\n");
+            fprintf(file, "      \"statistics\": {\n");
+            for (int f = 0; f <= last; f++) {
+                if ((ENERGY_FEATURE_MASK & ~baseline->energy_mask) & (1u << f)) continue;
+                const baseline_stats_t *stats = &phase->stats[f];
+                fprintf(file, "        \"%s\": {\"median\": %.15f, \"mad\": %.15f, \"min\": %.15f, "
+                              "\"max\": %.15f, \"median_ci\": %.15f, \"mad_ci\": %.15f, \"samples\": %d}%s\n",
+                        feature_table[f].name, stats->median, stats->mad, stats->min, stats->max,
+                        stats->median_ci, stats->mad_ci, stats->samples, f < last ? "," : "");
+            }
+            fprintf(file, "      }\n");
+            fprintf(file, "    }%s\n", p < baseline->num_phases - 1 ? "," : "");
+        }
+        fprintf(file, "  ]\n");
+    }
     fprintf(file, "}\n");
     
     fclose(file);
@@ -229,16 +660,23 @@ int save_baseline(const baseline_t *baseline, const char *filename, const char *
 }
 
 int collect_all_baselines(hpc_ids_t *ids) {
-    char apps[MAX_APPS][128];
-    int app_count = get_available_apps(ids->config.app_directory, apps, MAX_APPS);
+    char (*apps)[128];
+    int app_count = get_available_apps(ids->config.app_directory, &apps);
     
-    if (app_count == 0) {
-        fprintf(stderr, "No applications found in %s\n", ids->config.app_directory);
+    if (app_count <= 0) {
+        if (app_count == 0) fprintf(stderr, "No applications found in %s\n", ids->config.app_directory);
         return -1;
     }
     
     printf("Found %d applications\n", app_count);
     
+    if (ids->config.collection_parallelism != 1) {
+        int success_count = collect_baselines_parallel(ids, apps, app_count);
+        printf("Success: %d/%d applications\n", success_count < 0 ? 0 : success_count, app_count);
+        free(apps);
+        return success_count;
+    }
+    
     int success_count = 0;
     for (int i = 0; i < app_count; i++) {
         printf("\n%s\n", "==================================================");
@@ -258,5 +696,6 @@ int collect_all_baselines(hpc_ids_t *ids) {
     printf("Success: %d/%d applications\n", success_count, app_count);
     printf("%s\n", "==================================================");
     
+    free(apps);
     return success_count;
 }
\ No newline at end of file
@@ -12,12 +12,20 @@ void print_usage(const char *program_name) {
     printf("Options:\n");
     printf("  -a, --app NAME         Collect baseline for specific application\n");
     printf("  -r, --runs NUMBER      Number of runs per application (default: 10)\n");
+    printf("  -t, --tolerance MADS   Stop once every median and MAD is known to within MADS\n");
+    printf("  -m, --max-runs NUMBER  Cap on runs with --tolerance (default: twice --runs)\n");
     printf("  -c, --config FILE      Configuration file path (default: config/rigorous_hpc_config.json)\n");
+    printf("  -j, --jobs NUMBER      Concurrent runs on separate CPUs (0 = one per isolated CPU)\n");
+    printf("  -i, --isolation POLICY CPU isolation between concurrent runs: none, smt or llc\n");
+    printf("  -V, --validate         Compare serial and parallel collection of --app, save nothing\n");
     printf("  -h, --help             Show this help message\n");
     printf("\nExamples:\n");
     printf("  %s                           # Collect baselines for all applications\n", program_name);
     printf("  %s --app matmul              # Collect baseline for matmul only\n", program_name);
     printf("  %s --app crypto --runs 15    # Collect baseline for crypto with 15 runs\n", program_name);
+    printf("  %s --app matmul -t 0.05      # Run matmul until its baseline is precise\n", program_name);
+    printf("  %s --jobs 0 --isolation llc  # All apps, one run per last-level cache\n", program_name);
+    printf("  %s --app matmul --jobs 4 -V  # Check that 4-way parallel runs match serial\n", program_name);
 }
 
 int main(int argc, char *argv[]) {
@@ -26,16 +34,26 @@ int main(int argc, char *argv[]) {
     char *app_name = NULL;
     char *config_file = "config/rigorous_hpc_config.json";
     int runs = 0; // 0 means use config default
+    double tolerance = -1.0; // negative means use config default
+    int max_runs = 0;
+    int jobs = -1; // -1 means use config default
+    char *isolation = NULL;
+    bool validate = false;
     
     static struct option long_options[] = {
         {"app",    required_argument, 0, 'a'},
         {"runs",   required_argument, 0, 'r'},
+        {"tolerance", required_argument, 0, 't'},
+        {"max-runs", required_argument, 0, 'm'},
         {"config", required_argument, 0, 'c'},
+        {"jobs",   required_argument, 0, 'j'},
+        {"isolation", required_argument, 0, 'i'},
+        {"validate", no_argument,     0, 'V'},
         {"help",   no_argument,       0, 'h'},
         {0, 0, 0, 0}
     };
     
-    while ((opt = getopt_long(argc, argv, "a:r:c:h", long_options, NULL)) != -1) {
+    while ((opt = getopt_long(argc, argv, "a:r:t:m:c:j:i:Vh", long_options, NULL)) != -1) {
         switch (opt) {
             case 'a':
                 app_name = optarg;
@@ -47,9 +65,36 @@ int main(int argc, char *argv[]) {
                     return 1;
                 }
                 break;
+            case 't':
+                tolerance = atof(optarg);
+                if (tolerance <= 0) {
+                    fprintf(stderr, "Tolerance must be positive\n");
+                    return 1;
+                }
+                break;
+            case 'm':
+                max_runs = atoi(optarg);
+                if (max_runs <= 0) {
+                    fprintf(stderr, "Maximum number of runs must be positive\n");
+                    return 1;
+                }
+                break;
             case 'c':
                 config_file = optarg;
                 break;
+            case 'j':
+                jobs = atoi(optarg);
+                if (jobs < 0) {
+                    fprintf(stderr, "Number of jobs must not be negative\n");
+                    return 1;
+                }
+                break;
+            case 'i':
+                isolation = optarg;
+                break;
+            case 'V':
+                validate = true;
+                break;
             case 'h':
                 print_usage(argv[0]);
                 return 0;
@@ -69,6 +114,20 @@ int main(int argc, char *argv[]) {
     if (runs > 0) {
         ids.config.runs_per_app = runs;
     }
+    if (tolerance > 0) {
+        ids.config.convergence_tolerance = tolerance;
+    }
+    if (max_runs > 0) {
+        ids.config.max_runs_per_app = max_runs;
+    }
+    if (jobs >= 0) {
+        ids.config.collection_parallelism = jobs;
+    }
+    if (isolation && parse_isolation_policy(isolation, &ids.config.collection_isolation) != 0) {
+        fprintf(stderr, "Unknown isolation policy: %s\n", isolation);
+        hpc_ids_cleanup(&ids);
+        return 1;
+    }
     
     // Signal handler for graceful shutdown
     signal(SIGINT, SIG_DFL);
@@ -76,7 +135,15 @@ int main(int argc, char *argv[]) {
     
     int result = 0;
     
-    if (app_name) {
+    if (validate) {
+        if (!app_name) {
+            fprintf(stderr, "--validate needs --app\n");
+            result = 1;
+        } else {
+            printf("=== VALIDATING PARALLEL COLLECTION FOR %s ===\n", app_name);
+            result = validate_parallel_collection(&ids, app_name) == 0 ? 0 : 1;
+        }
+    } else if (app_name) {
         printf("=== COLLECTING BASELINE FOR %s ===\n", app_name);
         result = collect_baseline(&ids, app_name);
         
@@ -0,0 +1,93 @@
+#include "hpc_ids.h"
+#include <getopt.h>
+
+void print_usage(const char *program_name) {
+    printf("Usage: %s [OPTIONS]\n", program_name);
+    printf("Compile JSON baselines into a single binary baseline store\n\n");
+    printf("Options:\n");
+    printf("  -c, --config FILE      Configuration file path (default: config/rigorous_hpc_config.json)\n");
+    printf("  -d, --dir DIR          Baseline directory (default: baseline_directory from config)\n");
+    printf("  -o, --output FILE      Output file (default: baseline_store_file or DIR/baselines.bin)\n");
+    printf("  -h, --help             Show this help message\n");
+    printf("\nExamples:\n");
+    printf("  %s --config config.json\n", program_name);
+    printf("  %s --dir ../baselines --output /dev/shm/baselines.bin\n", program_name);
+}
+
+int main(int argc, char *argv[]) {
+    hpc_ids_t ids;
+    int opt;
+    char *config_file = "config/rigorous_hpc_config.json";
+    char *baseline_dir = NULL;
+    char *output_file = NULL;
+    
+    static struct option long_options[] = {
+        {"config", required_argument, 0, 'c'},
+        {"dir",    required_argument, 0, 'd'},
+        {"output", required_argument, 0, 'o'},
+        {"help",   no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+    
+    while ((opt = getopt_long(argc, argv, "c:d:o:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'c':
+                config_file = optarg;
+                break;
+            case 'd':
+                baseline_dir = optarg;
+                break;
+            case 'o':
+                output_file = optarg;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    
+    memset(&ids, 0, sizeof(ids));
+    if (load_config(&ids.config, config_file) != 0) {
+        fprintf(stderr, "Failed to load configuration from %s\n", config_file);
+        return 1;
+    }
+    if (baseline_dir) {
+        strncpy(ids.config.baseline_directory, baseline_dir, sizeof(ids.config.baseline_directory) - 1);
+    }
+    
+    char store_path[BASELINE_STORE_PATH_LEN];
+    if (output_file) {
+        if (strlen(output_file) >= sizeof(store_path)) {
+            fprintf(stderr, "Output path too long: %s\n", output_file);
+            return 1;
+        }
+        strcpy(store_path, output_file);
+    } else if (ids.config.baseline_store_file[0]) {
+        strcpy(store_path, ids.config.baseline_store_file);
+    } else {
+        if (snprintf(store_path, sizeof(store_path), "%s/baselines.bin",
+                     ids.config.baseline_directory) >= (int)sizeof(store_path)) {
+            fprintf(stderr, "Baseline directory path too long: %s\n", ids.config.baseline_directory);
+            return 1;
+        }
+    }
+    
+    if (baseline_table_init(&ids.app_baselines, 0) != 0) {
+        fprintf(stderr, "Failed to allocate baseline table\n");
+        return 1;
+    }
+    
+    bool has_global = false;
+    int count = load_json_baselines(&ids, &has_global);
+    if (count < 0) {
+        baseline_table_free(&ids.app_baselines);
+        return 1;
+    }
+    
+    int result = baseline_store_write(store_path, &ids.global_baseline, has_global, &ids.app_baselines);
+    baseline_table_free(&ids.app_baselines);
+    return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+#include "hpc_ids.h"
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+#define GLOBAL_BASELINE_FILE "rigorous_baseline.json"
+
+// Enter the target's reader epoch and return the version to score against.
+// Per-app entries without a baseline fall back to the global one.
+const baseline_t* baseline_acquire(hpc_ids_t *ids, target_state_t *target) {
+    if (target->reader >= 0) {
+        uint64_t epoch = __atomic_load_n(&ids->baseline_epoch, __ATOMIC_ACQUIRE);
+        __atomic_store_n(&ids->baseline_readers[target->reader].epoch, epoch, __ATOMIC_SEQ_CST);
+    } else {
+        // All reader slots taken: fall back to excluding reclamation
+        pthread_mutex_lock(&ids->baseline_lock);
+    }
+
+    const baseline_t *baseline = __atomic_load_n(&target->entry->current, __ATOMIC_SEQ_CST);
+    target->per_app = baseline != NULL && target->entry != &ids->global_entry;
+    if (!baseline) {
+        baseline = __atomic_load_n(&ids->global_entry.current, __ATOMIC_SEQ_CST);
+    }
+    return baseline;
+}
+
+// The last reader to leave a retired version frees it. The check is one
+// relaxed load; a reader that finds the lock taken leaves it to the next.
+void baseline_release(hpc_ids_t *ids, target_state_t *target) {
+    if (target->reader >= 0) {
+        __atomic_store_n(&ids->baseline_readers[target->reader].epoch, 0, __ATOMIC_RELEASE);
+        if (__atomic_load_n(&ids->reclaim_pending, __ATOMIC_RELAXED) &&
+            pthread_mutex_trylock(&ids->baseline_lock) == 0) {
+            baseline_reclaim(ids);
+            pthread_mutex_unlock(&ids->baseline_lock);
+        }
+    } else {
+        if (__atomic_load_n(&ids->reclaim_pending, __ATOMIC_RELAXED)) baseline_reclaim(ids);
+        pthread_mutex_unlock(&ids->baseline_lock);
+    }
+}
+
+// Swap in a new heap-allocated version. The old one is retired, not freed:
+// readers that entered before the swap may still be scoring against it.
+// Called with baseline_lock held.
+void baseline_publish(hpc_ids_t *ids, app_baseline_t *entry, baseline_t *next) {
+    baseline_t *old = __atomic_exchange_n(&entry->current, next, __ATOMIC_SEQ_CST);
+    bool owned = entry->owns_current;
+    entry->owns_current = true;
+    if (!old || !owned) return;
+
+    retired_baseline_t *node = malloc(sizeof(retired_baseline_t));
+    if (!node) {
+        // Leaking one version is better than freeing it under a reader
+        fprintf(stderr, "Warning: cannot retire replaced baseline\n");
+        return;
+    }
+    node->baseline = old;
+    node->epoch = __atomic_fetch_add(&ids->baseline_epoch, 1, __ATOMIC_SEQ_CST);
+    node->next = ids->retired;
+    ids->retired = node;
+    __atomic_store_n(&ids->reclaim_pending, true, __ATOMIC_RELAXED);
+}
+
+// Free retired versions older than every active reader. Called with
+// baseline_lock held.
+void baseline_reclaim(hpc_ids_t *ids) {
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < MAX_BASELINE_READERS; i++) {
+        uint64_t epoch = __atomic_load_n(&ids->baseline_readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+
+    retired_baseline_t **link = &ids->retired;
+    while (*link) {
+        retired_baseline_t *node = *link;
+        if (node->epoch < oldest) {
+            *link = node->next;
+            free(node->baseline);
+            free(node);
+        } else {
+            link = &node->next;
+        }
+    }
+    __atomic_store_n(&ids->reclaim_pending, ids->retired != NULL, __ATOMIC_RELAXED);
+}
+
+static void reload_file(hpc_ids_t *ids, const char *filename) {
+    char app_name[128];
+    bool global = strcmp(filename, GLOBAL_BASELINE_FILE) == 0;
+    if (!global) {
+        size_t len = strlen(filename);
+        if (strncmp(filename, "baseline_", 9) != 0 || len <= 14 || len - 14 >= sizeof(app_name) ||
+            strcmp(filename + len - 5, ".json") != 0) {
+            return;
+        }
+        memcpy(app_name, filename + 9, len - 14);
+        app_name[len - 14] = '\0';
+    }
+
+    char path[MAX_PATH_LEN + NAME_MAX + 1];
+    if (snprintf(path, sizeof(path), "%s/%s", ids->config.baseline_directory, filename) >= (int)sizeof(path)) {
+        return;
+    }
+
+    // Parse outside the lock; a file that fails to parse keeps the old version
+    baseline_t *baseline = malloc(sizeof(baseline_t));
+    if (!baseline || load_baseline(baseline, path) != 0) {
+        fprintf(stderr, "Warning: failed to reload %s, keeping previous baseline\n", path);
+        ids->watcher.failures++;
+        free(baseline);
+        return;
+    }
+
+    pthread_mutex_lock(&ids->baseline_lock);
+    // Apps not in the cache pick the new file up on their next attach
+    app_baseline_t *entry = global ? &ids->global_entry : baseline_table_find(&ids->app_baselines, app_name);
+    if (entry) {
+        baseline_publish(ids, entry, baseline);
+        baseline_reclaim(ids);
+        ids->watcher.reloads++;
+        if (!ids->config.quiet) printf("Reloaded baseline for %s\n", global ? "global" : app_name);
+    } else {
+        free(baseline);
+    }
+    pthread_mutex_unlock(&ids->baseline_lock);
+}
+
+// Sleeps in poll until inotify reports a file or stop_fd is written
+static void* watcher_thread(void *arg) {
+    hpc_ids_t *ids = arg;
+    baseline_watcher_t *watcher = &ids->watcher;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    struct pollfd pfd[2] = { { watcher->fd, POLLIN, 0 }, { watcher->stop_fd, POLLIN, 0 } };
+
+    for (;;) {
+        if (poll(pfd, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("poll");
+            break;
+        }
+        if (pfd[1].revents) break;
+        if (!(pfd[0].revents & POLLIN)) continue;
+
+        ssize_t len = read(watcher->fd, buffer, sizeof(buffer));
+        for (ssize_t off = 0; off < len; ) {
+            const struct inotify_event *event = (const struct inotify_event *)(buffer + off);
+            if (event->len > 0) {
+                reload_file(ids, event->name);
+            }
+            off += sizeof(struct inotify_event) + event->len;
+        }
+    }
+    return NULL;
+}
+
+// Watch baseline_directory for rewritten (close after write) or renamed-in
+// baseline files. Deleting a file keeps the version already loaded.
+int baseline_watcher_start(hpc_ids_t *ids) {
+    baseline_watcher_t *watcher = &ids->watcher;
+    memset(watcher, 0, sizeof(baseline_watcher_t));
+
+    watcher->fd = inotify_init1(IN_CLOEXEC | IN_NONBLOCK);
+    if (watcher->fd < 0) {
+        perror("inotify_init1");
+        return -1;
+    }
+    if (inotify_add_watch(watcher->fd, ids->config.baseline_directory, IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        fprintf(stderr, "Cannot watch baseline directory: %s\n", ids->config.baseline_directory);
+        close(watcher->fd);
+        return -1;
+    }
+    watcher->stop_fd = eventfd(0, EFD_CLOEXEC);
+    if (watcher->stop_fd < 0) {
+        perror("eventfd");
+        close(watcher->fd);
+        return -1;
+    }
+    if (pthread_create(&watcher->thread, NULL, watcher_thread, ids) != 0) {
+        close(watcher->stop_fd);
+        close(watcher->fd);
+        return -1;
+    }
+
+    watcher->running = true;
+    if (!ids->config.quiet) printf("Watching %s for baseline updates\n", ids->config.baseline_directory);
+    return 0;
+}
+
+void baseline_watcher_stop(hpc_ids_t *ids) {
+    baseline_watcher_t *watcher = &ids->watcher;
+    if (!watcher->running) return;
+
+    uint64_t one = 1;
+    if (write(watcher->stop_fd, &one, sizeof(one)) != sizeof(one)) {
+        perror("eventfd write");
+    }
+    pthread_join(watcher->thread, NULL);
+    close(watcher->stop_fd);
+    close(watcher->fd);
+    watcher->running = false;
+
+    if ((watcher->reloads || watcher->failures) && !ids->config.quiet) {
+        printf("Baseline watcher: %lu reloads, %lu failures\n",
+               (unsigned long)watcher->reloads, (unsigned long)watcher->failures);
+    }
+}
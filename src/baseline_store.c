@@ -0,0 +1,175 @@
+#include "hpc_ids.h"
+#include <sys/mman.h>
+
+static int compare_entries(const void *a, const void *b) {
+    const app_baseline_t *ea = *(app_baseline_t * const *)a;
+    const app_baseline_t *eb = *(app_baseline_t * const *)b;
+    return strcmp(ea->name, eb->name);
+}
+
+int baseline_store_open(baseline_store_t *store, const char *path) {
+    memset(store, 0, sizeof(baseline_store_t));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(baseline_store_header_t)) {
+        close(fd);
+        return -1;
+    }
+
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const baseline_store_header_t *header = map;
+    size_t expected = sizeof(baseline_store_header_t) +
+                      (size_t)header->index_capacity * sizeof(uint32_t) +
+                      (size_t)header->num_records * sizeof(baseline_record_t);
+
+    if (memcmp(header->magic, BASELINE_STORE_MAGIC, strlen(BASELINE_STORE_MAGIC)) != 0 ||
+        header->version != BASELINE_STORE_VERSION ||
+        header->byte_order != BASELINE_STORE_BYTE_ORDER ||
+        header->record_size != sizeof(baseline_record_t) ||
+        header->baseline_size != sizeof(baseline_t) ||
+        header->num_features != NUM_FEATURES ||
+        (header->index_capacity & (header->index_capacity - 1)) != 0 ||
+        expected != (size_t)st.st_size) {
+        fprintf(stderr, "Warning: incompatible baseline store %s, recompile with baseline_compile\n", path);
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    store->map = map;
+    store->size = st.st_size;
+    store->header = header;
+    store->index = (const uint32_t *)(header + 1);
+    store->records = (const baseline_record_t *)(store->index + header->index_capacity);
+    return 0;
+}
+
+void baseline_store_close(baseline_store_t *store) {
+    if (store->map) {
+        munmap(store->map, store->size);
+    }
+    memset(store, 0, sizeof(baseline_store_t));
+}
+
+const baseline_record_t* baseline_store_find(const baseline_store_t *store, const char *name) {
+    if (!store->map || store->header->index_capacity == 0) return NULL;
+
+    uint64_t hash = hash_app_name(name);
+    uint32_t mask = store->header->index_capacity - 1;
+    uint32_t idx = hash & mask;
+
+    while (store->index[idx]) {
+        const baseline_record_t *record = &store->records[store->index[idx] - 1];
+        if (record->name_hash == hash && strcmp(record->name, name) == 0) {
+            return record;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return NULL;
+}
+
+// Pack the global baseline and every loaded app baseline into one file.
+// Written to a temp file and renamed so running readers keep their mapping.
+int baseline_store_write(const char *path, const baseline_t *global_baseline, bool has_global,
+                         const baseline_table_t *table) {
+    // A truncated temporary name could equal path, which readers have mapped
+    char tmp_path[BASELINE_STORE_PATH_LEN + 8];
+    if (snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path) >= (int)sizeof(tmp_path)) {
+        fprintf(stderr, "Baseline store path too long: %s\n", path);
+        return -1;
+    }
+
+    size_t num_apps = 0;
+    app_baseline_t **entries = malloc((table->count + 1) * sizeof(app_baseline_t *));
+    if (!entries) return -1;
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i] && table->slots[i]->current) {
+            entries[num_apps++] = table->slots[i];
+        }
+    }
+    // Sorted by name so identical inputs give byte-identical stores
+    qsort(entries, num_apps, sizeof(app_baseline_t *), compare_entries);
+
+    uint32_t num_records = num_apps + (has_global ? 1 : 0);
+    uint32_t index_capacity = 16;
+    while (index_capacity < num_records * 2) index_capacity <<= 1;
+
+    baseline_record_t *records = calloc(num_records ? num_records : 1, sizeof(baseline_record_t));
+    uint32_t *index = calloc(index_capacity, sizeof(uint32_t));
+    if (!records || !index) {
+        free(entries);
+        free(records);
+        free(index);
+        return -1;
+    }
+
+    uint32_t n = 0;
+    if (has_global) {
+        strcpy(records[n].name, BASELINE_STORE_GLOBAL);
+        records[n].baseline = *global_baseline;
+        n++;
+    }
+    for (size_t i = 0; i < num_apps; i++, n++) {
+        memcpy(records[n].name, entries[i]->name, sizeof(records[n].name));
+        records[n].name[sizeof(records[n].name) - 1] = '\0';
+        records[n].baseline = *entries[i]->current;
+    }
+
+    size_t max_probe = 0;
+    for (uint32_t r = 0; r < num_records; r++) {
+        prepare_baseline_scoring(&records[r].baseline);
+        records[r].name_hash = hash_app_name(records[r].name);
+        uint32_t idx = records[r].name_hash & (index_capacity - 1);
+        size_t probe = 0;
+        while (index[idx]) {
+            idx = (idx + 1) & (index_capacity - 1);
+            probe++;
+        }
+        index[idx] = r + 1;
+        if (probe > max_probe) max_probe = probe;
+    }
+
+    baseline_store_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BASELINE_STORE_MAGIC, strlen(BASELINE_STORE_MAGIC));
+    header.version = BASELINE_STORE_VERSION;
+    header.byte_order = BASELINE_STORE_BYTE_ORDER;
+    header.record_size = sizeof(baseline_record_t);
+    header.baseline_size = sizeof(baseline_t);
+    header.num_records = num_records;
+    header.index_capacity = index_capacity;
+    header.created = (uint64_t)time(NULL);
+    header.num_features = NUM_FEATURES;
+
+    int result = -1;
+    FILE *file = fopen(tmp_path, "wb");
+    if (file) {
+        if (fwrite(&header, sizeof(header), 1, file) == 1 &&
+            fwrite(index, sizeof(uint32_t), index_capacity, file) == index_capacity &&
+            fwrite(records, sizeof(baseline_record_t), num_records, file) == num_records &&
+            fflush(file) == 0 && fsync(fileno(file)) == 0) {
+            result = 0;
+        }
+        if (fclose(file) != 0) result = -1;
+        // Durable before the rename, so a crash leaves the old store or the new one
+        if (result == 0 && rename(tmp_path, path) != 0) result = -1;
+        if (result != 0) unlink(tmp_path);
+    }
+
+    if (result == 0) {
+        printf("Wrote %u baselines (%u index slots, max probe %zu) to %s\n",
+               num_records, index_capacity, max_probe, path);
+    } else {
+        fprintf(stderr, "Failed to write baseline store: %s\n", path);
+    }
+
+    free(entries);
+    free(records);
+    free(index);
+    return result;
+}
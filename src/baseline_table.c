@@ -0,0 +1,313 @@
+#include "hpc_ids.h"
+
+#define BASELINE_TABLE_MIN_CAPACITY 64
+
+// FNV-1a, computed once per name at insert/attach time
+uint64_t hash_app_name(const char *name) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char *p = (const unsigned char *)name; *p; p++) {
+        hash ^= *p;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static size_t round_up_pow2(size_t n) {
+    size_t capacity = BASELINE_TABLE_MIN_CAPACITY;
+    while (capacity < n) capacity <<= 1;
+    return capacity;
+}
+
+int baseline_table_init(baseline_table_t *table, size_t initial_capacity) {
+    memset(table, 0, sizeof(baseline_table_t));
+    table->capacity = round_up_pow2(initial_capacity);
+    table->slots = calloc(table->capacity, sizeof(app_baseline_t *));
+    if (!table->slots) {
+        table->capacity = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void baseline_table_free(baseline_table_t *table) {
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i] && table->slots[i]->owns_current) free(table->slots[i]->current);
+        free(table->slots[i]);
+    }
+    free(table->slots);
+    memset(table, 0, sizeof(baseline_table_t));
+}
+
+// Place an entry into a slot array without duplicate checks (used on rehash)
+static size_t place_entry(app_baseline_t **slots, size_t capacity, app_baseline_t *entry) {
+    size_t mask = capacity - 1;
+    size_t idx = entry->name_hash & mask;
+    size_t probe = 0;
+    while (slots[idx]) {
+        idx = (idx + 1) & mask;
+        probe++;
+    }
+    slots[idx] = entry;
+    return probe;
+}
+
+static int baseline_table_grow(baseline_table_t *table) {
+    size_t new_capacity = table->capacity ? table->capacity * 2 : BASELINE_TABLE_MIN_CAPACITY;
+    app_baseline_t **new_slots = calloc(new_capacity, sizeof(app_baseline_t *));
+    if (!new_slots) return -1;
+
+    table->collisions = 0;
+    table->max_probe = 0;
+    for (size_t i = 0; i < table->capacity; i++) {
+        if (table->slots[i]) {
+            size_t probe = place_entry(new_slots, new_capacity, table->slots[i]);
+            if (probe > 0) table->collisions++;
+            if (probe > table->max_probe) table->max_probe = probe;
+        }
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+    return 0;
+}
+
+static app_baseline_t* find_with_hash(const baseline_table_t *table, const char *name, uint64_t hash) {
+    if (table->capacity == 0) return NULL;
+
+    size_t mask = table->capacity - 1;
+    size_t idx = hash & mask;
+    while (table->slots[idx]) {
+        app_baseline_t *entry = table->slots[idx];
+        if (entry->name_hash == hash && strcmp(entry->name, name) == 0) {
+            return entry;
+        }
+        idx = (idx + 1) & mask;
+    }
+    return NULL;
+}
+
+app_baseline_t* baseline_table_find(const baseline_table_t *table, const char *name) {
+    return find_with_hash(table, name, hash_app_name(name));
+}
+
+static void lru_unlink(baseline_table_t *table, app_baseline_t *entry) {
+    if (entry->lru_prev) entry->lru_prev->lru_next = entry->lru_next;
+    else table->lru_head = entry->lru_next;
+    if (entry->lru_next) entry->lru_next->lru_prev = entry->lru_prev;
+    else table->lru_tail = entry->lru_prev;
+    entry->lru_prev = entry->lru_next = NULL;
+}
+
+static void lru_push_front(baseline_table_t *table, app_baseline_t *entry) {
+    entry->lru_prev = NULL;
+    entry->lru_next = table->lru_head;
+    if (table->lru_head) table->lru_head->lru_prev = entry;
+    else table->lru_tail = entry;
+    table->lru_head = entry;
+}
+
+// Drop an entry, shifting later members of its probe run back so lookups
+// never stop early at the hole (no tombstones)
+void baseline_table_remove(baseline_table_t *table, app_baseline_t *entry) {
+    size_t mask = table->capacity - 1;
+    size_t hole = entry->name_hash & mask;
+    while (table->slots[hole] != entry) {
+        if (!table->slots[hole]) return;
+        hole = (hole + 1) & mask;
+    }
+
+    table->slots[hole] = NULL;
+    for (size_t idx = (hole + 1) & mask; table->slots[idx]; idx = (idx + 1) & mask) {
+        size_t home = table->slots[idx]->name_hash & mask;
+        // Move the entry unless its home lies cyclically in (hole, idx]
+        bool stays = hole <= idx ? (home > hole && home <= idx) : (home > hole || home <= idx);
+        if (!stays) {
+            table->slots[hole] = table->slots[idx];
+            table->slots[idx] = NULL;
+            hole = idx;
+        }
+    }
+
+    lru_unlink(table, entry);
+    table->count--;
+    // Unpinned means no target can reach this version any more
+    if (entry->owns_current) free(entry->current);
+    free(entry);
+}
+
+// Evict least recently used, unpinned entries until one more fits
+static void baseline_table_trim(baseline_table_t *table) {
+    if (table->max_entries == 0) return;
+
+    app_baseline_t *entry = table->lru_tail;
+    while (entry && table->count >= table->max_entries) {
+        app_baseline_t *prev = entry->lru_prev;
+        if (entry->pins == 0) {
+            baseline_table_remove(table, entry);
+            table->evictions++;
+        }
+        entry = prev;
+    }
+}
+
+// Returns the entry for name, creating it if needed. Entries are heap allocated
+// so pointers handed out stay valid across rehashes.
+app_baseline_t* baseline_table_insert(baseline_table_t *table, const char *name) {
+    uint64_t hash = hash_app_name(name);
+
+    app_baseline_t *existing = find_with_hash(table, name, hash);
+    if (existing) {
+        table->duplicates++;
+        fprintf(stderr, "Warning: duplicate baseline for app: %s\n", name);
+        return existing;
+    }
+
+    baseline_table_trim(table);
+
+    // Keep the load factor at or below 1/2
+    if ((table->count + 1) * 2 > table->capacity) {
+        if (baseline_table_grow(table) != 0) return NULL;
+    }
+
+    app_baseline_t *entry = calloc(1, sizeof(app_baseline_t));
+    if (!entry) return NULL;
+
+    strncpy(entry->name, name, sizeof(entry->name) - 1);
+    entry->name_hash = hash;
+
+    size_t probe = place_entry(table->slots, table->capacity, entry);
+    if (probe > 0) table->collisions++;
+    if (probe > table->max_probe) table->max_probe = probe;
+    table->count++;
+    lru_push_front(table, entry);
+
+    return entry;
+}
+
+void baseline_table_report(const baseline_table_t *table) {
+    printf("Baseline table: %zu apps in %zu slots, %zu duplicates, %zu collisions (max probe %zu)\n",
+           table->count, table->capacity, table->duplicates, table->collisions, table->max_probe);
+    if (table->hits || table->misses) {
+        printf("Baseline cache: %lu hits (%lu negative), %lu misses, %lu evictions\n",
+               (unsigned long)table->hits, (unsigned long)table->negative_hits,
+               (unsigned long)table->misses, (unsigned long)table->evictions);
+    }
+}
+
+// Resolve an app baseline through the cache. On a miss the compiled store
+// is consulted first (the entry then points into the mapping), otherwise
+// baseline_<app>.json is read. Apps without a usable baseline are cached as
+// negative entries so repeated attaches do not hit the filesystem again.
+// Called with baseline_lock held.
+app_baseline_t* baseline_cache_lookup(hpc_ids_t *ids, const char *app_name) {
+    baseline_table_t *table = &ids->app_baselines;
+
+    app_baseline_t *entry = baseline_table_find(table, app_name);
+    if (entry) {
+        table->hits++;
+        if (!entry->current) table->negative_hits++;
+        lru_unlink(table, entry);
+        lru_push_front(table, entry);
+        return entry;
+    }
+
+    table->misses++;
+    entry = baseline_table_insert(table, app_name);
+    if (!entry) return NULL;
+
+    const baseline_record_t *record = baseline_store_find(&ids->baseline_store, app_name);
+    if (record) {
+        // Read only: versions that are not owned are never written or freed
+        entry->current = (baseline_t *)&record->baseline;
+        return entry;
+    }
+
+    // Directory, app name (up to 127 chars) and the file name around it
+    char baseline_path[MAX_PATH_LEN + 160];
+    if (snprintf(baseline_path, sizeof(baseline_path), "%s/baseline_%s.json",
+                 ids->config.baseline_directory, app_name) >= (int)sizeof(baseline_path)) {
+        fprintf(stderr, "Warning: baseline path too long for app: %s\n", app_name);
+        return entry;
+    }
+
+    baseline_t *baseline = malloc(sizeof(baseline_t));
+    if (baseline && load_baseline(baseline, baseline_path) == 0) {
+        entry->current = baseline;
+        entry->owns_current = true;
+        if (!ids->config.quiet) printf("Loaded baseline for app: %s\n", app_name);
+    } else {
+        free(baseline);
+    }
+    return entry;
+}
+
+static int claim_reader(hpc_ids_t *ids) {
+    for (int i = 0; i < MAX_BASELINE_READERS; i++) {
+        if (!ids->baseline_readers[i].used) {
+            ids->baseline_readers[i].used = true;
+            __atomic_store_n(&ids->baseline_readers[i].epoch, 0, __ATOMIC_RELEASE);
+            return i;
+        }
+    }
+    return -1;
+}
+
+int attach_target(hpc_ids_t *ids, target_state_t *target, const char *app_name, pid_t pid) {
+    memset(target, 0, sizeof(target_state_t));
+    target->pid = pid;
+    target->entry = &ids->global_entry;
+
+    pthread_mutex_lock(&ids->baseline_lock);
+    target->reader = claim_reader(ids);
+
+    if (!app_name) {
+        strcpy(target->name, "system");
+        strcpy(target->label, "system");
+        pthread_mutex_unlock(&ids->baseline_lock);
+        return 0;
+    }
+
+    strncpy(target->name, app_name, sizeof(target->name) - 1);
+    memcpy(target->placement, ids->config.monitor_cpus, CPU_LIST_LEN);
+    target->placement[CPU_LIST_LEN - 1] = '\0';
+    if (pid > 0) {
+        snprintf(target->label, sizeof(target->label), "pid:%d", (int)pid);
+    } else {
+        strncpy(target->label, app_name, sizeof(target->label) - 1);
+    }
+
+    // Negative entries are pinned too, so a baseline published for the app
+    // later is picked up by targets that are already running
+    app_baseline_t *entry = baseline_cache_lookup(ids, app_name);
+    char collected_on[sizeof(target->placement)] = "";
+    if (entry) {
+        entry->pins++;
+        target->entry = entry;
+        target->per_app = entry->current != NULL;
+        if (entry->current) strcpy(collected_on, entry->current->placement);
+    }
+    pthread_mutex_unlock(&ids->baseline_lock);
+
+    if (!target->per_app) {
+        fprintf(stderr, "No per-app baseline for %s, using global baseline\n", app_name);
+    } else if (collected_on[0] && strcmp(collected_on, target->placement) != 0) {
+        // Cache and SMT contention differ between placements, and so do the counters
+        fprintf(stderr, "Warning: baseline for %s was collected on CPUs %s, monitoring on %s\n",
+                app_name, collected_on, target->placement[0] ? target->placement : "unpinned CPUs");
+    }
+    return 0;
+}
+
+void detach_target(hpc_ids_t *ids, target_state_t *target) {
+    pthread_mutex_lock(&ids->baseline_lock);
+    if (target->entry && target->entry != &ids->global_entry) {
+        target->entry->pins--;
+    }
+    if (target->reader >= 0) {
+        ids->baseline_readers[target->reader].used = false;
+    }
+    pthread_mutex_unlock(&ids->baseline_lock);
+    target->entry = NULL;
+    target->reader = -1;
+}
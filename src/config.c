@@ -1,14 +1,19 @@
 #include "hpc_ids.h"
+#include <stdarg.h>
 
-// Forward declarations for simple JSON parser
-char* extract_json_string(const char *json, const char *key);
-double extract_json_double(const char *json, const char *key);
-int extract_json_int(const char *json, const char *key);
-bool extract_json_bool(const char *json, const char *key);
-int extract_json_string_array(const char *json, const char *key, char results[][64], int max_items);
+// Settings are echoed as they are read, unless loading for an embedding host
+static void echo(const config_t *config, const char *format, ...) __attribute__((format(printf, 2, 3)));
+static void echo(const config_t *config, const char *format, ...) {
+    if (config->quiet) return;
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+}
 
-int load_config(config_t *config, const char *config_file) {
+static int read_config(config_t *config, const char *config_file, bool quiet) {
     // Set defaults first
+    config->quiet = quiet;
     strcpy(config->app_directory, "./test_apps");
     strcpy(config->baseline_directory, "./baselines");
     strcpy(config->alert_output_file, "hpc_ids_alerts.jsonl");
@@ -16,12 +21,40 @@ int load_config(config_t *config, const char *config_file) {
     config->runs_per_app = 10;
     config->min_samples_per_app = 50;
     config->max_runtime_seconds = 60;
-    config->core_affinity = 0;
+    config->warmup_seconds = 0.0;
+    config->max_phases = MAX_PHASES;
+    config->convergence_tolerance = 0.0;
+    config->min_runs_per_app = 2;
+    config->max_runs_per_app = 0;
+    config->collection_memory_mb = 64;
+    config->core_affinity = -1;  // placement is opt-in
     config->robust_z_threshold_medium = 3.0;
     config->robust_z_threshold_high = 4.0;
     config->robust_z_threshold_critical = 5.0;
     config->alert_cooldown_seconds = 30;
+    config->alert_format = ALERT_FORMAT_JSONL;
+    config->alert_store_directory[0] = '\0';
+    config->alert_segment_max_mb = 64;
+    config->alert_segment_max_seconds = 3600;
+    config->alert_retention_days = 0;
+    config->alert_queue_capacity = ALERT_QUEUE_CAPACITY;
+    config->baseline_store_file[0] = '\0';
+    config->trace_directory[0] = '\0';
+    config->baseline_cache_size = 256;
+    config->baseline_hot_reload = false;  // opt-in: adds a watcher thread
+    config->alert_fsync_policy = FSYNC_NONE;
+    config->alert_fsync_interval_ms = 1000;
+    config->alert_echo_stderr = !quiet;  // a library's host owns its stderr
+    config->collection_parallelism = 1;
+    config->collection_isolation = ISOLATION_SMT;
     config->use_robust_statistics = true;
+    config->energy_source = ENERGY_SOURCE_OFF;  // baselines need energy statistics first
+    config->energy_idle_watts = 2.0;
+    config->energy_max_watts = 15.0;
+    config->telemetry_shm[0] = '\0';  // opt-in: the segment name is shared host-wide
+    config->pipeline_threads = true;
+    config->pipeline_queue_capacity = PIPELINE_QUEUE_CAPACITY;
+    for (int s = 0; s < PIPELINE_STAGES; s++) config->pipeline_cpus[s] = -1;
     
     // Default events
     const char *default_events[] = {
@@ -64,94 +97,308 @@ int load_config(config_t *config, const char *config_file) {
     json_data[read_bytes] = '\0';
     fclose(file);
     
-    printf("Loading configuration from %s...\n", config_file);
+    echo(config, "Loading configuration from %s...\n", config_file);
+    
+    json_doc_t doc;
+    if (json_parse(&doc, json_data, read_bytes) != 0) {
+        fprintf(stderr, "Error: Malformed JSON in config file: %s\n", config_file);
+        free(json_data);
+        return -1;
+    }
     
-    // Parse JSON values using simple parser
-    char *str_val;
+    char str_val[MAX_PATH_LEN];
     double double_val;
     int int_val;
+    bool bool_val;
     
-    if ((str_val = extract_json_string(json_data, "app_directory")) != NULL) {
+    if (json_get_string(&doc, 0, "app_directory", str_val, sizeof(str_val)) == 0) {
         strcpy(config->app_directory, str_val);
-        printf("  app_directory: %s\n", config->app_directory);
+        echo(config, "  app_directory: %s\n", config->app_directory);
     }
     
-    if ((str_val = extract_json_string(json_data, "baseline_directory")) != NULL) {
+    if (json_get_string(&doc, 0, "baseline_directory", str_val, sizeof(str_val)) == 0) {
         strcpy(config->baseline_directory, str_val);
-        printf("  baseline_directory: %s\n", config->baseline_directory);
+        echo(config, "  baseline_directory: %s\n", config->baseline_directory);
     }
     
-    if ((str_val = extract_json_string(json_data, "alert_output_file")) != NULL) {
+    if (json_get_string(&doc, 0, "alert_output_file", str_val, sizeof(str_val)) == 0) {
         strcpy(config->alert_output_file, str_val);
-        printf("  alert_output_file: %s\n", config->alert_output_file);
+        echo(config, "  alert_output_file: %s\n", config->alert_output_file);
+    }
+    
+    if (json_get_string(&doc, 0, "baseline_store_file", str_val, sizeof(str_val)) == 0) {
+        strcpy(config->baseline_store_file, str_val);
+        echo(config, "  baseline_store_file: %s\n", config->baseline_store_file);
+    }
+    
+    if (json_get_string(&doc, 0, "trace_directory", str_val, sizeof(str_val)) == 0) {
+        strcpy(config->trace_directory, str_val);
+        echo(config, "  trace_directory: %s\n", config->trace_directory);
+    }
+    
+    if (json_get_string(&doc, 0, "telemetry_shm", str_val, sizeof(str_val)) == 0) {
+        strncpy(config->telemetry_shm, str_val, sizeof(config->telemetry_shm) - 1);
+        config->telemetry_shm[sizeof(config->telemetry_shm) - 1] = '\0';
+        echo(config, "  telemetry_shm: %s\n", config->telemetry_shm[0] ? config->telemetry_shm : "(off)");
     }
     
-    if ((int_val = extract_json_int(json_data, "sampling_interval_ms")) > 0) {
+    if (json_get_int(&doc, 0, "baseline_cache_size", &int_val) == 0 && int_val >= 0) {
+        config->baseline_cache_size = int_val;
+        echo(config, "  baseline_cache_size: %d%s\n", config->baseline_cache_size,
+                     config->baseline_cache_size == 0 ? " (unbounded)" : "");
+    }
+    
+    if (json_get_int(&doc, 0, "collection_parallelism", &int_val) == 0 && int_val >= 0) {
+        config->collection_parallelism = int_val;
+        echo(config, "  collection_parallelism: %d\n", config->collection_parallelism);
+    }
+    
+    if (json_get_string(&doc, 0, "collection_isolation", str_val, sizeof(str_val)) == 0) {
+        if (parse_isolation_policy(str_val, &config->collection_isolation) != 0) {
+            fprintf(stderr, "Warning: unknown collection_isolation '%s', using smt\n", str_val);
+        }
+        echo(config, "  collection_isolation: %s\n", isolation_policy_name(config->collection_isolation));
+    }
+    
+    if (json_get_bool(&doc, 0, "baseline_hot_reload", &bool_val) == 0) {
+        config->baseline_hot_reload = bool_val;
+        echo(config, "  baseline_hot_reload: %s\n", config->baseline_hot_reload ? "true" : "false");
+    }
+    
+    if (json_get_int(&doc, 0, "sampling_interval_ms", &int_val) == 0 && int_val > 0) {
         config->sampling_interval_ms = int_val;
-        printf("  sampling_interval_ms: %d\n", config->sampling_interval_ms);
+        echo(config, "  sampling_interval_ms: %d\n", config->sampling_interval_ms);
     }
     
-    if ((int_val = extract_json_int(json_data, "runs_per_app")) > 0) {
+    if (json_get_int(&doc, 0, "runs_per_app", &int_val) == 0 && int_val > 0) {
         config->runs_per_app = int_val;
-        printf("  runs_per_app: %d\n", config->runs_per_app);
+        echo(config, "  runs_per_app: %d\n", config->runs_per_app);
     }
     
-    if ((int_val = extract_json_int(json_data, "min_samples_per_app")) > 0) {
+    if (json_get_int(&doc, 0, "min_samples_per_app", &int_val) == 0 && int_val > 0) {
         config->min_samples_per_app = int_val;
-        printf("  min_samples_per_app: %d\n", config->min_samples_per_app);
+        echo(config, "  min_samples_per_app: %d\n", config->min_samples_per_app);
     }
     
-    if ((int_val = extract_json_int(json_data, "max_runtime_seconds")) > 0) {
+    if (json_get_int(&doc, 0, "max_runtime_seconds", &int_val) == 0 && int_val > 0) {
         config->max_runtime_seconds = int_val;
-        printf("  max_runtime_seconds: %d\n", config->max_runtime_seconds);
+        echo(config, "  max_runtime_seconds: %d\n", config->max_runtime_seconds);
+    }
+    
+    if (json_get_double(&doc, 0, "warmup_seconds", &double_val) == 0 && double_val >= 0) {
+        config->warmup_seconds = double_val;
+        echo(config, "  warmup_seconds: %.1f\n", config->warmup_seconds);
     }
     
-    if ((int_val = extract_json_int(json_data, "core_affinity")) >= 0) {
+    if (json_get_int(&doc, 0, "max_phases", &int_val) == 0 && int_val > 0 && int_val <= MAX_PHASES) {
+        config->max_phases = int_val;
+        echo(config, "  max_phases: %d\n", config->max_phases);
+    }
+    
+    if (json_get_double(&doc, 0, "convergence_tolerance", &double_val) == 0 && double_val >= 0) {
+        config->convergence_tolerance = double_val;
+        echo(config, "  convergence_tolerance: %.3f\n", config->convergence_tolerance);
+    }
+    
+    if (json_get_int(&doc, 0, "min_runs_per_app", &int_val) == 0 && int_val > 0) {
+        config->min_runs_per_app = int_val;
+        echo(config, "  min_runs_per_app: %d\n", config->min_runs_per_app);
+    }
+    
+    if (json_get_int(&doc, 0, "max_runs_per_app", &int_val) == 0 && int_val >= 0) {
+        config->max_runs_per_app = int_val;
+        echo(config, "  max_runs_per_app: %d\n", config->max_runs_per_app);
+    }
+    
+    if (json_get_int(&doc, 0, "collection_memory_mb", &int_val) == 0 && int_val > 0) {
+        config->collection_memory_mb = int_val;
+        echo(config, "  collection_memory_mb: %d\n", config->collection_memory_mb);
+    }
+    
+    if (json_get_int(&doc, 0, "core_affinity", &int_val) == 0 && int_val >= -1) {
         config->core_affinity = int_val;
-        printf("  core_affinity: %d\n", config->core_affinity);
+        echo(config, "  core_affinity: %d\n", config->core_affinity);
     }
     
-    if ((double_val = extract_json_double(json_data, "robust_z_threshold_medium")) > 0) {
+    if (json_get_string(&doc, 0, "monitor_cpus", str_val, sizeof(str_val)) == 0) {
+        if (strlen(str_val) < sizeof(config->monitor_cpus)) {
+            strcpy(config->monitor_cpus, str_val);
+            echo(config, "  monitor_cpus: %s\n", config->monitor_cpus);
+        } else {
+            fprintf(stderr, "Warning: monitor_cpus longer than %d characters, ignored\n", CPU_LIST_LEN - 1);
+        }
+    }
+    
+    if (json_get_string(&doc, 0, "housekeeping_cpus", str_val, sizeof(str_val)) == 0) {
+        if (strlen(str_val) < sizeof(config->housekeeping_cpus)) {
+            strcpy(config->housekeeping_cpus, str_val);
+            echo(config, "  housekeeping_cpus: %s\n", config->housekeeping_cpus);
+        } else {
+            fprintf(stderr, "Warning: housekeeping_cpus longer than %d characters, ignored\n", CPU_LIST_LEN - 1);
+        }
+    }
+    
+    if (json_get_double(&doc, 0, "robust_z_threshold_medium", &double_val) == 0 && double_val > 0) {
         config->robust_z_threshold_medium = double_val;
-        printf("  robust_z_threshold_medium: %.1f\n", config->robust_z_threshold_medium);
+        echo(config, "  robust_z_threshold_medium: %.1f\n", config->robust_z_threshold_medium);
     }
     
-    if ((double_val = extract_json_double(json_data, "robust_z_threshold_high")) > 0) {
+    if (json_get_double(&doc, 0, "robust_z_threshold_high", &double_val) == 0 && double_val > 0) {
         config->robust_z_threshold_high = double_val;
-        printf("  robust_z_threshold_high: %.1f\n", config->robust_z_threshold_high);
+        echo(config, "  robust_z_threshold_high: %.1f\n", config->robust_z_threshold_high);
     }
     
-    if ((double_val = extract_json_double(json_data, "robust_z_threshold_critical")) > 0) {
+    if (json_get_double(&doc, 0, "robust_z_threshold_critical", &double_val) == 0 && double_val > 0) {
         config->robust_z_threshold_critical = double_val;
-        printf("  robust_z_threshold_critical: %.1f\n", config->robust_z_threshold_critical);
+        echo(config, "  robust_z_threshold_critical: %.1f\n", config->robust_z_threshold_critical);
     }
     
-    if ((int_val = extract_json_int(json_data, "alert_cooldown_seconds")) > 0) {
+    if (json_get_int(&doc, 0, "alert_cooldown_seconds", &int_val) == 0 && int_val > 0) {
         config->alert_cooldown_seconds = int_val;
-        printf("  alert_cooldown_seconds: %d\n", config->alert_cooldown_seconds);
+        echo(config, "  alert_cooldown_seconds: %d\n", config->alert_cooldown_seconds);
+    }
+    
+    if (json_get_string(&doc, 0, "alert_log_format", str_val, sizeof(str_val)) == 0) {
+        if (strcmp(str_val, "binary") == 0) {
+            config->alert_format = ALERT_FORMAT_BINARY;
+        } else if (strcmp(str_val, "jsonl") != 0) {
+            fprintf(stderr, "Warning: unknown alert_log_format '%s', using jsonl\n", str_val);
+        }
+        echo(config, "  alert_log_format: %s\n", config->alert_format == ALERT_FORMAT_BINARY ? "binary" : "jsonl");
+    }
+    
+    if (json_get_string(&doc, 0, "alert_store_directory", str_val, sizeof(str_val)) == 0) {
+        strcpy(config->alert_store_directory, str_val);
+        echo(config, "  alert_store_directory: %s\n", config->alert_store_directory);
     }
     
-    config->use_robust_statistics = extract_json_bool(json_data, "use_robust_statistics");
-    printf("  use_robust_statistics: %s\n", config->use_robust_statistics ? "true" : "false");
+    if (json_get_int(&doc, 0, "alert_segment_max_mb", &int_val) == 0 && int_val > 0) {
+        config->alert_segment_max_mb = int_val;
+        echo(config, "  alert_segment_max_mb: %d\n", config->alert_segment_max_mb);
+    }
+    
+    if (json_get_int(&doc, 0, "alert_segment_max_seconds", &int_val) == 0 && int_val > 0) {
+        config->alert_segment_max_seconds = int_val;
+        echo(config, "  alert_segment_max_seconds: %d\n", config->alert_segment_max_seconds);
+    }
+    
+    if (json_get_int(&doc, 0, "alert_retention_days", &int_val) == 0 && int_val > 0) {
+        config->alert_retention_days = int_val;
+        echo(config, "  alert_retention_days: %d\n", config->alert_retention_days);
+    }
+    
+    if (json_get_int(&doc, 0, "alert_queue_capacity", &int_val) == 0 && int_val > 0) {
+        config->alert_queue_capacity = int_val;
+        echo(config, "  alert_queue_capacity: %d\n", config->alert_queue_capacity);
+    }
+    
+    if (json_get_string(&doc, 0, "alert_fsync_policy", str_val, sizeof(str_val)) == 0) {
+        if (strcmp(str_val, "batch") == 0) {
+            config->alert_fsync_policy = FSYNC_BATCH;
+        } else if (strcmp(str_val, "interval") == 0) {
+            config->alert_fsync_policy = FSYNC_INTERVAL;
+        } else if (strcmp(str_val, "none") == 0) {
+            config->alert_fsync_policy = FSYNC_NONE;
+        } else {
+            fprintf(stderr, "Warning: unknown alert_fsync_policy '%s', using none\n", str_val);
+        }
+        echo(config, "  alert_fsync_policy: %s\n", str_val);
+    }
+    
+    if (json_get_int(&doc, 0, "alert_fsync_interval_ms", &int_val) == 0 && int_val > 0) {
+        config->alert_fsync_interval_ms = int_val;
+        echo(config, "  alert_fsync_interval_ms: %d\n", config->alert_fsync_interval_ms);
+    }
+    
+    if (json_get_bool(&doc, 0, "alert_echo_stderr", &bool_val) == 0) {
+        config->alert_echo_stderr = bool_val;
+        echo(config, "  alert_echo_stderr: %s\n", config->alert_echo_stderr ? "true" : "false");
+    }
+    
+    if (json_get_bool(&doc, 0, "use_robust_statistics", &bool_val) == 0) {
+        config->use_robust_statistics = bool_val;
+    }
+    echo(config, "  use_robust_statistics: %s\n", config->use_robust_statistics ? "true" : "false");
+    
+    if (json_get_string(&doc, 0, "energy_source", str_val, sizeof(str_val)) == 0) {
+        if (strcmp(str_val, "off") == 0) {
+            config->energy_source = ENERGY_SOURCE_OFF;
+        } else if (strcmp(str_val, "model") == 0) {
+            config->energy_source = ENERGY_SOURCE_MODEL;
+        } else if (strcmp(str_val, "rapl") == 0) {
+            config->energy_source = ENERGY_SOURCE_RAPL;
+        } else {
+            fprintf(stderr, "Warning: unknown energy_source '%s', using off\n", str_val);
+            config->energy_source = ENERGY_SOURCE_OFF;
+        }
+        echo(config, "  energy_source: %s\n", config->energy_source == ENERGY_SOURCE_OFF ? "off"
+                     : config->energy_source == ENERGY_SOURCE_MODEL ? "model" : "rapl");
+    }
+    
+    if (json_get_double(&doc, 0, "energy_idle_watts", &double_val) == 0 && double_val >= 0) {
+        config->energy_idle_watts = double_val;
+        echo(config, "  energy_idle_watts: %.1f\n", config->energy_idle_watts);
+    }
+    
+    if (json_get_double(&doc, 0, "energy_max_watts", &double_val) == 0 && double_val >= config->energy_idle_watts) {
+        config->energy_max_watts = double_val;
+        echo(config, "  energy_max_watts: %.1f\n", config->energy_max_watts);
+    }
+
+    if (json_get_bool(&doc, 0, "pipeline_threads", &bool_val) == 0) {
+        config->pipeline_threads = bool_val;
+        echo(config, "  pipeline_threads: %s\n", config->pipeline_threads ? "true" : "false");
+    }
+
+    if (json_get_int(&doc, 0, "pipeline_queue_capacity", &int_val) == 0 && int_val > 0) {
+        config->pipeline_queue_capacity = int_val;
+        echo(config, "  pipeline_queue_capacity: %d\n", config->pipeline_queue_capacity);
+    }
+
+    // One CPU per stage in pipeline order (collection,features,scoring,output);
+    // "-" or -1 leaves a stage where the scheduler puts it
+    if (json_get_string(&doc, 0, "pipeline_cpus", str_val, sizeof(str_val)) == 0 && str_val[0]) {
+        char *cursor = str_val;
+        for (int s = 0; s < PIPELINE_STAGES && *cursor; s++) {
+            char *end;
+            long cpu = strtol(cursor, &end, 10);
+            config->pipeline_cpus[s] = end != cursor && cpu >= 0 && cpu < MAX_CPUS ? (int)cpu : -1;
+            cursor = strchr(cursor, ',');
+            if (!cursor) break;
+            cursor++;
+        }
+        echo(config, "  pipeline_cpus: %s\n", str_val);
+    }
     
     // Parse perf_events array
     char events[MAX_EVENTS][64];
-    int num_events = extract_json_string_array(json_data, "perf_events", events, MAX_EVENTS);
+    int num_events = json_get_string_array(&doc, 0, "perf_events", events, MAX_EVENTS);
     if (num_events > 0) {
         config->num_events = num_events;
-        printf("  perf_events: [");
+        echo(config, "  perf_events: [");
         for (int i = 0; i < config->num_events; i++) {
             strcpy(config->perf_events[i], events[i]);
-            printf("%s%s", events[i], (i < config->num_events - 1) ? ", " : "");
+            echo(config, "%s%s", events[i], (i < config->num_events - 1) ? ", " : "");
         }
-        printf("]\n");
+        echo(config, "]\n");
     }
     
+    json_free(&doc);
     free(json_data);
-    printf("Configuration loaded successfully\n");
+    echo(config, "Configuration loaded successfully\n");
     return 0;
 }
 
+int load_config(config_t *config, const char *config_file) {
+    return read_config(config, config_file, false);
+}
+
+// Same settings with nothing printed; warnings still go to stderr, alerts
+// only if alert_echo_stderr asks for them
+int load_config_quiet(config_t *config, const char *config_file) {
+    return read_config(config, config_file, true);
+}
+
 int load_baseline(baseline_t *baseline, const char *baseline_file) {
     FILE *file = fopen(baseline_file, "r");
     if (!file) {
@@ -175,76 +422,69 @@ int load_baseline(baseline_t *baseline, const char *baseline_file) {
     
     memset(baseline, 0, sizeof(baseline_t));
     
+    json_doc_t doc;
+    if (json_parse(&doc, json_content, bytes_read) != 0) {
+        free(json_content);
+        return -1;
+    }
+    
     // Parse nested JSON structure: baseline_statistics -> feature -> median/mad/etc
-    char *baseline_stats = strstr(json_content, "\"baseline_statistics\":");
-    if (!baseline_stats) {
+    int statistics = json_find(&doc, 0, "baseline_statistics");
+    if (statistics < 0) {
+        json_free(&doc);
         free(json_content);
         return -1;
     }
     
-    // Extract each feature manually since the JSON is nested
-    // Look for each feature section and extract values
-    
-    // IPC baseline
-    char *ipc_section = strstr(baseline_stats, "\"ipc\":");
-    if (ipc_section) {
-        baseline->ipc.median = extract_json_double(ipc_section, "median");
-        baseline->ipc.mad = extract_json_double(ipc_section, "mad");
-        baseline->ipc.min = extract_json_double(ipc_section, "min");
-        baseline->ipc.max = extract_json_double(ipc_section, "max");
-        baseline->ipc.samples = extract_json_int(ipc_section, "samples");
-    }
-    
-    // Branch miss rate baseline
-    char *bmr_section = strstr(baseline_stats, "\"branch_miss_rate\":");
-    if (bmr_section) {
-        baseline->branch_miss_rate.median = extract_json_double(bmr_section, "median");
-        baseline->branch_miss_rate.mad = extract_json_double(bmr_section, "mad");
-        baseline->branch_miss_rate.min = extract_json_double(bmr_section, "min");
-        baseline->branch_miss_rate.max = extract_json_double(bmr_section, "max");
-        baseline->branch_miss_rate.samples = extract_json_int(bmr_section, "samples");
-    }
-    
-    // Cache miss rate baseline
-    char *cmr_section = strstr(baseline_stats, "\"cache_miss_rate\":");
-    if (cmr_section) {
-        baseline->cache_miss_rate.median = extract_json_double(cmr_section, "median");
-        baseline->cache_miss_rate.mad = extract_json_double(cmr_section, "mad");
-        baseline->cache_miss_rate.min = extract_json_double(cmr_section, "min");
-        baseline->cache_miss_rate.max = extract_json_double(cmr_section, "max");
-        baseline->cache_miss_rate.samples = extract_json_int(cmr_section, "samples");
-    }
-    
-    // L1D MPKI baseline
-    char *l1d_section = strstr(baseline_stats, "\"l1d_mpki\":");
-    if (l1d_section) {
-        baseline->l1d_mpki.median = extract_json_double(l1d_section, "median");
-        baseline->l1d_mpki.mad = extract_json_double(l1d_section, "mad");
-        baseline->l1d_mpki.min = extract_json_double(l1d_section, "min");
-        baseline->l1d_mpki.max = extract_json_double(l1d_section, "max");
-        baseline->l1d_mpki.samples = extract_json_int(l1d_section, "samples");
-    }
-    
-    // iTLB MPKI baseline
-    char *itlb_section = strstr(baseline_stats, "\"itlb_mpki\":");
-    if (itlb_section) {
-        baseline->itlb_mpki.median = extract_json_double(itlb_section, "median");
-        baseline->itlb_mpki.mad = extract_json_double(itlb_section, "mad");
-        baseline->itlb_mpki.min = extract_json_double(itlb_section, "min");
-        baseline->itlb_mpki.max = extract_json_double(itlb_section, "max");
-        baseline->itlb_mpki.samples = extract_json_int(itlb_section, "samples");
-    }
-    
-    // dTLB MPKI baseline
-    char *dtlb_section = strstr(baseline_stats, "\"dtlb_mpki\":");
-    if (dtlb_section) {
-        baseline->dtlb_mpki.median = extract_json_double(dtlb_section, "median");
-        baseline->dtlb_mpki.mad = extract_json_double(dtlb_section, "mad");
-        baseline->dtlb_mpki.min = extract_json_double(dtlb_section, "min");
-        baseline->dtlb_mpki.max = extract_json_double(dtlb_section, "max");
-        baseline->dtlb_mpki.samples = extract_json_int(dtlb_section, "samples");
+    // Fields are looked up inside their own feature object, so a missing
+    // field can never pick up the value from a later section
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        int section = json_find(&doc, statistics, feature_table[f].name);
+        if (section < 0) continue;
+        
+        baseline_stats_t *stats = (baseline_stats_t *)((char *)baseline + feature_table[f].baseline_offset);
+        json_get_double(&doc, section, "median", &stats->median);
+        json_get_double(&doc, section, "mad", &stats->mad);
+        json_get_double(&doc, section, "min", &stats->min);
+        json_get_double(&doc, section, "max", &stats->max);
+        json_get_int(&doc, section, "samples", &stats->samples);
+        json_get_double(&doc, section, "median_ci", &stats->median_ci);
+        json_get_double(&doc, section, "mad_ci", &stats->mad_ci);
     }
     
+    // Phase statistics are optional; single-phase baselines have none
+    int phases = json_find(&doc, 0, "phases");
+    if (phases >= 0 && doc.tokens[phases].type == JSON_ARRAY) {
+        size_t child = phases + 1;
+        for (uint32_t i = 0; i < doc.tokens[phases].size && i < MAX_PHASES; i++) {
+            baseline_phase_t *phase = &baseline->phases[i];
+            int centroid = json_find(&doc, child, "centroid");
+            int statistics_section = json_find(&doc, child, "statistics");
+            json_get_double(&doc, child, "weight", &phase->weight);
+            for (int f = 0; f < NUM_FEATURES; f++) {
+                if (centroid >= 0) json_get_double(&doc, centroid, feature_table[f].name, &baseline->centroids[f][i]);
+                int section = statistics_section >= 0 ? json_find(&doc, statistics_section, feature_table[f].name) : -1;
+                if (section < 0) continue;
+                
+                baseline_stats_t *stats = &phase->stats[f];
+                json_get_double(&doc, section, "median", &stats->median);
+                json_get_double(&doc, section, "mad", &stats->mad);
+                json_get_double(&doc, section, "min", &stats->min);
+                json_get_double(&doc, section, "max", &stats->max);
+                json_get_int(&doc, section, "samples", &stats->samples);
+                json_get_double(&doc, section, "median_ci", &stats->median_ci);
+                json_get_double(&doc, section, "mad_ci", &stats->mad_ci);
+            }
+            baseline->num_phases++;
+            child = doc.tokens[child].next;
+        }
+    }
+    
+    // Older baselines carry no placement; it is only compared when present
+    json_get_string(&doc, 0, "metadata.config.monitor_cpus", baseline->placement, sizeof(baseline->placement));
+    
+    json_free(&doc);
     free(json_content);
+    prepare_baseline_scoring(baseline);
     return 0;
-}
\ No newline at end of file
+}
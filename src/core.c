@@ -2,39 +2,144 @@
 
 int build_perf_command(const config_t *config, const char *target, char *cmd_buffer, size_t buffer_size);
 
-int hpc_ids_init(hpc_ids_t *ids, const char *config_file) {
+static int ids_init(hpc_ids_t *ids, const char *config_file, bool embedded) {
     memset(ids, 0, sizeof(hpc_ids_t));
     
     // Load configuration
-    if (load_config(&ids->config, config_file) != 0) {
+    if ((embedded ? load_config_quiet : load_config)(&ids->config, config_file) != 0) {
         fprintf(stderr, "Failed to load configuration from %s\n", config_file);
         return -1;
     }
     
-    // Load global baseline from baseline directory
-    char global_baseline_path[MAX_PATH_LEN];
-    snprintf(global_baseline_path, sizeof(global_baseline_path), "%s/rigorous_baseline.json", 
-             ids->config.baseline_directory);
-    if (load_baseline(&ids->global_baseline, global_baseline_path) != 0) {
-        fprintf(stderr, "Warning: Failed to load global baseline\n");
+    if (baseline_table_init(&ids->app_baselines, 0) != 0) {
+        fprintf(stderr, "Failed to allocate baseline table\n");
+        return -1;
+    }
+    ids->app_baselines.max_entries = ids->config.baseline_cache_size;
+    // Address space only; pages are committed as the collector fills them
+    if (arena_init(&ids->collection_arena, "Collection",
+                   (size_t)ids->config.collection_memory_mb << 20) != 0) {
+        fprintf(stderr, "Warning: no memory reserved for baseline collection\n");
+    }
+    pthread_mutex_init(&ids->baseline_lock, NULL);
+    ids->baseline_epoch = 1;
+    
+    // Prefer the compiled baseline store: mapping it costs the same for any number of apps
+    char store_path[BASELINE_STORE_PATH_LEN];
+    bool have_store_path = true;
+    if (ids->config.baseline_store_file[0]) {
+        strcpy(store_path, ids->config.baseline_store_file);
+    } else {
+        have_store_path = snprintf(store_path, sizeof(store_path), "%s/baselines.bin",
+                                   ids->config.baseline_directory) < (int)sizeof(store_path);
     }
     
-    // Load per-app baselines
-    load_app_baselines(ids);
+    if (have_store_path && baseline_store_open(&ids->baseline_store, store_path) == 0) {
+        const baseline_record_t *global = baseline_store_find(&ids->baseline_store, BASELINE_STORE_GLOBAL);
+        if (global) {
+            ids->global_baseline = global->baseline;
+        } else {
+            fprintf(stderr, "Warning: baseline store has no global baseline\n");
+            prepare_baseline_scoring(&ids->global_baseline);
+        }
+        
+        // Adding or renaming JSON baselines bumps the directory mtime
+        struct stat store_stat, dir_stat;
+        if (stat(store_path, &store_stat) == 0 && stat(ids->config.baseline_directory, &dir_stat) == 0 &&
+            dir_stat.st_mtime > store_stat.st_mtime) {
+            fprintf(stderr, "Warning: %s is older than %s, rerun baseline_compile\n",
+                    store_path, ids->config.baseline_directory);
+        }
+        
+        ids->num_apps = ids->baseline_store.header->num_records - (global ? 1 : 0);
+        if (!ids->config.quiet) {
+            printf("Mapped baseline store %s\n", store_path);
+            printf("HPC-IDS initialized with %d events and %d app baselines\n", 
+                   ids->config.num_events, ids->num_apps);
+        }
+    } else {
+        // Per-app baselines are read on first attach, see baseline_cache_lookup
+        load_global_baseline(ids);
+        if (!ids->config.quiet) {
+            printf("HPC-IDS initialized with %d events, app baselines loaded on demand (cache size %d)\n",
+                   ids->config.num_events, ids->config.baseline_cache_size);
+        }
+    }
     
-    ids->last_alert_time = 0;
+    strcpy(ids->global_entry.name, BASELINE_STORE_GLOBAL);
+    ids->global_entry.current = &ids->global_baseline;
     
-    printf("HPC-IDS initialized with %d events and %d app baselines\n", 
-           ids->config.num_events, ids->num_apps);
+    // Before any helper thread or perf child exists, so all of them inherit it
+    if (placement_init(&ids->placement, &ids->config) == 0) {
+        if (!embedded) placement_apply_self(&ids->placement);
+    } else {
+        fprintf(stderr, "Warning: CPU placement unavailable, running unpinned\n");
+    }
+    
+    // An embedding host starts the watcher thread itself if it wants one
+    if (!embedded && ids->config.baseline_hot_reload && baseline_watcher_start(ids) != 0) {
+        fprintf(stderr, "Warning: baseline hot reload disabled\n");
+    }
     
     return 0;
 }
 
+int hpc_ids_init(hpc_ids_t *ids, const char *config_file) {
+    return ids_init(ids, config_file, false);
+}
+
+// For a host process embedding the detector: its threads stay where the
+// host put them, only perf children and targets are placed. Nothing is
+// printed to stdout and no baseline watcher is started.
+int hpc_ids_init_embedded(hpc_ids_t *ids, const char *config_file) {
+    return ids_init(ids, config_file, true);
+}
+
 void hpc_ids_cleanup(hpc_ids_t *ids) {
-    if (ids->alert_file) {
-        fclose(ids->alert_file);
-        ids->alert_file = NULL;
+    baseline_watcher_stop(ids);
+    alert_writer_stop(&ids->alert_writer);
+    telemetry_close(&ids->telemetry);
+    if (ids->app_baselines.misses > 0 && !ids->config.quiet) {
+        baseline_table_report(&ids->app_baselines);
+    }
+    baseline_table_free(&ids->app_baselines);
+    baseline_store_close(&ids->baseline_store);
+    
+    // No readers are left, so every retired version can go
+    baseline_reclaim(ids);
+    if (ids->global_entry.owns_current) {
+        free(ids->global_entry.current);
+    }
+    pthread_mutex_destroy(&ids->baseline_lock);
+    
+    if (ids->collection_arena.peak > 0 && !ids->config.quiet) {
+        arena_report(&ids->collection_arena);
+    }
+    arena_destroy(&ids->collection_arena);
+}
+
+// Load the global baseline from the baseline directory
+int load_global_baseline(hpc_ids_t *ids) {
+    char global_baseline_path[MAX_PATH_LEN];
+    snprintf(global_baseline_path, sizeof(global_baseline_path), "%s/rigorous_baseline.json", 
+             ids->config.baseline_directory);
+    if (load_baseline(&ids->global_baseline, global_baseline_path) != 0) {
+        fprintf(stderr, "Warning: Failed to load global baseline\n");
+        prepare_baseline_scoring(&ids->global_baseline);
+        return -1;
     }
+    return 0;
+}
+
+// Eagerly parse the global and every per-app JSON baseline (baseline_compile)
+int load_json_baselines(hpc_ids_t *ids, bool *has_global) {
+    bool loaded = load_global_baseline(ids) == 0;
+    if (has_global) *has_global = loaded;
+    
+    // Load per-app baselines
+    int count = load_app_baselines(ids);
+    baseline_table_report(&ids->app_baselines);
+    return count;
 }
 
 int load_app_baselines(hpc_ids_t *ids) {
@@ -50,30 +155,43 @@ int load_app_baselines(hpc_ids_t *ids) {
     
     ids->num_apps = 0;
     
-    while ((entry = readdir(dir)) != NULL && ids->num_apps < MAX_APPS) {
+    while ((entry = readdir(dir)) != NULL) {
         if (strncmp(entry->d_name, "baseline_", 9) == 0 && 
             strstr(entry->d_name, ".json")) {
             
             // Extract app name from filename
-            char *app_name = entry->d_name + 9; // Skip "baseline_"
+            char app_name[128];
+            strncpy(app_name, entry->d_name + 9, sizeof(app_name) - 1); // Skip "baseline_"
+            app_name[sizeof(app_name) - 1] = '\0';
             char *dot = strrchr(app_name, '.');
             if (dot) *dot = '\0';
             
-            strcpy(ids->app_baselines[ids->num_apps].name, app_name);
-            
             // Load baseline
             snprintf(baseline_path, sizeof(baseline_path), "%s/%s", 
                     ids->config.baseline_directory, entry->d_name);
             
-            if (load_baseline(&ids->app_baselines[ids->num_apps].baseline, baseline_path) == 0) {
-                ids->app_baselines[ids->num_apps].has_baseline = true;
-                printf("Loaded baseline for app: %s\n", app_name);
-                ids->num_apps++;
-            } else {
+            baseline_t *baseline = malloc(sizeof(baseline_t));
+            if (!baseline || load_baseline(baseline, baseline_path) != 0) {
                 fprintf(stderr, "Failed to load baseline for app: %s\n", app_name);
+                free(baseline);
+                continue;
+            }
+            
+            app_baseline_t *app = baseline_table_insert(&ids->app_baselines, app_name);
+            if (!app) {
+                fprintf(stderr, "Failed to store baseline for app: %s\n", app_name);
+                free(baseline);
+                continue;
+            }
+            if (app->current) {
+                free(baseline);
+                continue; // Duplicate, keep the first one loaded
             }
             
-            if (dot) *dot = '.'; // Restore dot
+            app->current = baseline;
+            app->owns_current = true;
+            if (!ids->config.quiet) printf("Loaded baseline for app: %s\n", app_name);
+            ids->num_apps++;
         }
     }
     
@@ -81,39 +199,135 @@ int load_app_baselines(hpc_ids_t *ids) {
     return ids->num_apps;
 }
 
-int get_available_apps(const char *app_dir, char apps[][128], int max_apps) {
+// Executables in app_dir, in a list grown as needed; the caller frees *apps.
+// Returns the number found, or -1 if the list could not be allocated.
+int get_available_apps(const char *app_dir, char (**apps)[128]) {
     DIR *dir;
     struct dirent *entry;
     int count = 0;
+    int capacity = 0;
     
+    *apps = NULL;
     dir = opendir(app_dir);
     if (!dir) {
         return 0;
     }
     
-    while ((entry = readdir(dir)) != NULL && count < max_apps) {
-        char full_path[MAX_PATH_LEN];
-        snprintf(full_path, sizeof(full_path), "%s/%s", app_dir, entry->d_name);
+    while ((entry = readdir(dir)) != NULL) {
+        char full_path[MAX_PATH_LEN + NAME_MAX + 1];
+        if (snprintf(full_path, sizeof(full_path), "%s/%s", app_dir, entry->d_name) >= (int)sizeof(full_path)) {
+            continue;
+        }
         
         struct stat file_stat;
-        if (stat(full_path, &file_stat) == 0 && S_ISREG(file_stat.st_mode) && access(full_path, X_OK) == 0) {
-            strcpy(apps[count], entry->d_name);
-            count++;
+        if (stat(full_path, &file_stat) != 0 || !S_ISREG(file_stat.st_mode) || access(full_path, X_OK) != 0) {
+            continue;
+        }
+        if (strlen(entry->d_name) >= sizeof(**apps)) {
+            fprintf(stderr, "Warning: skipping %s, app names are limited to %zu characters\n",
+                    entry->d_name, sizeof(**apps) - 1);
+            continue;
         }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            char (*grown)[128] = realloc(*apps, capacity * sizeof(**apps));
+            if (!grown) {
+                fprintf(stderr, "Cannot list more than %d applications\n", count);
+                free(*apps);
+                *apps = NULL;
+                closedir(dir);
+                return -1;
+            }
+            *apps = grown;
+        }
+        strcpy((*apps)[count], entry->d_name);
+        count++;
     }
     
     closedir(dir);
     return count;
 }
 
-int monitor_system(hpc_ids_t *ids, int duration_seconds) {
-    char cmd[1024];
-    hpc_measurement_t measurements[MAX_SAMPLES];
-    int measurement_count;
+// Intervals are handed to the pipeline as perf reports them; it scores
+// them on the stage threads, or inline when those are disabled
+typedef struct {
+    hpc_ids_t *ids;
+    target_state_t *target;
+    int intervals;
+    bool realtime;          // replay paced to the recording's own timing
+    struct timespec start;  // CLOCK_MONOTONIC when the replay began
+    energy_meter_t *energy; // read at every interval boundary, NULL if off or replaying
+    pipeline_t pipeline;
+} monitor_stream_t;
+
+static double elapsed_seconds(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start->tv_sec) + (now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static int monitor_interval(void *context, hpc_measurement_t *measurements, int count) {
+    monitor_stream_t *stream = context;
+    hpc_measurement_t energy[MAX_EVENTS + ENERGY_EVENTS];
+    
+    stream->intervals++;
+    if (stream->realtime) {
+        // Sleep until the interval's offset in the recording
+        struct timespec due = stream->start;
+        double offset = measurements[0].perf_time;
+        due.tv_sec += (time_t)offset;
+        due.tv_nsec += (long)((offset - (time_t)offset) * 1e9);
+        if (due.tv_nsec >= 1000000000L) {
+            due.tv_sec++;
+            due.tv_nsec -= 1000000000L;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL) == EINTR) {}
+    }
     
-    printf("Starting system-wide monitoring for %d seconds...\n", duration_seconds);
+    // Energy since the previous boundary joins the interval's counters. Live
+    // intervals arrive with their last counter, and energy is read before a
+    // full queue can hold the reader up, to keep the same boundary.
+    int total = count;
+    if (stream->energy) {
+        memcpy(energy, measurements, count * sizeof(hpc_measurement_t));
+        total = energy_meter_append(stream->energy, energy, count);
+        measurements = energy;
+    }
     
-    if (build_perf_command(&ids->config, NULL, cmd, sizeof(cmd)) != 0) {
+    pipeline_interval_t *interval = pipeline_reserve(&stream->pipeline);
+    memcpy(interval->measurements, measurements, total * sizeof(hpc_measurement_t));
+    interval->counters = count;
+    interval->count = total;
+    pipeline_submit(&stream->pipeline);
+    return 0;
+}
+
+// <trace_directory>/trace_<label>_<start>.hpct, one file per monitoring run
+static trace_writer_t* open_target_trace(const config_t *config, const target_state_t *target, bool energy) {
+    if (!config->trace_directory[0]) return NULL;
+    
+    char label[sizeof(target->label)];
+    strcpy(label, target->label);
+    for (char *c = label; *c; c++) {
+        if (*c == '/' || *c == ':') *c = '_';
+    }
+    char path[MAX_PATH_LEN + 128];
+    snprintf(path, sizeof(path), "%s/trace_%s_%ld.hpct", config->trace_directory, label, (long)time(NULL));
+    
+    trace_writer_t *trace = malloc(sizeof(trace_writer_t));
+    if (!trace || trace_writer_open(trace, path, target->name, config, energy) != 0) {
+        fprintf(stderr, "Warning: counter trace disabled for %s\n", target->name);
+        free(trace);
+        return NULL;
+    }
+    printf("Recording raw counters to %s\n", path);
+    return trace;
+}
+
+static int run_monitor(hpc_ids_t *ids, target_state_t *target, const char *perf_target,
+                       int min_counters, int duration_seconds) {
+    char cmd[1024];
+    if (build_perf_command(&ids->config, perf_target, cmd, sizeof(cmd)) != 0) {
         fprintf(stderr, "Failed to build perf command\n");
         return -1;
     }
@@ -122,122 +336,74 @@ int monitor_system(hpc_ids_t *ids, int duration_seconds) {
     char timed_cmd[1200];
     snprintf(timed_cmd, sizeof(timed_cmd), "timeout %d %s", duration_seconds, cmd);
     
-    if (execute_perf_command(timed_cmd, measurements, &measurement_count, duration_seconds) != 0) {
-        fprintf(stderr, "Failed to execute perf command\n");
-        return -1;
+    energy_meter_t energy;
+    monitor_stream_t stream = { .ids = ids, .target = target };
+    if (energy_source_open(&energy, &ids->config) == 0) {
+        stream.energy = &energy;
+        printf("Energy features from %s\n", energy.modeled ? "the utilization model" : "RAPL");
     }
-    
-    printf("Collected %d measurements\n", measurement_count);
-    
-    if (measurement_count == 0) {
-        fprintf(stderr, "No measurements collected - check perf permissions or events\n");
-        return -1;
+    trace_writer_t *trace = open_target_trace(&ids->config, target, stream.energy != NULL);
+    start_alert_output(ids);
+    pipeline_start(&stream.pipeline, ids, target, trace, min_counters, false);
+    int measurement_count = stream_perf_command(timed_cmd, duration_seconds, ids->config.num_events,
+                                                 monitor_interval, &stream);
+    pipeline_finish(&stream.pipeline);
+    flush_target_alerts(ids, target);
+    if (stream.energy) {
+        energy_meter_close(&energy);
     }
-    
-    // Group measurements by timestamp (intervals)
-    typedef struct {
-        double timestamp;
-        hpc_measurement_t measurements[MAX_EVENTS];
-        int count;
-    } interval_data_t;
-    
-    interval_data_t intervals[1000]; // Support up to 1000 intervals
-    int num_intervals = 0;
-    
-    // Group measurements by perf_time
-    for (int i = 0; i < measurement_count; i++) {
-        double timestamp = measurements[i].perf_time;
-        
-        // Find or create interval for this timestamp
-        int interval_idx = -1;
-        for (int j = 0; j < num_intervals; j++) {
-            if (fabs(intervals[j].timestamp - timestamp) < 0.001) { // 1ms tolerance
-                interval_idx = j;
-                break;
-            }
-        }
-        
-        if (interval_idx == -1 && num_intervals < 1000) {
-            // Create new interval
-            interval_idx = num_intervals++;
-            intervals[interval_idx].timestamp = timestamp;
-            intervals[interval_idx].count = 0;
-        }
-        
-        if (interval_idx >= 0 && intervals[interval_idx].count < MAX_EVENTS) {
-            intervals[interval_idx].measurements[intervals[interval_idx].count++] = measurements[i];
-        }
+    if (trace) {
+        trace_writer_close(trace);
+        trace_writer_report(trace);
+        free(trace);
     }
     
-    printf("Grouped into %d intervals\n", num_intervals);
-    
-    // Process complete intervals
-    int processed_intervals = 0;
-    for (int i = 0; i < num_intervals; i++) {
-        if (intervals[i].count >= 3) { // At least 3 counters for basic features
-            feature_vector_t features;
-            if (engineer_features(intervals[i].measurements, intervals[i].count, &features) == 0) {
-                detect_anomalies(ids, &features, NULL);
-                processed_intervals++;
-            }
-        }
+    if (measurement_count < 0) {
+        fprintf(stderr, "Failed to execute perf command\n");
+        return -1;
     }
     
-    printf("Processed %d complete intervals\n", processed_intervals);
-    
+    printf("Collected %d measurements for %s in %d intervals, %lu processed\n",
+           measurement_count, target->name, stream.intervals,
+           (unsigned long)stream.pipeline.stages[STAGE_SCORING].processed);
+    pipeline_report(&stream.pipeline);
     return 0;
 }
 
-int monitor_pid(hpc_ids_t *ids, pid_t pid, int duration_seconds) {
-    char cmd[1024];
-    char target[32];
-    hpc_measurement_t measurements[MAX_SAMPLES];
-    int measurement_count;
-    
-    char *app_name = get_app_name_from_pid(pid);
-    printf("Monitoring PID %d (%s) for %d seconds...\n", pid, app_name, duration_seconds);
+int monitor_system(hpc_ids_t *ids, int duration_seconds) {
+    printf("Starting system-wide monitoring for %d seconds...\n", duration_seconds);
     
-    snprintf(target, sizeof(target), "pid:%d", pid);
+    target_state_t target;
+    attach_target(ids, &target, NULL, 0);
     
-    if (build_perf_command(&ids->config, target, cmd, sizeof(cmd)) != 0) {
-        fprintf(stderr, "Failed to build perf command\n");
-        return -1;
-    }
+    // At least 3 counters for basic features
+    int result = run_monitor(ids, &target, NULL, 3, duration_seconds);
     
-    char timed_cmd[1200];
-    snprintf(timed_cmd, sizeof(timed_cmd), "timeout %d %s", duration_seconds, cmd);
+    detach_target(ids, &target);
+    return result;
+}
+
+int monitor_pid(hpc_ids_t *ids, pid_t pid, int duration_seconds) {
+    char pid_target[32];
     
-    if (execute_perf_command(timed_cmd, measurements, &measurement_count, duration_seconds) != 0) {
-        fprintf(stderr, "Failed to execute perf command\n");
-        return -1;
-    }
+    char app_name[128];
+    get_app_name_from_pid(pid, app_name, sizeof(app_name));
+    printf("Monitoring PID %d (%s) for %d seconds...\n", pid, app_name, duration_seconds);
     
-    printf("Collected %d measurements for %s\n", measurement_count, app_name);
+    snprintf(pid_target, sizeof(pid_target), "pid:%d", pid);
+    placement_pin_pid(&ids->placement, pid);
     
-    // Process measurements
-    feature_vector_t features;
+    target_state_t target;
+    attach_target(ids, &target, app_name, pid);
     
-    for (int i = 0; i < measurement_count; i += ids->config.num_events) {
-        int interval_count = 0;
-        for (int j = 0; j < ids->config.num_events && (i + j) < measurement_count; j++) {
-            interval_count++;
-        }
-        
-        if (interval_count == ids->config.num_events) {
-            if (engineer_features(&measurements[i], interval_count, &features) == 0) {
-                detect_anomalies(ids, &features, app_name);
-            }
-        }
-    }
+    int result = run_monitor(ids, &target, pid_target, ids->config.num_events, duration_seconds);
     
-    return 0;
+    detach_target(ids, &target);
+    return result;
 }
 
 int monitor_app(hpc_ids_t *ids, const char *app_name, int duration_seconds) {
-    char cmd[1024];
     char app_path[MAX_PATH_LEN];
-    hpc_measurement_t measurements[MAX_SAMPLES];
-    int measurement_count;
     
     snprintf(app_path, sizeof(app_path), "%s/%s", ids->config.app_directory, app_name);
     
@@ -248,36 +414,52 @@ int monitor_app(hpc_ids_t *ids, const char *app_name, int duration_seconds) {
     
     printf("Monitoring application %s for %d seconds...\n", app_name, duration_seconds);
     
-    if (build_perf_command(&ids->config, app_path, cmd, sizeof(cmd)) != 0) {
-        fprintf(stderr, "Failed to build perf command\n");
-        return -1;
-    }
+    target_state_t target;
+    attach_target(ids, &target, app_name, 0);
     
-    char timed_cmd[1200];
-    snprintf(timed_cmd, sizeof(timed_cmd), "timeout %d %s", duration_seconds, cmd);
+    int result = run_monitor(ids, &target, app_path, ids->config.num_events, duration_seconds);
     
-    if (execute_perf_command(timed_cmd, measurements, &measurement_count, duration_seconds) != 0) {
-        fprintf(stderr, "Failed to execute perf command\n");
+    detach_target(ids, &target);
+    return result;
+}
+
+// Feed a recorded `perf stat -I -x ,` stream through the same parse, feature
+// and detection path as live monitoring. app_name selects the per-app
+// baseline (NULL scores against the global one, like system-wide mode).
+// Without realtime the recording is replayed as fast as it can be scored.
+// Alerts are dated epoch + the recording's own times, so with a fixed epoch
+// (0 by default) the same recording always produces the same alerts.
+int replay_perf_recording(hpc_ids_t *ids, const char *path, const char *app_name, bool realtime,
+                          double epoch) {
+    printf("Replaying %s%s...\n", path, realtime ? " with original timing" : "");
+    
+    // Every alert of the recording must reach the output for runs to be comparable
+    ids->config.alert_queue_blocking = true;
+    
+    target_state_t target;
+    attach_target(ids, &target, app_name, 0);
+    // Cooldowns run on the recording's own clock either way
+    target.time_base = epoch;
+    
+    monitor_stream_t stream = { .ids = ids, .target = &target, .realtime = realtime };
+    start_alert_output(ids);
+    pipeline_start(&stream.pipeline, ids, &target, NULL, app_name ? ids->config.num_events : 3, true);
+    clock_gettime(CLOCK_MONOTONIC, &stream.start);
+    int measurement_count = stream_perf_file(path, monitor_interval, &stream);
+    pipeline_finish(&stream.pipeline);
+    flush_target_alerts(ids, &target);
+    double elapsed = elapsed_seconds(&stream.start);
+    
+    detach_target(ids, &target);
+    if (measurement_count < 0) {
+        fprintf(stderr, "No measurements in %s\n", path);
         return -1;
     }
     
-    printf("Collected %d measurements for %s\n", measurement_count, app_name);
-    
-    // Process measurements
-    feature_vector_t features;
-    
-    for (int i = 0; i < measurement_count; i += ids->config.num_events) {
-        int interval_count = 0;
-        for (int j = 0; j < ids->config.num_events && (i + j) < measurement_count; j++) {
-            interval_count++;
-        }
-        
-        if (interval_count == ids->config.num_events) {
-            if (engineer_features(&measurements[i], interval_count, &features) == 0) {
-                detect_anomalies(ids, &features, app_name);
-            }
-        }
-    }
-    
+    printf("Replayed %d measurements in %d intervals (%lu processed) in %.3f s: %.0f intervals/sec\n",
+           measurement_count, stream.intervals, (unsigned long)stream.pipeline.stages[STAGE_SCORING].processed,
+           elapsed, elapsed > 0 ? stream.intervals / elapsed : 0.0);
+    printf("Replay raised %lu anomalies\n", (unsigned long)stream.pipeline.anomalies);
+    pipeline_report(&stream.pipeline);
     return 0;
-}
\ No newline at end of file
+}
@@ -1,4 +1,5 @@
 #include "hpc_ids.h"
+#include <stddef.h>
 
 const char* get_severity_string(double z_score, const config_t *config) {
     if (fabs(z_score) >= config->robust_z_threshold_critical) {
@@ -11,6 +12,15 @@ const char* get_severity_string(double z_score, const config_t *config) {
     return "normal";
 }
 
+// 0 normal, 1 medium, 2 high, 3 critical
+int get_severity_level(double z_score, const config_t *config) {
+    double magnitude = fabs(z_score);
+    if (magnitude >= config->robust_z_threshold_critical) return 3;
+    if (magnitude >= config->robust_z_threshold_high) return 2;
+    if (magnitude >= config->robust_z_threshold_medium) return 1;
+    return 0;
+}
+
 double get_threshold_for_severity(const char *severity, const config_t *config) {
     if (strcmp(severity, "critical") == 0) {
         return config->robust_z_threshold_critical;
@@ -22,123 +32,217 @@ double get_threshold_for_severity(const char *severity, const config_t *config)
     return 0.0;
 }
 
-int check_feature_anomaly(const char *feature_name, double value, 
+const feature_desc_t feature_table[NUM_FEATURES] = {
+    [FEATURE_IPC]              = {"ipc", offsetof(feature_vector_t, ipc), offsetof(baseline_t, ipc)},
+    [FEATURE_BRANCH_MISS_RATE] = {"branch_miss_rate", offsetof(feature_vector_t, branch_miss_rate),
+                                  offsetof(baseline_t, branch_miss_rate)},
+    [FEATURE_CACHE_MISS_RATE]  = {"cache_miss_rate", offsetof(feature_vector_t, cache_miss_rate),
+                                  offsetof(baseline_t, cache_miss_rate)},
+    [FEATURE_L1D_MPKI]         = {"l1d_mpki", offsetof(feature_vector_t, l1d_mpki), offsetof(baseline_t, l1d_mpki)},
+    [FEATURE_ITLB_MPKI]        = {"itlb_mpki", offsetof(feature_vector_t, itlb_mpki), offsetof(baseline_t, itlb_mpki)},
+    [FEATURE_DTLB_MPKI]        = {"dtlb_mpki", offsetof(feature_vector_t, dtlb_mpki), offsetof(baseline_t, dtlb_mpki)},
+    [FEATURE_PACKAGE_JOULES]   = {"package_joules", offsetof(feature_vector_t, package_joules),
+                                  offsetof(baseline_t, package_joules)},
+    [FEATURE_CORE_JOULES]      = {"core_joules", offsetof(feature_vector_t, core_joules),
+                                  offsetof(baseline_t, core_joules)},
+    [FEATURE_DRAM_JOULES]      = {"dram_joules", offsetof(feature_vector_t, dram_joules),
+                                  offsetof(baseline_t, dram_joules)},
+    [FEATURE_NJ_PER_INSTRUCTION] = {"nj_per_instruction", offsetof(feature_vector_t, nj_per_instruction),
+                                    offsetof(baseline_t, nj_per_instruction)},
+};
+
+int feature_index(const char *name) {
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        if (strcmp(feature_table[f].name, name) == 0) return f;
+    }
+    return -1;
+}
+
+int check_feature_anomaly(const char *feature_name, double value, double z_score,
                          const baseline_stats_t *baseline, const config_t *config,
-                         anomaly_alert_t *alert, const char *app_name) {
-    
-    double z_score = compute_robust_z_score(value, baseline->median, baseline->mad);
+                         anomaly_alert_t *alert, const target_state_t *target) {
     const char *severity = get_severity_string(z_score, config);
     
     if (strcmp(severity, "normal") == 0) {
         return 0; // No anomaly
     }
     
-    // Create alert
-    strcpy(alert->application_name, app_name ? app_name : "system");
-    strcpy(alert->baseline_type, app_name ? "per_app" : "global");
+    // Create alert; the caller stamps it with the interval's time
+    memset(alert, 0, sizeof(anomaly_alert_t));
+    strcpy(alert->target, target->label);
+    strcpy(alert->application_name, target->name);
+    strcpy(alert->baseline_type, target->per_app ? "per_app" : "global");
+    strcpy(alert->placement, target->placement);
     strcpy(alert->feature, feature_name);
     alert->measured_value = value;
     alert->baseline_median = baseline->median;
     alert->robust_z_score = z_score;
     alert->threshold = get_threshold_for_severity(severity, config);
     strcpy(alert->severity, severity);
-    alert->timestamp = time(NULL);
+    alert->count = 1;
     
     return 1; // Anomaly detected
 }
 
-int detect_anomalies(hpc_ids_t *ids, const feature_vector_t *features, const char *app_name) {
-    baseline_t *baseline = &ids->global_baseline;
-    
-    // Check if we have a per-app baseline for this application
-    if (app_name) {
-        for (int i = 0; i < ids->num_apps; i++) {
-            if (strcmp(ids->app_baselines[i].name, app_name) == 0 && 
-                ids->app_baselines[i].has_baseline) {
-                baseline = &ids->app_baselines[i].baseline;
-                break;
-            }
-        }
+// Fold an anomaly that arrived during its feature's cooldown into the target aggregate
+static void aggregate_alert(target_state_t *target, feature_id_t feature,
+                            const anomaly_alert_t *alert, uint32_t now) {
+    alert_aggregate_t *agg = &target->aggregate;
+    
+    if (agg->count == 0) {
+        agg->first_seen = now;
+        agg->max_z = 0.0f;
     }
     
-    // Check cooldown period
-    time_t current_time = time(NULL);
-    if (current_time - ids->last_alert_time < ids->config.alert_cooldown_seconds) {
-        return 0; // Still in cooldown
-    }
+    agg->count++;
+    agg->last_seen = now;
+    agg->feature_mask |= 1u << feature;
     
-    anomaly_alert_t alert;
-    int anomaly_count = 0;
-    
-    // Check each feature for anomalies
-    if (check_feature_anomaly("ipc", features->ipc, &baseline->ipc, 
-                             &ids->config, &alert, app_name)) {
-        log_alert(ids, &alert);
-        anomaly_count++;
-    }
-    
-    if (check_feature_anomaly("branch_miss_rate", features->branch_miss_rate, 
-                             &baseline->branch_miss_rate, &ids->config, &alert, app_name)) {
-        log_alert(ids, &alert);
-        anomaly_count++;
+    if (fabs(alert->robust_z_score) >= fabsf(agg->max_z)) {
+        agg->max_z = (float)alert->robust_z_score;
+        agg->feature = (uint8_t)feature;
+        agg->measured_value = alert->measured_value;
+        agg->baseline_median = alert->baseline_median;
     }
-    
-    if (check_feature_anomaly("cache_miss_rate", features->cache_miss_rate, 
-                             &baseline->cache_miss_rate, &ids->config, &alert, app_name)) {
-        log_alert(ids, &alert);
-        anomaly_count++;
+}
+
+// Collect the interval's anomalies on features out of cooldown into one
+// record led by the worst of them, so a storm opens with a single alert
+static void open_alert(anomaly_alert_t *opening, feature_id_t feature, const anomaly_alert_t *alert) {
+    if (opening->count == 0) {
+        *opening = *alert;
+        opening->feature_mask = 1u << feature;
+        return;
     }
     
-    if (check_feature_anomaly("l1d_mpki", features->l1d_mpki, 
-                             &baseline->l1d_mpki, &ids->config, &alert, app_name)) {
-        log_alert(ids, &alert);
-        anomaly_count++;
+    int count = opening->count + 1;
+    uint32_t mask = opening->feature_mask | (1u << feature);
+    if (fabs(alert->robust_z_score) > fabs(opening->robust_z_score)) {
+        *opening = *alert;
     }
+    opening->count = count;
+    opening->feature_mask = mask;
+    opening->aggregated = true;
+    opening->first_seen = opening->timestamp;
+    opening->last_seen = opening->timestamp;
+}
+
+static int emit_aggregate(hpc_ids_t *ids, target_state_t *target) {
+    alert_aggregate_t *agg = &target->aggregate;
+    if (agg->count == 0) return 0;
     
-    if (check_feature_anomaly("itlb_mpki", features->itlb_mpki, 
-                             &baseline->itlb_mpki, &ids->config, &alert, app_name)) {
-        log_alert(ids, &alert);
-        anomaly_count++;
+    anomaly_alert_t alert;
+    const char *severity = get_severity_string(agg->max_z, &ids->config);
+    
+    memset(&alert, 0, sizeof(alert));
+    strcpy(alert.target, target->label);
+    strcpy(alert.application_name, target->name);
+    strcpy(alert.baseline_type, target->per_app ? "per_app" : "global");
+    strcpy(alert.placement, target->placement);
+    strcpy(alert.feature, feature_table[agg->feature].name);
+    alert.measured_value = agg->measured_value;
+    alert.baseline_median = agg->baseline_median;
+    alert.robust_z_score = agg->max_z;
+    alert.threshold = get_threshold_for_severity(severity, &ids->config);
+    strcpy(alert.severity, severity);
+    alert.timestamp = target->time_base + agg->last_seen;
+    alert.aggregated = true;
+    alert.count = agg->count;
+    alert.first_seen = target->time_base + agg->first_seen;
+    alert.last_seen = target->time_base + agg->last_seen;
+    alert.feature_mask = agg->feature_mask;
+    
+    memset(agg, 0, sizeof(alert_aggregate_t));
+    log_alert(ids, &alert);
+    return 1;
+}
+
+int flush_target_alerts(hpc_ids_t *ids, target_state_t *target) {
+    return emit_aggregate(ids, target);
+}
+
+int detect_anomalies(hpc_ids_t *ids, target_state_t *target, const feature_vector_t *features) {
+    // Lock-free: pins the current published version until release
+    const baseline_t *baseline = baseline_acquire(ids, target);
+    // Interval time rather than the clock, so replayed recordings give the
+    // same alerts and cooldowns as the live run did
+    uint32_t now = (uint32_t)features->wall_time;
+    uint32_t cooldown = (uint32_t)ids->config.alert_cooldown_seconds;
+    
+    // Close the aggregation window once it has spanned a full cooldown period
+    if (target->aggregate.count > 0 && now - target->aggregate.first_seen >= cooldown) {
+        emit_aggregate(ids, target);
     }
     
-    if (check_feature_anomaly("dtlb_mpki", features->dtlb_mpki, 
-                             &baseline->dtlb_mpki, &ids->config, &alert, app_name)) {
-        log_alert(ids, &alert);
+    anomaly_alert_t alert;
+    anomaly_alert_t opening;    // features out of cooldown this interval, as one record
+    int anomaly_count = 0;
+    opening.count = 0;
+    
+    // Multi-phase baselines score the interval against its nearest phase only
+    int phase = baseline_nearest_phase(baseline, features);
+    target->last_max_z = 0.0;
+    target->last_feature = -1;
+    target->last_phase = (int8_t)(phase + 1);
+    
+    // Energy features missing from either side are left out
+    uint32_t skipped = ENERGY_FEATURE_MASK & ~(features->energy_mask & baseline->energy_mask);
+    
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        target->last_z[f] = NAN;
+        if (skipped & (1u << f)) continue;
+        const feature_desc_t *desc = &feature_table[f];
+        double value = *(const double *)((const char *)features + desc->value_offset);
+        const baseline_stats_t *stats = phase >= 0 ? &baseline->phases[phase].stats[f]
+            : (const baseline_stats_t *)((const char *)baseline + desc->baseline_offset);
+        if (stats->samples == 0 && (ENERGY_FEATURE_MASK & (1u << f))) continue;
+        
+        // Same as compute_robust_z_score, with 1/MAD precomputed at load time
+        double z_score = (value - stats->median) * stats->inv_mad;
+        target->last_z[f] = z_score;
+        if (!check_feature_anomaly(desc->name, value, z_score, stats, &ids->config, &alert, target)) {
+            continue;
+        }
+        alert.phase = phase + 1;
+        alert.timestamp = target->time_base + features->wall_time;
         anomaly_count++;
+        if (fabs(alert.robust_z_score) > fabs(target->last_max_z)) {
+            target->last_max_z = alert.robust_z_score;
+            target->last_feature = (int8_t)f;
+        }
+        
+        // Cooldown is tracked per (target, feature) so one noisy feature or
+        // process does not mask alerts elsewhere
+        if (now >= target->cooldown_until[f]) {
+            open_alert(&opening, (feature_id_t)f, &alert);
+            target->cooldown_until[f] = now + cooldown;
+        } else {
+            aggregate_alert(target, (feature_id_t)f, &alert, now);
+        }
     }
     
-    if (anomaly_count > 0) {
-        ids->last_alert_time = current_time;
+    if (opening.count > 0) {
+        log_alert(ids, &opening);
     }
-    
+    baseline_release(ids, target);
     return anomaly_count;
 }
 
-int log_alert(hpc_ids_t *ids, const anomaly_alert_t *alert) {
-    if (!ids->alert_file) {
-        ids->alert_file = fopen(ids->config.alert_output_file, "a");
-        if (!ids->alert_file) {
-            fprintf(stderr, "Failed to open alert file: %s\n", ids->config.alert_output_file);
-            return -1;
-        }
+// Start the writer thread before scoring begins, from a thread whose CPUs it
+// may inherit. A writer that fails to start is reported once and not retried.
+int start_alert_output(hpc_ids_t *ids) {
+    if (ids->alert_writer.running) return 0;
+    if (ids->alert_output_failed) return -1;
+    if (alert_writer_start(&ids->alert_writer, &ids->config) != 0) {
+        fprintf(stderr, "Warning: alerts will not be written\n");
+        ids->alert_output_failed = true;
+        return -1;
     }
-    
-    // Write alert as JSON line
-    fprintf(ids->alert_file, 
-        "{\"timestamp\":%.0f,\"application_name\":\"%s\",\"baseline_type\":\"%s\","
-        "\"feature\":\"%s\",\"measured_value\":%.6f,\"baseline_median\":%.6f,"
-        "\"robust_z_score\":%.3f,\"threshold\":%.1f,\"severity\":\"%s\"}\n",
-        alert->timestamp, alert->application_name, alert->baseline_type,
-        alert->feature, alert->measured_value, alert->baseline_median,
-        alert->robust_z_score, alert->threshold, alert->severity);
-    
-    fflush(ids->alert_file);
-    
-    // Also log to stderr for real-time monitoring
-    fprintf(stderr, "[%s] %s anomaly in %s: %s=%.6f (baseline=%.6f, z=%.3f)\n",
-            alert->severity, alert->baseline_type, alert->application_name,
-            alert->feature, alert->measured_value, alert->baseline_median,
-            alert->robust_z_score);
-    
     return 0;
-}
\ No newline at end of file
+}
+
+// The writer thread owns all alert I/O
+int log_alert(hpc_ids_t *ids, const anomaly_alert_t *alert) {
+    if (!ids->alert_writer.running) return -1;
+    return alert_writer_push(&ids->alert_writer, alert);
+}
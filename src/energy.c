@@ -0,0 +1,282 @@
+#include "hpc_ids.h"
+
+// Energy counters from the powercap RAPL zones, read with one pread() per
+// zone per sample. Without a readable zone, package power is modeled from
+// the busy fraction of /proc/stat over the same interval.
+
+#ifndef POWERCAP_ROOT
+#define POWERCAP_ROOT "/sys/class/powercap"
+#endif
+
+static int read_u64_at(int fd, uint64_t *value) {
+    char buffer[32];
+    ssize_t n = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) return -1;
+    buffer[n] = '\0';
+    char *end;
+    errno = 0;
+    unsigned long long parsed = strtoull(buffer, &end, 10);
+    if (end == buffer || errno != 0) return -1;
+    *value = parsed;
+    return 0;
+}
+
+static int read_file_line(const char *path, char *buffer, size_t size) {
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    ssize_t n = read(fd, buffer, size - 1);
+    close(fd);
+    if (n <= 0) return -1;
+    buffer[n] = '\0';
+    buffer[strcspn(buffer, "\n")] = '\0';
+    return 0;
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+// Zones are intel-rapl:<package>[:<subzone>] (or another control type with
+// the same layout); sorted, a parent comes before its subzones
+static int discover_domains(energy_meter_t *meter) {
+    DIR *dir = opendir(POWERCAP_ROOT);
+    if (!dir) return 0;
+
+    char (*zones)[64] = malloc(MAX_ENERGY_DOMAINS * 4 * sizeof(*zones));
+    if (!zones) {
+        closedir(dir);
+        return -1;
+    }
+    int num_zones = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && num_zones < MAX_ENERGY_DOMAINS * 4) {
+        if (!strchr(entry->d_name, ':') || strlen(entry->d_name) >= sizeof(zones[0])) continue;
+        strcpy(zones[num_zones++], entry->d_name);
+    }
+    closedir(dir);
+    qsort(zones, num_zones, sizeof(zones[0]), compare_names);
+
+    int denied = 0;
+    for (int z = 0; z < num_zones && meter->num_domains < MAX_ENERGY_DOMAINS; z++) {
+        char path[MAX_PATH_LEN];
+        snprintf(path, sizeof(path), "%s/%s/energy_uj", POWERCAP_ROOT, zones[z]);
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EACCES) denied++;
+            continue;
+        }
+
+        energy_domain_t *domain = &meter->domains[meter->num_domains];
+        memset(domain, 0, sizeof(*domain));
+        domain->fd = fd;
+        if (read_u64_at(fd, &domain->last_uj) != 0) {
+            close(fd);
+            continue;
+        }
+
+        char value[64];
+        snprintf(path, sizeof(path), "%s/%s/max_energy_range_uj", POWERCAP_ROOT, zones[z]);
+        if (read_file_line(path, value, sizeof(value)) == 0) domain->max_range_uj = strtoull(value, NULL, 10);
+
+        char name[32] = "";
+        snprintf(path, sizeof(path), "%s/%s/name", POWERCAP_ROOT, zones[z]);
+        if (read_file_line(path, name, sizeof(name)) != 0) strncpy(name, zones[z], sizeof(name) - 1);
+
+        // Subzone: label it with its parent's name ("package-0:dram"). Only
+        // package zones count towards package power; psys covers the platform.
+        const char *first = strchr(zones[z], ':');
+        const char *second = strchr(first + 1, ':');
+        domain->package = second == NULL && strncmp(name, "package", 7) == 0;
+        if (second) {
+            char parent[64] = "";
+            char parent_zone[64];
+            snprintf(parent_zone, sizeof(parent_zone), "%.*s", (int)(second - zones[z]), zones[z]);
+            snprintf(path, sizeof(path), "%s/%s/name", POWERCAP_ROOT, parent_zone);
+            if (read_file_line(path, parent, sizeof(parent)) != 0) strcpy(parent, parent_zone);
+            snprintf(domain->name, sizeof(domain->name), "%.31s:%.31s", parent, name);
+        } else {
+            snprintf(domain->name, sizeof(domain->name), "%s", name);
+        }
+
+        // Another control type may expose the same zone again (intel-rapl-mmio)
+        for (int d = 0; d < meter->num_domains; d++) {
+            if (strcmp(meter->domains[d].name, domain->name) == 0) {
+                size_t length = strlen(domain->name);
+                snprintf(domain->name + length, sizeof(domain->name) - length, "#%d", meter->num_domains);
+                break;
+            }
+        }
+        meter->num_domains++;
+    }
+    free(zones);
+
+    if (meter->num_domains == 0 && denied > 0) {
+        fprintf(stderr, "Warning: %d RAPL zones are not readable (energy_uj is root-only on most kernels)\n",
+                denied);
+    }
+    return meter->num_domains;
+}
+
+// Busy and total jiffies from the aggregate cpu line
+static int read_cpu_times(int fd, uint64_t *busy, uint64_t *total) {
+    char buffer[256];
+    ssize_t n = pread(fd, buffer, sizeof(buffer) - 1, 0);
+    if (n <= 0) return -1;
+    buffer[n] = '\0';
+    unsigned long long user, nice, system, idle, iowait = 0, irq = 0, softirq = 0, steal = 0;
+    if (sscanf(buffer, "cpu %llu %llu %llu %llu %llu %llu %llu %llu",
+               &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal) < 4) {
+        return -1;
+    }
+    *busy = user + nice + system + irq + softirq + steal;
+    *total = *busy + idle + iowait;
+    return 0;
+}
+
+int energy_meter_open(energy_meter_t *meter, double idle_watts, double max_watts) {
+    memset(meter, 0, sizeof(energy_meter_t));
+    meter->stat_fd = -1;
+    meter->idle_watts = idle_watts;
+    meter->max_watts = max_watts;
+
+    if (discover_domains(meter) < 0) return -1;
+
+    if (meter->num_domains == 0) {
+        meter->stat_fd = open("/proc/stat", O_RDONLY | O_CLOEXEC);
+        if (meter->stat_fd < 0 || read_cpu_times(meter->stat_fd, &meter->last_busy, &meter->last_total) != 0) {
+            fprintf(stderr, "Error: no RAPL zones and /proc/stat unreadable\n");
+            energy_meter_close(meter);
+            return -1;
+        }
+        meter->modeled = true;
+        meter->num_domains = 1;
+        meter->domains[0].fd = -1;
+        meter->domains[0].package = true;
+        strcpy(meter->domains[0].name, "modeled-package");
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &meter->last);
+    return 0;
+}
+
+int energy_meter_sample(energy_meter_t *meter, energy_sample_t *sample) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double interval = (now.tv_sec - meter->last.tv_sec) + (now.tv_nsec - meter->last.tv_nsec) / 1e9;
+    meter->last = now;
+
+    memset(sample, 0, sizeof(energy_sample_t));
+    sample->interval = interval;
+    if (interval <= 0.0) return -1;
+
+    if (meter->modeled) {
+        uint64_t busy, total;
+        if (read_cpu_times(meter->stat_fd, &busy, &total) != 0) return -1;
+        uint64_t delta_total = total - meter->last_total;
+        sample->utilization = delta_total > 0 ? (double)(busy - meter->last_busy) / delta_total : 0.0;
+        meter->last_busy = busy;
+        meter->last_total = total;
+
+        sample->watts[0] = meter->idle_watts + (meter->max_watts - meter->idle_watts) * sample->utilization;
+        sample->joules[0] = sample->watts[0] * interval;
+        sample->package_watts = sample->watts[0];
+        sample->valid_mask = 1;
+        meter->samples++;
+        return 0;
+    }
+
+    int failures = 0;
+    for (int d = 0; d < meter->num_domains; d++) {
+        energy_domain_t *domain = &meter->domains[d];
+        uint64_t current;
+        if (read_u64_at(domain->fd, &current) != 0) {
+            domain->stale = true;
+            failures++;
+            continue;
+        }
+        if (domain->stale) {
+            // The delta would span several intervals; restart from here
+            domain->last_uj = current;
+            domain->stale = false;
+            continue;
+        }
+
+        // The counter restarts at 0 after max_energy_range_uj
+        uint64_t delta;
+        if (current >= domain->last_uj) {
+            delta = current - domain->last_uj;
+        } else {
+            delta = domain->max_range_uj > domain->last_uj ? domain->max_range_uj - domain->last_uj + current : current;
+            meter->wraps++;
+        }
+        domain->last_uj = current;
+
+        sample->joules[d] = delta / 1e6;
+        sample->watts[d] = sample->joules[d] / interval;
+        sample->valid_mask |= 1u << d;
+        if (domain->package) sample->package_watts += sample->watts[d];
+    }
+    if (failures == meter->num_domains) return -1;
+    meter->samples++;
+    return 0;
+}
+
+void energy_meter_close(energy_meter_t *meter) {
+    for (int d = 0; d < meter->num_domains; d++) {
+        if (!meter->modeled && meter->domains[d].fd >= 0) close(meter->domains[d].fd);
+    }
+    if (meter->stat_fd >= 0) close(meter->stat_fd);
+    meter->num_domains = 0;
+    meter->stat_fd = -1;
+}
+
+// Open the meter the configuration asks for. Returns -1 when energy is off
+// or unavailable; intervals then carry no energy features.
+int energy_source_open(energy_meter_t *meter, const config_t *config) {
+    memset(meter, 0, sizeof(energy_meter_t));
+    meter->stat_fd = -1;
+    if (config->energy_source == ENERGY_SOURCE_OFF) return -1;
+    if (energy_meter_open(meter, config->energy_idle_watts, config->energy_max_watts) != 0) return -1;
+    if (meter->modeled && config->energy_source != ENERGY_SOURCE_MODEL) {
+        energy_meter_close(meter);
+        return -1;
+    }
+    return 0;
+}
+
+// Sample the meter at an interval boundary and append the energy spent since
+// the previous one as pseudo-counters, so energy travels with the perf
+// counters through features, traces and replay. The first reading covers
+// perf's start-up rather than an interval and is not reported. measurements
+// must have room for ENERGY_EVENTS more entries. Returns the new count.
+int energy_meter_append(energy_meter_t *meter, hpc_measurement_t *measurements, int count) {
+    energy_sample_t sample;
+    if (count <= 0 || energy_meter_sample(meter, &sample) != 0 || meter->samples == 1) return count;
+
+    double joules[ENERGY_EVENTS] = {0};
+    bool found[ENERGY_EVENTS] = {false};
+    bool missing[ENERGY_EVENTS] = {false};
+    for (int d = 0; d < meter->num_domains; d++) {
+        const char *colon = strrchr(meter->domains[d].name, ':');
+        const char *kind = colon ? colon + 1 : meter->domains[d].name;
+        int e = meter->domains[d].package ? 0 : strcmp(kind, "core") == 0 ? 1 : strcmp(kind, "dram") == 0 ? 2 : -1;
+        if (e < 0) continue;
+        // An unread domain would report 0 J, or only part of a multi-socket sum
+        if (!(sample.valid_mask & (1u << d))) {
+            missing[e] = true;
+            continue;
+        }
+        joules[e] += sample.joules[d];
+        found[e] = true;
+    }
+
+    static const char *const names[ENERGY_EVENTS] = {"energy-pkg", "energy-cores", "energy-ram"};
+    for (int e = 0; e < ENERGY_EVENTS; e++) {
+        if (!found[e] || missing[e]) continue;
+        hpc_measurement_t *m = &measurements[count++];
+        *m = measurements[0];
+        strcpy(m->counter, names[e]);
+        m->value = (uint64_t)llround(joules[e] * 1e6);
+    }
+    return count;
+}
@@ -1,173 +1,213 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <unistd.h>
-#include <string.h>
-#include <time.h>
-#include <errno.h>
-#include <sys/stat.h>
-
-#define MAX_PATH 256
-#define MAX_LINE 1024
-
-typedef struct {
-    double package_energy_uj;
-    double dram_energy_uj;
-    double core_energy_uj;
-    double uncore_energy_uj;
-    time_t timestamp;
-} energy_reading_t;
-
-int read_energy_counter(const char *path, double *value) {
-    FILE *fp = fopen(path, "r");
-    if (!fp) return -1;
-    
-    unsigned long long uj_value;
-    if (fscanf(fp, "%llu", &uj_value) != 1) {
-        fclose(fp);
-        return -1;
-    }
-    
-    *value = (double)uj_value;
-    fclose(fp);
-    return 0;
+#include "hpc_ids.h"
+#include <ctype.h>
+#include <getopt.h>
+#include <sys/timerfd.h>
+
+// Power sampler: a timerfd with absolute deadlines drives the meter, so
+// jitter does not accumulate into drift and a late tick is reported as an
+// overrun rather than silently stretching the interval.
+
+#define DEFAULT_INTERVAL_MS 1000
+#define DEFAULT_IDLE_WATTS 2.0
+#define DEFAULT_MAX_WATTS 15.0
+
+static double realtime_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
 }
 
-int get_energy_reading(energy_reading_t *reading) {
-    reading->timestamp = time(NULL);
-    reading->package_energy_uj = 0;
-    reading->dram_energy_uj = 0;
-    reading->core_energy_uj = 0;
-    reading->uncore_energy_uj = 0;
-    
-    // Try different RAPL interfaces
-    const char *rapl_paths[] = {
-        "/sys/class/powercap/intel-rapl:0/energy_uj",           // Package
-        "/sys/class/powercap/intel-rapl:0:0/energy_uj",        // Core
-        "/sys/class/powercap/intel-rapl:0:1/energy_uj",        // Uncore
-        "/sys/class/powercap/intel-rapl:0:2/energy_uj",        // DRAM
-        NULL
-    };
-    
-    // Try package energy
-    if (read_energy_counter(rapl_paths[0], &reading->package_energy_uj) != 0) {
-        // If RAPL not available, estimate using CPU frequency and utilization
-        FILE *fp = fopen("/proc/stat", "r");
-        if (fp) {
-            char line[MAX_LINE];
-            if (fgets(line, sizeof(line), fp)) {
-                unsigned long user, nice, system, idle;
-                if (sscanf(line, "cpu %lu %lu %lu %lu", &user, &nice, &system, &idle) == 4) {
-                    unsigned long total = user + nice + system + idle;
-                    double cpu_usage = (double)(user + nice + system) / total;
-                    // Rough estimate: 15W TDP * usage percentage
-                    reading->package_energy_uj = cpu_usage * 15.0 * 1000000.0; // Convert to microjoules/second
-                }
-            }
-            fclose(fp);
-        }
-    }
-    
-    // Try core energy
-    read_energy_counter(rapl_paths[1], &reading->core_energy_uj);
-    
-    // Try uncore energy  
-    read_energy_counter(rapl_paths[2], &reading->uncore_energy_uj);
-    
-    // Try DRAM energy
-    read_energy_counter(rapl_paths[3], &reading->dram_energy_uj);
-    
-    return 0;
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Last component of the zone name: "package-0:dram" -> "dram"
+static const char *domain_kind(const energy_domain_t *domain) {
+    const char *colon = strrchr(domain->name, ':');
+    return colon ? colon + 1 : domain->name;
+}
+
+static void write_column_name(FILE *fp, const char *name) {
+    fputc(',', fp);
+    for (const char *c = name; *c; c++) fputc(isalnum((unsigned char)*c) ? *c : '_', fp);
+    fputs("_watts", fp);
 }
 
-double calculate_power_watts(double energy_uj_start, double energy_uj_end, double time_seconds) {
-    if (time_seconds <= 0) return 0.0;
-    
-    double energy_joules = (energy_uj_end - energy_uj_start) / 1000000.0;
-    return energy_joules / time_seconds;
+void print_usage(const char *program_name) {
+    printf("Usage: %s [OPTIONS] <output_file> <duration_seconds>\n", program_name);
+    printf("Sample RAPL package and domain power to CSV\n\n");
+    printf("Options:\n");
+    printf("  -i, --interval-ms MS   Sampling period (default: %d)\n", DEFAULT_INTERVAL_MS);
+    printf("  --idle-watts W         Modeled power at 0%% utilization when RAPL is unavailable (default: %.1f)\n",
+           DEFAULT_IDLE_WATTS);
+    printf("  --max-watts W          Modeled power at 100%% utilization (default: %.1f)\n", DEFAULT_MAX_WATTS);
+    printf("  -h, --help             Show this help message\n");
+    printf("\nExamples:\n");
+    printf("  %s energy.csv 60\n", program_name);
+    printf("  %s --interval-ms 100 energy.csv 10\n", program_name);
 }
 
 int main(int argc, char *argv[]) {
-    if (argc < 3) {
-        fprintf(stderr, "Usage: %s <output_file> <duration_seconds>\n", argv[0]);
+    int opt;
+    int interval_ms = DEFAULT_INTERVAL_MS;
+    double idle_watts = DEFAULT_IDLE_WATTS;
+    double max_watts = DEFAULT_MAX_WATTS;
+
+    static struct option long_options[] = {
+        {"interval-ms", required_argument, 0, 'i'},
+        {"idle-watts",  required_argument, 0, 1000},
+        {"max-watts",   required_argument, 0, 1001},
+        {"help",        no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "i:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'i':
+                interval_ms = atoi(optarg);
+                break;
+            case 1000: // --idle-watts
+                idle_watts = atof(optarg);
+                break;
+            case 1001: // --max-watts
+                max_watts = atof(optarg);
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (argc - optind < 2) {
+        print_usage(argv[0]);
         return 1;
     }
-    
-    const char *output_file = argv[1];
-    int duration = atoi(argv[2]);
-    
+
+    const char *output_file = argv[optind];
+    double duration = atof(argv[optind + 1]);
+
     if (duration <= 0) {
         fprintf(stderr, "Error: Duration must be positive\n");
         return 1;
     }
-    
+    if (interval_ms <= 0 || max_watts < idle_watts) {
+        fprintf(stderr, "Error: Invalid interval or power model\n");
+        return 1;
+    }
+
+    energy_meter_t meter;
+    if (energy_meter_open(&meter, idle_watts, max_watts) != 0) {
+        fprintf(stderr, "Error: Cannot read energy counters\n");
+        return 1;
+    }
+
     FILE *fp = fopen(output_file, "w");
     if (!fp) {
         fprintf(stderr, "Error: Cannot open output file %s: %s\n", output_file, strerror(errno));
+        energy_meter_close(&meter);
         return 1;
     }
-    
-    // Write CSV header
-    fprintf(fp, "timestamp,package_power_watts,core_power_watts,dram_power_watts,uncore_power_watts\n");
-    
-    energy_reading_t prev_reading, curr_reading;
-    
-    // Get initial reading
-    if (get_energy_reading(&prev_reading) != 0) {
-        fprintf(stderr, "Error: Cannot read energy counters\n");
+
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    if (tfd < 0) {
+        perror("timerfd_create");
         fclose(fp);
+        energy_meter_close(&meter);
         return 1;
     }
-    
-    printf("Starting energy monitoring for %d seconds...\\n", duration);
-    
-    time_t start_time = time(NULL);
-    
-    while ((time(NULL) - start_time) < duration) {
-        sleep(1);
-        
-        if (get_energy_reading(&curr_reading) != 0) {
-            fprintf(stderr, "Warning: Failed to read energy counters\\n");
+
+    // The first columns keep the layout earlier scripts read; one column per
+    // discovered zone follows
+    fprintf(fp, "timestamp,interval_s,package_power_watts,core_power_watts,dram_power_watts,uncore_power_watts");
+    for (int d = 0; d < meter.num_domains; d++) write_column_name(fp, meter.domains[d].name);
+    if (meter.modeled) fprintf(fp, ",utilization");
+    fprintf(fp, "\n");
+
+    printf("Starting energy monitoring for %.1f seconds every %d ms from %s\n", duration, interval_ms,
+           meter.modeled ? "a /proc/stat utilization model" : "RAPL");
+    for (int d = 0; d < meter.num_domains && !meter.modeled; d++) {
+        printf("  %s (wraps at %.1f J)\n", meter.domains[d].name, meter.domains[d].max_range_uj / 1e6);
+    }
+
+    // Absolute deadlines start + k * period: a slow write delays one sample
+    // but not every later one
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    struct itimerspec timer;
+    timer.it_interval.tv_sec = interval_ms / 1000;
+    timer.it_interval.tv_nsec = (long)(interval_ms % 1000) * 1000000L;
+    timer.it_value = start;
+    timer.it_value.tv_sec += timer.it_interval.tv_sec;
+    timer.it_value.tv_nsec += timer.it_interval.tv_nsec;
+    if (timer.it_value.tv_nsec >= 1000000000L) {
+        timer.it_value.tv_sec++;
+        timer.it_value.tv_nsec -= 1000000000L;
+    }
+    if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &timer, NULL) != 0) {
+        perror("timerfd_settime");
+        close(tfd);
+        fclose(fp);
+        energy_meter_close(&meter);
+        return 1;
+    }
+
+    long samples = (long)(duration * 1000.0 / interval_ms + 0.5);
+    uint64_t overruns = 0;
+    long written = 0;
+    double sample_cost = 0.0;
+
+    for (long n = 0; n < samples; n++) {
+        uint64_t expirations;
+        if (read(tfd, &expirations, sizeof(expirations)) != sizeof(expirations)) {
+            if (errno == EINTR) {
+                n--;
+                continue;
+            }
+            perror("read timerfd");
+            break;
+        }
+        if (expirations > 1) {
+            overruns += expirations - 1;
+            n += (long)(expirations - 1);
+        }
+
+        double before = monotonic_seconds();
+        energy_sample_t sample;
+        if (energy_meter_sample(&meter, &sample) != 0) {
+            fprintf(stderr, "Warning: Failed to read energy counters\n");
             continue;
         }
-        
-        double time_diff = difftime(curr_reading.timestamp, prev_reading.timestamp);
-        
-        if (time_diff > 0) {
-            double package_power = calculate_power_watts(
-                prev_reading.package_energy_uj, 
-                curr_reading.package_energy_uj, 
-                time_diff
-            );
-            
-            double core_power = calculate_power_watts(
-                prev_reading.core_energy_uj, 
-                curr_reading.core_energy_uj, 
-                time_diff
-            );
-            
-            double dram_power = calculate_power_watts(
-                prev_reading.dram_energy_uj, 
-                curr_reading.dram_energy_uj, 
-                time_diff
-            );
-            
-            double uncore_power = calculate_power_watts(
-                prev_reading.uncore_energy_uj, 
-                curr_reading.uncore_energy_uj, 
-                time_diff
-            );
-            
-            fprintf(fp, "%ld,%.3f,%.3f,%.3f,%.3f\n", 
-                    curr_reading.timestamp, package_power, core_power, dram_power, uncore_power);
-            
-            fflush(fp);
+        sample_cost += monotonic_seconds() - before;
+
+        double core = 0.0, dram = 0.0, uncore = 0.0;
+        for (int d = 0; d < meter.num_domains; d++) {
+            const char *kind = domain_kind(&meter.domains[d]);
+            if (strcmp(kind, "core") == 0) core += sample.watts[d];
+            else if (strcmp(kind, "dram") == 0) dram += sample.watts[d];
+            else if (strcmp(kind, "uncore") == 0) uncore += sample.watts[d];
         }
-        
-        prev_reading = curr_reading;
+
+        fprintf(fp, "%.6f,%.6f,%.3f,%.3f,%.3f,%.3f", realtime_seconds(), sample.interval,
+                sample.package_watts, core, dram, uncore);
+        for (int d = 0; d < meter.num_domains; d++) fprintf(fp, ",%.3f", sample.watts[d]);
+        if (meter.modeled) fprintf(fp, ",%.4f", sample.utilization);
+        fprintf(fp, "\n");
+        fflush(fp);
+        written++;
     }
-    
+
+    close(tfd);
     fclose(fp);
-    printf("Energy monitoring completed. Results saved to %s\\n", output_file);
-    
+    printf("Energy monitoring completed: %ld samples, %lu missed ticks, %lu counter wraps, "
+           "%.1f us per sample. Results saved to %s\n",
+           written, (unsigned long)overruns, (unsigned long)meter.wraps,
+           written > 0 ? sample_cost / written * 1e6 : 0.0, output_file);
+    energy_meter_close(&meter);
+
     return 0;
 }
@@ -0,0 +1,491 @@
+#include "hpc_ids.h"
+#include <getopt.h>
+
+// Time-to-detect benchmark. Recordings of a workload with a known anomaly
+// onset (live under perf, or earlier recordings replayed) are scored at
+// several sampling intervals and detector thresholds. Counts are additive,
+// so a coarser interval is simulated by summing consecutive fine intervals;
+// every phase of that window against the onset is one trial.
+
+#define MAX_RECORDINGS 64
+#define MAX_SWEEP 16
+#define DEFAULT_FINE_MS 100
+
+typedef struct {
+    char path[MAX_PATH_LEN];
+    double onset;             // anomaly start, seconds on the recording's perf time axis
+    double end;               // anomaly end, INFINITY if it runs to the end
+    double interval;          // recorded sampling interval, seconds
+    int intervals;
+    int capacity;
+    int *counts;
+    hpc_measurement_t (*rows)[MAX_EVENTS];
+} recording_t;
+
+typedef struct {
+    int interval_ms;
+    double threshold;
+    int trials;
+    int detected;
+    int false_alerts;
+    double clean_seconds;     // scored time before the onset, for the false-alert rate
+    double *latencies;        // seconds, one per detected trial
+} sweep_result_t;
+
+static int append_interval(void *context, hpc_measurement_t *measurements, int count) {
+    recording_t *rec = context;
+    if (rec->intervals == rec->capacity) {
+        int capacity = rec->capacity ? rec->capacity * 2 : 1024;
+        int *counts = realloc(rec->counts, capacity * sizeof(int));
+        if (!counts) return -1;
+        rec->counts = counts;
+        hpc_measurement_t (*rows)[MAX_EVENTS] = realloc(rec->rows, capacity * sizeof(*rec->rows));
+        if (!rows) return -1;
+        rec->rows = rows;
+        rec->capacity = capacity;
+    }
+    if (count > MAX_EVENTS) count = MAX_EVENTS;
+    memcpy(rec->rows[rec->intervals], measurements, count * sizeof(hpc_measurement_t));
+    rec->counts[rec->intervals++] = count;
+    return 0;
+}
+
+static int compare_doubles(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int load_recording(recording_t *rec) {
+    if (stream_perf_file(rec->path, append_interval, rec) < 0 || rec->intervals < 2) {
+        fprintf(stderr, "No intervals in %s\n", rec->path);
+        return -1;
+    }
+
+    // Median spacing, robust to a late first interval
+    double *gaps = malloc((rec->intervals - 1) * sizeof(double));
+    if (!gaps) return -1;
+    for (int i = 1; i < rec->intervals; i++) {
+        gaps[i - 1] = rec->rows[i][0].perf_time - rec->rows[i - 1][0].perf_time;
+    }
+    qsort(gaps, rec->intervals - 1, sizeof(double), compare_doubles);
+    rec->interval = gaps[(rec->intervals - 1) / 2];
+    free(gaps);
+    return rec->interval > 0 ? 0 : -1;
+}
+
+static void free_recording(recording_t *rec) {
+    free(rec->counts);
+    free(rec->rows);
+    rec->counts = NULL;
+    rec->rows = NULL;
+}
+
+// Onset and end of the first injection in a test_workload --log file,
+// relative to its exec event (where perf started counting)
+static int read_event_log(const char *path, double *onset, double *end) {
+    FILE *file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Cannot open event log %s\n", path);
+        return -1;
+    }
+    double exec = NAN, start = NAN, stop = INFINITY;
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        json_doc_t doc;
+        if (json_parse(&doc, line, strlen(line)) != 0) continue;
+        char event[32] = "";
+        double monotonic;
+        if (json_get_string(&doc, 0, "event", event, sizeof(event)) == 0 &&
+            json_get_double(&doc, 0, "monotonic", &monotonic) == 0) {
+            if (strcmp(event, "exec") == 0) exec = monotonic;
+            else if (strcmp(event, "inject_start") == 0 && isnan(start)) start = monotonic;
+            else if (strcmp(event, "inject_end") == 0 && !isnan(start) && isinf(stop)) stop = monotonic;
+        }
+        json_free(&doc);
+    }
+    fclose(file);
+
+    if (isnan(exec) || isnan(start)) {
+        fprintf(stderr, "No exec and inject_start events in %s\n", path);
+        return -1;
+    }
+    *onset = start - exec;
+    *end = stop - exec;
+    return 0;
+}
+
+// FILE@ONSET[:END], times in seconds on the recording's perf time axis
+static int parse_replay_spec(const char *spec, recording_t *rec) {
+    memset(rec, 0, sizeof(*rec));
+    rec->end = INFINITY;
+    const char *at = strrchr(spec, '@');
+    if (!at || at == spec || (size_t)(at - spec) >= sizeof(rec->path)) {
+        fprintf(stderr, "Expected FILE@ONSET[:END], got %s\n", spec);
+        return -1;
+    }
+    memcpy(rec->path, spec, at - spec);
+    char *colon;
+    rec->onset = strtod(at + 1, &colon);
+    if (*colon == ':') rec->end = atof(colon + 1);
+    if (rec->onset < 0 || rec->end <= rec->onset) {
+        fprintf(stderr, "Invalid onset or end in %s\n", spec);
+        return -1;
+    }
+    return 0;
+}
+
+// Run the workload under perf at the fine interval, keeping only the
+// counter lines, with --log appended so the injection can be located
+static int record_workload(const config_t *config, char **argv, int fine_ms, const char *path,
+                           const char *log_path) {
+    char target[1024] = "";
+    for (int i = 0; argv[i]; i++) {
+        if (strlen(target) + strlen(argv[i]) + 2 >= sizeof(target) - MAX_PATH_LEN - 8) return -1;
+        if (i > 0) strcat(target, " ");
+        strcat(target, argv[i]);
+    }
+    strcat(target, " --log ");
+    strcat(target, log_path);
+
+    config_t fine = *config;
+    fine.sampling_interval_ms = fine_ms;
+    char cmd[2048];
+    if (build_perf_command(&fine, target, cmd, sizeof(cmd)) != 0) return -1;
+
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Cannot write recording %s\n", path);
+        return -1;
+    }
+    FILE *perf = popen(cmd, "r");
+    if (!perf) {
+        fclose(out);
+        return -1;
+    }
+    char line[1024];
+    int lines = 0;
+    hpc_measurement_t m;
+    while (fgets(line, sizeof(line), perf)) {
+        if (parse_perf_line(line, 0.0, &m) == 0) {
+            fputs(line, out);
+            lines++;
+        }
+    }
+    int status = pclose(perf);
+    fclose(out);
+    if (lines == 0) {
+        fprintf(stderr, "perf produced no counters (exit %d); without a PMU use --replay\n",
+                WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        return -1;
+    }
+    return 0;
+}
+
+// One trial: score windows of `span` fine intervals starting at `offset`
+// with a fresh target, so cooldowns and aggregation start clean
+static void run_trial(hpc_ids_t *ids, const char *app_name, const recording_t *rec, int span, int offset,
+                      int min_counters, sweep_result_t *result) {
+    target_state_t target;
+    attach_target(ids, &target, app_name, 0);
+    double window = span * rec->interval;
+
+    result->trials++;
+    for (int first = offset; first + span <= rec->intervals; first += span) {
+        hpc_measurement_t sum[MAX_EVENTS];
+        int count = rec->counts[first + span - 1];
+        memcpy(sum, rec->rows[first + span - 1], count * sizeof(hpc_measurement_t));
+        for (int e = 0; e < count; e++) {
+            sum[e].value = 0;
+            for (int k = first; k < first + span; k++) {
+                if (e < rec->counts[k] && strcmp(rec->rows[k][e].counter, sum[e].counter) == 0) {
+                    sum[e].value += rec->rows[k][e].value;
+                }
+            }
+        }
+
+        double end_time = sum[0].perf_time;
+        double start_time = end_time - window;
+        if (start_time >= rec->end) break;     // anomaly over without detection: a miss
+
+        feature_vector_t features;
+        if (count < min_counters || engineer_features(sum, count, &features) != 0) continue;
+        features.wall_time = end_time;
+        int anomalies = detect_anomalies(ids, &target, &features);
+
+        if (end_time <= rec->onset) {
+            result->clean_seconds += window;
+            if (anomalies > 0) result->false_alerts++;
+        } else if (anomalies > 0) {
+            // The window closing at end_time is the earliest the IDS can flag it
+            result->latencies[result->detected++] = end_time - rec->onset;
+            break;
+        }
+    }
+
+    flush_target_alerts(ids, &target);
+    detach_target(ids, &target);
+}
+
+static int parse_list(const char *text, double *values, int max_values) {
+    int n = 0;
+    const char *cursor = text;
+    while (*cursor && n < max_values) {
+        char *end;
+        values[n] = strtod(cursor, &end);
+        if (end == cursor || values[n] <= 0) return -1;
+        n++;
+        if (*end != ',' && *end != '\0') return -1;
+        cursor = *end ? end + 1 : end;
+    }
+    return n;
+}
+
+static double percentile(const double *sorted, int n, double p) {
+    if (n == 0) return NAN;
+    int rank = (int)ceil(p * n) - 1;
+    if (rank < 0) rank = 0;
+    if (rank >= n) rank = n - 1;
+    return sorted[rank];
+}
+
+void print_usage(const char *program_name) {
+    printf("Usage: %s [OPTIONS] [-- WORKLOAD [ARGS...]]\n", program_name);
+    printf("Measure time-to-detect and miss rate across sampling intervals and thresholds\n\n");
+    printf("Options:\n");
+    printf("  -c, --config FILE      Configuration file path (default: config/rigorous_hpc_config.json)\n");
+    printf("  -a, --app-name NAME    Score against NAME's baseline (default: global baseline)\n");
+    printf("  -r, --replay FILE@ONSET[:END]\n");
+    printf("                         Use a perf recording or counter trace whose anomaly starts at ONSET\n");
+    printf("                         (and ends at END) seconds; repeatable. Needs no PMU\n");
+    printf("  -n, --runs N           Record the workload N times under perf (default: 1)\n");
+    printf("  -f, --fine-ms MS       Recording interval for live runs (default: %d)\n", DEFAULT_FINE_MS);
+    printf("  -k, --keep DIR         Keep live recordings and event logs in DIR for later --replay\n");
+    printf("  -i, --intervals LIST   Sampling intervals in ms to evaluate (default: 1, 2, 5 and 10 x recorded)\n");
+    printf("  -t, --thresholds LIST  Medium z thresholds to evaluate (default: from config)\n");
+    printf("  -j, --json FILE        Write results as JSON\n");
+    printf("  -h, --help             Show this help message\n");
+    printf("\nThe workload must accept --log FILE and log exec and inject_start events like test_workload.\n");
+    printf("\nExamples:\n");
+    printf("  %s -c config.json -n 5 -- ./test_workload -p mixed:30 -d 30 -i pointer_chase@15:10\n", program_name);
+    printf("  %s -c config.json -r run1.csv@15.02:25.02 -i 100,200,500,1000 -t 3,4,5\n", program_name);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    const char *config_file = "config/rigorous_hpc_config.json";
+    const char *app_name = NULL;
+    const char *json_file = NULL;
+    const char *keep_dir = NULL;
+    const char *interval_list = NULL;
+    const char *threshold_list = NULL;
+    int runs = 1;
+    int fine_ms = DEFAULT_FINE_MS;
+
+    recording_t *recordings = calloc(MAX_RECORDINGS, sizeof(recording_t));
+    if (!recordings) return 1;
+    int num_recordings = 0;
+
+    static struct option long_options[] = {
+        {"config",     required_argument, 0, 'c'},
+        {"app-name",   required_argument, 0, 'a'},
+        {"replay",     required_argument, 0, 'r'},
+        {"runs",       required_argument, 0, 'n'},
+        {"fine-ms",    required_argument, 0, 'f'},
+        {"keep",       required_argument, 0, 'k'},
+        {"intervals",  required_argument, 0, 'i'},
+        {"thresholds", required_argument, 0, 't'},
+        {"json",       required_argument, 0, 'j'},
+        {"help",       no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "+c:a:r:n:f:k:i:t:j:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'c': config_file = optarg; break;
+            case 'a': app_name = optarg; break;
+            case 'r':
+                if (num_recordings >= MAX_RECORDINGS ||
+                    parse_replay_spec(optarg, &recordings[num_recordings]) != 0) {
+                    return 1;
+                }
+                num_recordings++;
+                break;
+            case 'n': runs = atoi(optarg); break;
+            case 'f': fine_ms = atoi(optarg); break;
+            case 'k': keep_dir = optarg; break;
+            case 'i': interval_list = optarg; break;
+            case 't': threshold_list = optarg; break;
+            case 'j': json_file = optarg; break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    bool live = optind < argc;
+    if (!live && num_recordings == 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (runs < 1 || fine_ms <= 0 || (live && num_recordings + runs > MAX_RECORDINGS)) {
+        fprintf(stderr, "Invalid run parameters\n");
+        return 1;
+    }
+
+    hpc_ids_t *ids = malloc(sizeof(hpc_ids_t));
+    if (!ids || hpc_ids_init(ids, config_file) != 0) {
+        fprintf(stderr, "Failed to initialize HPC-IDS\n");
+        return 1;
+    }
+    // Alerts only matter as detections here
+    strcpy(ids->config.alert_output_file, "/dev/null");
+    ids->config.alert_format = ALERT_FORMAT_JSONL;
+    ids->config.alert_echo_stderr = false;
+    ids->config.alert_queue_blocking = true;
+    start_alert_output(ids);
+    int min_counters = app_name ? ids->config.num_events : 3;
+
+    char scratch[] = "/tmp/hpc_ids_latency_XXXXXX";
+    if (live && !keep_dir && !mkdtemp(scratch)) {
+        perror("mkdtemp");
+        return 1;
+    }
+    for (int r = 0; live && r < runs; r++) {
+        recording_t *rec = &recordings[num_recordings];
+        memset(rec, 0, sizeof(*rec));
+        char log_path[MAX_PATH_LEN + 32];
+        snprintf(rec->path, sizeof(rec->path), "%s/run%d.csv", keep_dir ? keep_dir : scratch, r + 1);
+        snprintf(log_path, sizeof(log_path), "%s/run%d.events.jsonl", keep_dir ? keep_dir : scratch, r + 1);
+        printf("Recording run %d/%d at %d ms...\n", r + 1, runs, fine_ms);
+        fflush(stdout);
+        if (record_workload(&ids->config, &argv[optind], fine_ms, rec->path, log_path) != 0 ||
+            read_event_log(log_path, &rec->onset, &rec->end) != 0) {
+            return 1;
+        }
+        printf("  %s: anomaly from %.3f s to %.3f s (replay with -r %s@%.3f:%.3f)\n", rec->path,
+               rec->onset, rec->end, rec->path, rec->onset, rec->end);
+        if (!keep_dir) {
+            unlink(log_path);
+        }
+        num_recordings++;
+    }
+
+    int total_intervals = 0;
+    double base_interval = 0.0;
+    for (int i = 0; i < num_recordings; i++) {
+        if (load_recording(&recordings[i]) != 0) return 1;
+        if (live && !keep_dir) unlink(recordings[i].path);
+        if (base_interval == 0.0 || recordings[i].interval > base_interval) base_interval = recordings[i].interval;
+        total_intervals += recordings[i].intervals;
+    }
+    if (live && !keep_dir) rmdir(scratch);
+
+    double intervals_ms[MAX_SWEEP], thresholds[MAX_SWEEP];
+    int num_intervals, num_thresholds;
+    if (interval_list) {
+        num_intervals = parse_list(interval_list, intervals_ms, MAX_SWEEP);
+    } else {
+        static const int multiples[] = {1, 2, 5, 10};
+        num_intervals = 4;
+        for (int i = 0; i < 4; i++) intervals_ms[i] = multiples[i] * base_interval * 1000.0;
+    }
+    if (threshold_list) {
+        num_thresholds = parse_list(threshold_list, thresholds, MAX_SWEEP);
+    } else {
+        thresholds[0] = ids->config.robust_z_threshold_medium;
+        num_thresholds = 1;
+    }
+    if (num_intervals <= 0 || num_thresholds <= 0) {
+        fprintf(stderr, "Invalid interval or threshold list\n");
+        return 1;
+    }
+
+    double high = ids->config.robust_z_threshold_high;
+    double critical = ids->config.robust_z_threshold_critical;
+    sweep_result_t results[MAX_SWEEP * MAX_SWEEP];
+    int num_results = 0;
+
+    printf("\n%d recording(s), %d intervals at %.0f ms\n\n", num_recordings, total_intervals,
+           base_interval * 1000.0);
+    printf("%11s %9s %6s %6s %7s  %9s %9s %9s %9s  %11s\n", "interval_ms", "threshold", "trials",
+           "missed", "miss%", "p50_ms", "p90_ms", "p99_ms", "max_ms", "false/hour");
+
+    for (int ii = 0; ii < num_intervals; ii++) {
+        for (int ti = 0; ti < num_thresholds; ti++) {
+            sweep_result_t *result = &results[num_results];
+            memset(result, 0, sizeof(*result));
+            result->interval_ms = (int)lround(intervals_ms[ii]);
+            result->threshold = thresholds[ti];
+
+            ids->config.robust_z_threshold_medium = thresholds[ti];
+            ids->config.robust_z_threshold_high = fmax(high, thresholds[ti]);
+            ids->config.robust_z_threshold_critical = fmax(critical, thresholds[ti]);
+
+            int max_trials = 0;
+            for (int r = 0; r < num_recordings; r++) {
+                max_trials += (int)lround(intervals_ms[ii] / 1000.0 / recordings[r].interval);
+            }
+            result->latencies = malloc((max_trials + 1) * sizeof(double));
+            if (!result->latencies) return 1;
+
+            for (int r = 0; r < num_recordings; r++) {
+                const recording_t *rec = &recordings[r];
+                double ratio = intervals_ms[ii] / 1000.0 / rec->interval;
+                int span = (int)lround(ratio);
+                if (span < 1 || fabs(ratio - span) > 0.01 * span) {
+                    fprintf(stderr, "Skipping %s for %d ms: not a multiple of its %.0f ms interval\n",
+                            rec->path, result->interval_ms, rec->interval * 1000.0);
+                    continue;
+                }
+                for (int offset = 0; offset < span; offset++) {
+                    run_trial(ids, app_name, rec, span, offset, min_counters, result);
+                }
+            }
+            num_results++;
+
+            qsort(result->latencies, result->detected, sizeof(double), compare_doubles);
+            int missed = result->trials - result->detected;
+            printf("%11d %9.2f %6d %6d %6.1f%%  %9.1f %9.1f %9.1f %9.1f  %11.1f\n", result->interval_ms,
+                   result->threshold, result->trials, missed,
+                   result->trials ? 100.0 * missed / result->trials : 0.0,
+                   percentile(result->latencies, result->detected, 0.50) * 1000.0,
+                   percentile(result->latencies, result->detected, 0.90) * 1000.0,
+                   percentile(result->latencies, result->detected, 0.99) * 1000.0,
+                   percentile(result->latencies, result->detected, 1.00) * 1000.0,
+                   result->clean_seconds > 0 ? result->false_alerts * 3600.0 / result->clean_seconds : 0.0);
+        }
+    }
+
+    if (json_file) {
+        FILE *out = fopen(json_file, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open output file: %s\n", json_file);
+        } else {
+            fprintf(out, "{\n  \"recordings\": %d,\n  \"results\": [\n", num_recordings);
+            for (int i = 0; i < num_results; i++) {
+                const sweep_result_t *r = &results[i];
+                fprintf(out, "    {\"interval_ms\": %d, \"threshold\": %.3f, \"trials\": %d, \"detected\": %d, "
+                             "\"miss_rate\": %.4f, \"false_alerts_per_hour\": %.3f, \"latency_ms\": [",
+                        r->interval_ms, r->threshold, r->trials, r->detected,
+                        r->trials ? (double)(r->trials - r->detected) / r->trials : 0.0,
+                        r->clean_seconds > 0 ? r->false_alerts * 3600.0 / r->clean_seconds : 0.0);
+                for (int k = 0; k < r->detected; k++) {
+                    fprintf(out, "%s%.3f", k ? ", " : "", r->latencies[k] * 1000.0);
+                }
+                fprintf(out, "]}%s\n", i < num_results - 1 ? "," : "");
+            }
+            fprintf(out, "  ]\n}\n");
+            fclose(out);
+        }
+    }
+
+    for (int i = 0; i < num_results; i++) free(results[i].latencies);
+    for (int i = 0; i < num_recordings; i++) free_recording(&recordings[i]);
+    free(recordings);
+    hpc_ids_cleanup(ids);
+    free(ids);
+    return 0;
+}
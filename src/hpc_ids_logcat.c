@@ -0,0 +1,88 @@
+#include "hpc_ids.h"
+#include <getopt.h>
+
+void print_usage(const char *program_name) {
+    printf("Usage: %s [OPTIONS] LOG_FILE\n", program_name);
+    printf("Convert a binary HPC-IDS alert log to alerts.jsonl format\n\n");
+    printf("Options:\n");
+    printf("  -o, --output FILE      Write JSONL to FILE instead of stdout\n");
+    printf("  -s, --stats            Print record and size statistics to stderr\n");
+    printf("  -h, --help             Show this help message\n");
+    printf("\nExamples:\n");
+    printf("  %s alerts.hal > alerts.jsonl\n", program_name);
+    printf("  %s --output alerts.jsonl --stats alerts.hal\n", program_name);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    const char *output_file = NULL;
+    bool stats = false;
+    
+    static struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"stats",  no_argument,       0, 's'},
+        {"help",   no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+    
+    while ((opt = getopt_long(argc, argv, "o:sh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'o':
+                output_file = optarg;
+                break;
+            case 's':
+                stats = true;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+    
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    
+    alert_log_reader_t reader;
+    if (alert_log_reader_open(&reader, argv[optind]) != 0) {
+        return 1;
+    }
+    
+    FILE *out = stdout;
+    if (output_file) {
+        out = fopen(output_file, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open output file: %s\n", output_file);
+            alert_log_reader_close(&reader);
+            return 1;
+        }
+    }
+    
+    char line[ALERT_LINE_LEN];
+    size_t json_bytes = 0;
+    alert_log_record_t record;
+    anomaly_alert_t alert;
+    
+    for (size_t i = 0; i < reader.record_count; i++) {
+        alert_log_read(&reader, i, &record);
+        if (record.timestamp_ns == 0) break; // unused preallocated space
+        alert_log_to_alert(&reader, &record, &alert);
+        int len = format_alert_json(&alert, line, sizeof(line));
+        fwrite(line, 1, len, out);
+        json_bytes += len;
+    }
+    
+    if (stats) {
+        fprintf(stderr, "%zu records, %zu bytes binary, %zu bytes JSONL (%.1fx), %u strings\n",
+                reader.record_count, reader.size, json_bytes,
+                reader.size ? (double)json_bytes / reader.size : 0.0, reader.num_strings);
+    }
+    
+    if (out != stdout) fclose(out);
+    alert_log_reader_close(&reader);
+    return 0;
+}
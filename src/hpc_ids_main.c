@@ -18,6 +18,9 @@ void print_usage(const char *program_name) {
     printf("  -c, --config FILE      Configuration file path (default: config/rigorous_hpc_config.json)\n");
     printf("  -b, --collect-baseline Collect baseline for all applications\n");
     printf("  --collect-app APP      Collect baseline for specific application\n");
+    printf("  --replay FILE          Score a recorded perf stat -x , stream (- for stdin)\n");
+    printf("  --realtime             Replay with the recording's original timing\n");
+    printf("  --replay-epoch SECS    Date replayed alerts from SECS (Unix time, or now; default 0)\n");
     printf("  -h, --help             Show this help message\n");
     printf("\nExamples:\n");
     printf("  %s --monitor --duration 30                 # System-wide monitoring for 30 seconds\n", program_name);
@@ -25,6 +28,7 @@ void print_usage(const char *program_name) {
     printf("  %s --monitor --app-name matmul             # Monitor matmul application\n", program_name);
     printf("  %s --collect-baseline                      # Collect baselines for all apps\n", program_name);
     printf("  %s --collect-app crypto                    # Collect baseline for crypto app\n", program_name);
+    printf("  %s --replay run.csv --app-name matmul      # Score a recording against matmul's baseline\n", program_name);
 }
 
 int main(int argc, char *argv[]) {
@@ -35,6 +39,9 @@ int main(int argc, char *argv[]) {
     pid_t target_pid = 0;
     char *app_name = NULL;
     char *collect_app = NULL;
+    char *replay_file = NULL;
+    bool realtime = false;
+    double replay_epoch = -1;
     char *config_file = "config/rigorous_hpc_config.json";
     int duration = 60;
     
@@ -46,6 +53,9 @@ int main(int argc, char *argv[]) {
         {"config",           required_argument, 0, 'c'},
         {"collect-baseline", no_argument,       0, 'b'},
         {"collect-app",      required_argument, 0, 1000},
+        {"replay",           required_argument, 0, 1001},
+        {"realtime",         no_argument,       0, 1002},
+        {"replay-epoch",     required_argument, 0, 1003},
         {"help",             no_argument,       0, 'h'},
         {0, 0, 0, 0}
     };
@@ -77,6 +87,27 @@ int main(int argc, char *argv[]) {
             case 1000: // --collect-app
                 collect_app = optarg;
                 break;
+            case 1001: // --replay
+                replay_file = optarg;
+                break;
+            case 1002: // --realtime
+                realtime = true;
+                break;
+            case 1003: { // --replay-epoch
+                if (strcmp(optarg, "now") == 0) {
+                    struct timespec now;
+                    clock_gettime(CLOCK_REALTIME, &now);
+                    replay_epoch = now.tv_sec + now.tv_nsec / 1e9;
+                    break;
+                }
+                char *end;
+                replay_epoch = strtod(optarg, &end);
+                if (end == optarg || *end || replay_epoch < 0) {
+                    fprintf(stderr, "--replay-epoch takes Unix seconds or now\n");
+                    return 1;
+                }
+                break;
+            }
             case 'h':
                 print_usage(argv[0]);
                 return 0;
@@ -102,6 +133,16 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    if (replay_file && (monitor_mode || collect_mode || collect_app || target_pid > 0)) {
+        fprintf(stderr, "--replay cannot be combined with monitoring, collection or a PID\n");
+        return 1;
+    }
+    
+    if ((realtime || replay_epoch >= 0) && !replay_file) {
+        fprintf(stderr, "--realtime and --replay-epoch require --replay\n");
+        return 1;
+    }
+    
     if (target_pid > 0 && app_name) {
         fprintf(stderr, "Cannot specify both PID and application name\n");
         return 1;
@@ -113,6 +154,11 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    // Live view for hpc_ids_top; baseline collection is not published
+    if ((monitor_mode || replay_file) && ids.config.telemetry_shm[0]) {
+        telemetry_open(&ids.telemetry, ids.config.telemetry_shm);
+    }
+    
     // Signal handler for graceful shutdown
     signal(SIGINT, SIG_DFL);
     signal(SIGTERM, SIG_DFL);
@@ -136,6 +182,19 @@ int main(int argc, char *argv[]) {
             printf("Monitoring failed\n");
         }
         
+    } else if (replay_file) {
+        printf("=== HPC-IDS REPLAY MODE ===\n");
+        
+        result = replay_perf_recording(&ids, replay_file, app_name, realtime,
+                                       replay_epoch >= 0 ? replay_epoch : 0);
+        
+        if (result == 0) {
+            printf("Replay completed successfully\n");
+        } else {
+            printf("Replay failed\n");
+            result = 1;
+        }
+        
     } else if (collect_mode) {
         printf("=== COLLECTING BASELINES FOR ALL APPLICATIONS ===\n");
         
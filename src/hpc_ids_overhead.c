@@ -0,0 +1,421 @@
+#include "hpc_ids.h"
+#include <getopt.h>
+#include <sys/ptrace.h>
+#include <sys/resource.h>
+#include <stddef.h>
+
+// Runs a target repeatedly with and without hpc_ids attached, in shuffled
+// order, and reports the slowdown and the IDS's own cost from wait4()
+// accounting instead of sampling ps.
+
+#define MAX_RUNS 1000
+#define DEFAULT_RUNS 10
+#define CONFIDENCE 0.95
+
+typedef enum {
+    CONDITION_BASELINE,
+    CONDITION_ATTACHED,
+    NUM_CONDITIONS
+} condition_t;
+
+static const char *condition_names[NUM_CONDITIONS] = {"baseline", "attached"};
+
+typedef struct {
+    condition_t condition;
+    bool warmup;
+    int status;               // target exit status
+    double wall;              // target run time, seconds
+    double started, ended;    // wall clock, to line up energy_monitor samples
+    double target_cpu;        // user + system, seconds
+    long target_rss_kb;
+    double ids_cpu;           // hpc_ids and its reaped perf child
+    long ids_rss_kb;
+    bool ids_killed;          // had to be stopped after the grace period
+} run_result_t;
+
+typedef struct {
+    int count;
+    double mean;
+    double stddev;
+    double ci;
+} summary_t;
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double realtime_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double rusage_cpu(const struct rusage *usage) {
+    return usage->ru_utime.tv_sec + usage->ru_utime.tv_usec / 1e6 +
+           usage->ru_stime.tv_sec + usage->ru_stime.tv_usec / 1e6;
+}
+
+static void summarize(const run_result_t *runs, int count, condition_t condition,
+                      size_t offset, summary_t *summary) {
+    double sum = 0.0, sq = 0.0;
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        if (runs[i].warmup || runs[i].condition != condition) continue;
+        sum += *(const double *)((const char *)&runs[i] + offset);
+        n++;
+    }
+    summary->count = n;
+    summary->mean = n > 0 ? sum / n : 0.0;
+    for (int i = 0; i < count; i++) {
+        if (runs[i].warmup || runs[i].condition != condition) continue;
+        double d = *(const double *)((const char *)&runs[i] + offset) - summary->mean;
+        sq += d * d;
+    }
+    summary->stddev = n > 1 ? sqrt(sq / (n - 1)) : 0.0;
+    summary->ci = n > 1 ? student_t_quantile(CONFIDENCE, n - 1) * summary->stddev / sqrt(n) : 0.0;
+}
+
+// Relative change of b over a with a Welch interval on the difference,
+// expressed as a fraction of a's mean
+static void print_change(const char *label, const summary_t *a, const summary_t *b) {
+    if (a->count < 2 || b->count < 2 || a->mean <= 0.0) {
+        printf("  %-18s n/a (need at least 2 runs per condition)\n", label);
+        return;
+    }
+    double va = a->stddev * a->stddev / a->count;
+    double vb = b->stddev * b->stddev / b->count;
+    double df = (va + vb) > 0 ? (va + vb) * (va + vb) / (va * va / (a->count - 1) + vb * vb / (b->count - 1)) : 1.0;
+    double half = student_t_quantile(CONFIDENCE, df) * sqrt(va + vb);
+    double diff = b->mean - a->mean;
+    double t;
+    double p = welch_t_test(b->mean, b->stddev * b->stddev, b->count,
+                            a->mean, a->stddev * a->stddev, a->count, &t);
+    printf("  %-18s %+7.2f%%  [%+.2f%%, %+.2f%%]  p=%.4f\n", label, diff / a->mean * 100.0,
+           (diff - half) / a->mean * 100.0, (diff + half) / a->mean * 100.0, p);
+}
+
+// Fork the target stopped at its exec, so the IDS sees its real name and
+// can attach before it does any work
+static pid_t spawn_target(char **argv, const placement_t *placement) {
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        const cpu_set_t *cpus = placement->pin_monitor ? &placement->monitor : &placement->allowed;
+        sched_setaffinity(0, sizeof(cpu_set_t), cpus);
+        int null_fd = open("/dev/null", O_WRONLY);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+            close(null_fd);
+        }
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0) _exit(126);
+        execvp(argv[0], argv);
+        _exit(127);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) != pid || !WIFSTOPPED(status)) {
+        fprintf(stderr, "Target %s did not start\n", argv[0]);
+        return -1;
+    }
+    return pid;
+}
+
+static pid_t spawn_ids(const char *ids_path, const char *config_file, pid_t target, int max_seconds,
+                       const char *ids_log) {
+    char pid_arg[32], duration_arg[32];
+    snprintf(pid_arg, sizeof(pid_arg), "%d", (int)target);
+    snprintf(duration_arg, sizeof(duration_arg), "%d", max_seconds);
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        return -1;
+    }
+    if (pid == 0) {
+        int log_fd = open(ids_log ? ids_log : "/dev/null", O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (log_fd >= 0) {
+            dup2(log_fd, STDOUT_FILENO);
+            dup2(log_fd, STDERR_FILENO);
+            close(log_fd);
+        }
+        if (config_file) {
+            execl(ids_path, ids_path, "--config", config_file, "--monitor", "--pid", pid_arg,
+                  "--duration", duration_arg, (char *)NULL);
+        } else {
+            execl(ids_path, ids_path, "--monitor", "--pid", pid_arg, "--duration", duration_arg, (char *)NULL);
+        }
+        _exit(127);
+    }
+    return pid;
+}
+
+static int run_once(char **argv, condition_t condition, const placement_t *placement, const char *ids_path,
+                    const char *config_file, double attach_delay, double grace, int max_seconds,
+                    const char *ids_log, run_result_t *result) {
+    memset(result, 0, sizeof(*result));
+    result->condition = condition;
+
+    pid_t target = spawn_target(argv, placement);
+    if (target < 0) return -1;
+
+    // Both conditions wait the same before release, so only the IDS differs
+    pid_t ids = -1;
+    if (condition == CONDITION_ATTACHED) {
+        ids = spawn_ids(ids_path, config_file, target, max_seconds, ids_log);
+        if (ids < 0) {
+            kill(target, SIGKILL);
+            waitpid(target, NULL, 0);
+            return -1;
+        }
+    }
+    struct timespec delay = {(time_t)attach_delay, (long)((attach_delay - (time_t)attach_delay) * 1e9)};
+    nanosleep(&delay, NULL);
+
+    struct rusage usage;
+    int status;
+    double start = now_seconds();
+    result->started = realtime_seconds();
+    ptrace(PTRACE_DETACH, target, NULL, NULL);
+    if (wait4(target, &status, 0, &usage) != target) {
+        perror("wait4");
+        return -1;
+    }
+    result->wall = now_seconds() - start;
+    result->ended = realtime_seconds();
+    result->status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    result->target_cpu = rusage_cpu(&usage);
+    result->target_rss_kb = usage.ru_maxrss;
+
+    if (ids > 0) {
+        // perf -p ends with its target and the IDS with perf; allow it to
+        // finish so the perf child is reaped and counted
+        double deadline = now_seconds() + grace;
+        pid_t done;
+        while ((done = wait4(ids, &status, WNOHANG, &usage)) == 0 && now_seconds() < deadline) {
+            struct timespec poll = {0, 10000000};
+            nanosleep(&poll, NULL);
+        }
+        if (done == 0) {
+            kill(ids, SIGTERM);
+            done = wait4(ids, &status, 0, &usage);
+            result->ids_killed = true;
+        }
+        if (done == ids) {
+            result->ids_cpu = rusage_cpu(&usage);
+            result->ids_rss_kb = usage.ru_maxrss;
+        }
+    }
+    return 0;
+}
+
+void print_usage(const char *program_name) {
+    printf("Usage: %s [OPTIONS] -- TARGET [ARGS...]\n", program_name);
+    printf("Measure hpc_ids overhead on a target run with and without monitoring\n\n");
+    printf("Options:\n");
+    printf("  -n, --runs N           Measured runs per condition (default: %d)\n", DEFAULT_RUNS);
+    printf("  -w, --warmup N         Discarded runs per condition first (default: 1)\n");
+    printf("  -c, --config FILE      Configuration for placement, sampling interval and hpc_ids\n");
+    printf("  -i, --ids PATH         hpc_ids binary (default: ./hpc_ids)\n");
+    printf("  -D, --attach-delay S   Seconds the target is held at exec before it runs (default: 0.5)\n");
+    printf("  -g, --grace S          Seconds the IDS gets to exit after the target (default: 5)\n");
+    printf("  -t, --max-seconds N    hpc_ids --duration, an upper bound on one run (default: 600)\n");
+    printf("  -s, --seed N           Seed for the run order (default: time)\n");
+    printf("  -o, --output FILE      Write one CSV row per run\n");
+    printf("  -l, --ids-log FILE     Append hpc_ids output here instead of discarding it\n");
+    printf("  -h, --help             Show this help message\n");
+    printf("\nExamples:\n");
+    printf("  %s -n 20 -c config.json -- ./test_workload --duration 5\n", program_name);
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    int runs = DEFAULT_RUNS;
+    int warmup = 1;
+    const char *config_file = NULL;
+    const char *ids_path = "./hpc_ids";
+    const char *output_file = NULL;
+    const char *ids_log = NULL;
+    double attach_delay = 0.5;
+    double grace = 5.0;
+    int max_seconds = 600;
+    uint64_t seed = (uint64_t)time(NULL);
+
+    static struct option long_options[] = {
+        {"runs",         required_argument, 0, 'n'},
+        {"warmup",       required_argument, 0, 'w'},
+        {"config",       required_argument, 0, 'c'},
+        {"ids",          required_argument, 0, 'i'},
+        {"attach-delay", required_argument, 0, 'D'},
+        {"grace",        required_argument, 0, 'g'},
+        {"max-seconds",  required_argument, 0, 't'},
+        {"seed",         required_argument, 0, 's'},
+        {"output",       required_argument, 0, 'o'},
+        {"ids-log",      required_argument, 0, 'l'},
+        {"help",         no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "+n:w:c:i:D:g:t:s:o:l:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'n': runs = atoi(optarg); break;
+            case 'w': warmup = atoi(optarg); break;
+            case 'c': config_file = optarg; break;
+            case 'i': ids_path = optarg; break;
+            case 'D': attach_delay = atof(optarg); break;
+            case 'g': grace = atof(optarg); break;
+            case 't': max_seconds = atoi(optarg); break;
+            case 's': seed = strtoull(optarg, NULL, 0); break;
+            case 'o': output_file = optarg; break;
+            case 'l': ids_log = optarg; break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (runs < 1 || warmup < 0 || (runs + warmup) * NUM_CONDITIONS > MAX_RUNS || attach_delay < 0 ||
+        grace < 0 || max_seconds <= 0) {
+        fprintf(stderr, "Invalid run parameters\n");
+        return 1;
+    }
+    if (access(ids_path, X_OK) != 0) {
+        fprintf(stderr, "Cannot execute %s\n", ids_path);
+        return 1;
+    }
+
+    // Same placement hpc_ids would apply: target on monitor CPUs in both
+    // conditions, this harness and the IDS on housekeeping
+    config_t *config = malloc(sizeof(config_t));
+    if (!config || load_config(config, config_file) != 0) {
+        fprintf(stderr, "Failed to load configuration\n");
+        free(config);
+        return 1;
+    }
+    placement_t placement;
+    if (placement_init(&placement, config) != 0) {
+        fprintf(stderr, "Warning: CPU placement unavailable, running unpinned\n");
+        memset(&placement, 0, sizeof(placement));
+        sched_getaffinity(0, sizeof(cpu_set_t), &placement.allowed);
+    }
+    placement_apply_self(&placement);
+    double interval = config->sampling_interval_ms / 1000.0;
+    free(config);
+
+    // Warm-ups first, then the measured runs in shuffled order so drift
+    // (thermal, frequency, page cache) spreads over both conditions
+    int total = (runs + warmup) * NUM_CONDITIONS;
+    run_result_t *results = calloc(total, sizeof(run_result_t));
+    if (!results) return 1;
+    int n = 0;
+    for (int w = 0; w < warmup; w++) {
+        for (int c = 0; c < NUM_CONDITIONS; c++) {
+            results[n].condition = (condition_t)c;
+            results[n++].warmup = true;
+        }
+    }
+    int first_measured = n;
+    for (int r = 0; r < runs; r++) {
+        for (int c = 0; c < NUM_CONDITIONS; c++) results[n++].condition = (condition_t)c;
+    }
+    uint64_t rng = seed ? seed : 1;
+    for (int i = total - 1; i > first_measured; i--) {
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        int j = first_measured + (int)(rng % (uint64_t)(i - first_measured + 1));
+        condition_t tmp = results[i].condition;
+        results[i].condition = results[j].condition;
+        results[j].condition = tmp;
+    }
+
+    printf("Running %s: %d measured + %d warm-up runs per condition, seed %lu\n",
+           argv[optind], runs, warmup, (unsigned long)seed);
+    int failures = 0;
+    int killed = 0;
+    for (int i = 0; i < total; i++) {
+        bool is_warmup = results[i].warmup;
+        if (run_once(&argv[optind], results[i].condition, &placement, ids_path, config_file,
+                     attach_delay, grace, max_seconds, ids_log, &results[i]) != 0) {
+            free(results);
+            return 1;
+        }
+        results[i].warmup = is_warmup;
+        if (results[i].status != 0) failures++;
+        if (results[i].ids_killed) killed++;
+        printf("  [%3d/%d] %-8s%s wall %.3fs  target cpu %.3fs", i + 1, total,
+               condition_names[results[i].condition], is_warmup ? " (warm-up)" : "",
+               results[i].wall, results[i].target_cpu);
+        if (results[i].condition == CONDITION_ATTACHED) {
+            printf("  ids cpu %.3fs%s", results[i].ids_cpu, results[i].ids_killed ? " (stopped)" : "");
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+
+    if (output_file) {
+        FILE *out = fopen(output_file, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open output file: %s\n", output_file);
+        } else {
+            fprintf(out, "run,condition,warmup,status,wall_s,target_cpu_s,target_maxrss_kb,"
+                         "ids_cpu_s,ids_maxrss_kb,ids_stopped,started,ended\n");
+            for (int i = 0; i < total; i++) {
+                const run_result_t *r = &results[i];
+                fprintf(out, "%d,%s,%d,%d,%.6f,%.6f,%ld,%.6f,%ld,%d,%.6f,%.6f\n", i + 1,
+                        condition_names[r->condition], r->warmup, r->status, r->wall, r->target_cpu,
+                        r->target_rss_kb, r->ids_cpu, r->ids_rss_kb, r->ids_killed, r->started, r->ended);
+            }
+            fclose(out);
+        }
+    }
+
+    summary_t wall[NUM_CONDITIONS], cpu[NUM_CONDITIONS], ids_cpu;
+    for (int c = 0; c < NUM_CONDITIONS; c++) {
+        summarize(results, total, (condition_t)c, offsetof(run_result_t, wall), &wall[c]);
+        summarize(results, total, (condition_t)c, offsetof(run_result_t, target_cpu), &cpu[c]);
+    }
+    summarize(results, total, CONDITION_ATTACHED, offsetof(run_result_t, ids_cpu), &ids_cpu);
+
+    long ids_rss = 0;
+    for (int i = first_measured; i < total; i++) {
+        if (results[i].ids_rss_kb > ids_rss) ids_rss = results[i].ids_rss_kb;
+    }
+
+    printf("\n%-10s %5s  %22s  %22s\n", "condition", "runs", "wall s (95% CI)", "target cpu s (95% CI)");
+    for (int c = 0; c < NUM_CONDITIONS; c++) {
+        printf("%-10s %5d  %10.4f +/- %-8.4f  %10.4f +/- %-8.4f\n", condition_names[c], wall[c].count,
+               wall[c].mean, wall[c].ci, cpu[c].mean, cpu[c].ci);
+    }
+    printf("\nSlowdown with hpc_ids attached:\n");
+    print_change("wall time", &wall[CONDITION_BASELINE], &wall[CONDITION_ATTACHED]);
+    print_change("target cpu time", &cpu[CONDITION_BASELINE], &cpu[CONDITION_ATTACHED]);
+
+    // Intervals from the attached wall time; IDS CPU includes its startup
+    // and perf, so this is an upper bound on the steady-state cost
+    double intervals = interval > 0 ? wall[CONDITION_ATTACHED].mean / interval : 0.0;
+    printf("\nhpc_ids cost (including perf):\n");
+    printf("  cpu per run        %.4f +/- %.4f s (%.2f%% of one CPU)\n", ids_cpu.mean, ids_cpu.ci,
+           wall[CONDITION_ATTACHED].mean > 0 ? ids_cpu.mean / wall[CONDITION_ATTACHED].mean * 100.0 : 0.0);
+    if (intervals >= 1.0) {
+        printf("  cpu per interval   %.1f +/- %.1f us per target (%.0f ms sampling, %.1f intervals per run)\n",
+               ids_cpu.mean / intervals * 1e6, ids_cpu.ci / intervals * 1e6, interval * 1000.0, intervals);
+    }
+    printf("  max rss            %ld kB\n", ids_rss);
+
+    if (failures > 0) printf("\nWarning: %d target run(s) exited non-zero\n", failures);
+    if (killed > 0) printf("Warning: hpc_ids had to be stopped after %d run(s); their perf CPU is not counted\n", killed);
+
+    free(results);
+    return 0;
+}
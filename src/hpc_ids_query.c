@@ -0,0 +1,353 @@
+#include "hpc_ids.h"
+#include <getopt.h>
+#include <sys/mman.h>
+
+typedef struct {
+    const char *app;
+    const char *feature;
+    int min_severity;
+    uint64_t since_ns;
+    uint64_t until_ns;
+    bool count_only;
+} query_t;
+
+typedef struct {
+    const alert_index_header_t *header;
+    const alert_index_block_t *blocks;
+    const alert_index_posting_t *postings;
+    const uint32_t *entries;
+    void *map;
+    size_t size;
+} index_view_t;
+
+void print_usage(const char *program_name) {
+    printf("Usage: %s --store DIR [OPTIONS]\n", program_name);
+    printf("Query the segmented HPC-IDS alert store\n\n");
+    printf("Options:\n");
+    printf("  -s, --store DIR        Alert store directory (alert_store_directory)\n");
+    printf("  -a, --app NAME         Only alerts for this application\n");
+    printf("  -f, --feature NAME     Only alerts for this feature (e.g. dtlb_mpki)\n");
+    printf("  -l, --severity LEVEL   Minimum severity: medium, high or critical\n");
+    printf("  -S, --since TIME       Start time (epoch seconds or YYYY-MM-DD[THH:MM:SS] UTC)\n");
+    printf("  -U, --until TIME       End time (inclusive, same formats)\n");
+    printf("  -n, --count            Print only the number of matching alerts\n");
+    printf("  -h, --help             Show this help message\n");
+    printf("\nExamples:\n");
+    printf("  %s -s alerts -a matmul -f dtlb_mpki -l critical -S 2025-10-07 -U 2025-10-07T23:59:59\n",
+           program_name);
+}
+
+static int parse_time(const char *arg, uint64_t *ns) {
+    char *end;
+    double seconds = strtod(arg, &end);
+    if (*end == '\0') {
+        *ns = (uint64_t)(seconds * 1e9);
+        return 0;
+    }
+
+    struct tm tm;
+    memset(&tm, 0, sizeof(tm));
+    const char *rest = strptime(arg, "%Y-%m-%dT%H:%M:%S", &tm);
+    if (!rest) {
+        memset(&tm, 0, sizeof(tm));
+        rest = strptime(arg, "%Y-%m-%d", &tm);
+    }
+    if (!rest || *rest != '\0') return -1;
+
+    *ns = (uint64_t)timegm(&tm) * 1000000000ULL;
+    return 0;
+}
+
+static int parse_severity(const char *arg) {
+    if (strcmp(arg, "medium") == 0) return 1;
+    if (strcmp(arg, "high") == 0) return 2;
+    if (strcmp(arg, "critical") == 0) return 3;
+    return -1;
+}
+
+static int open_index(const char *segment_path, size_t record_count, index_view_t *view) {
+    char index_path[ALERT_SIDE_PATH_LEN];
+    memset(view, 0, sizeof(index_view_t));
+    if (snprintf(index_path, sizeof(index_path), "%s.idx", segment_path) >= (int)sizeof(index_path)) return -1;
+
+    int fd = open(index_path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(alert_index_header_t)) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const alert_index_header_t *header = map;
+    size_t expected = sizeof(alert_index_header_t) +
+                      header->num_blocks * sizeof(alert_index_block_t) +
+                      header->num_postings * sizeof(alert_index_posting_t) +
+                      header->num_entries * sizeof(uint32_t);
+    if (memcmp(header->magic, ALERT_INDEX_MAGIC, strlen(ALERT_INDEX_MAGIC)) != 0 ||
+        header->version != ALERT_INDEX_VERSION || header->byte_order != ALERT_INDEX_BYTE_ORDER ||
+        header->record_count != record_count || expected != (size_t)st.st_size) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    view->map = map;
+    view->size = st.st_size;
+    view->header = header;
+    view->blocks = (const alert_index_block_t *)(header + 1);
+    view->postings = (const alert_index_posting_t *)(view->blocks + header->num_blocks);
+    view->entries = (const uint32_t *)(view->postings + header->num_postings);
+    return 0;
+}
+
+// Record range [lo, hi) that can contain timestamps in [since, until]
+static void time_range(const index_view_t *view, const query_t *query, size_t *lo, size_t *hi) {
+    uint32_t n = view->header->num_blocks;
+    uint32_t a = 0, b = n;
+    while (a < b) {
+        uint32_t mid = a + (b - a) / 2;
+        if (view->blocks[mid].prefix_max < query->since_ns) a = mid + 1; else b = mid;
+    }
+    uint32_t first = a;
+
+    a = first;
+    b = n;
+    while (a < b) {
+        uint32_t mid = a + (b - a) / 2;
+        if (view->blocks[mid].suffix_min <= query->until_ns) a = mid + 1; else b = mid;
+    }
+    uint32_t last = a;
+
+    *lo = (size_t)first * view->header->stride;
+    *hi = (size_t)last * view->header->stride;
+    if (*hi > view->header->record_count) *hi = view->header->record_count;
+}
+
+static size_t lower_bound(const uint32_t *entries, size_t count, uint32_t value) {
+    size_t a = 0, b = count;
+    while (a < b) {
+        size_t mid = a + (b - a) / 2;
+        if (entries[mid] < value) a = mid + 1; else b = mid;
+    }
+    return a;
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static bool record_matches(const alert_log_record_t *record, const query_t *query,
+                           int64_t app_id, int64_t feature_id) {
+    if (record->timestamp_ns < query->since_ns || record->timestamp_ns > query->until_ns) return false;
+    if (record->severity < query->min_severity) return false;
+    if (app_id >= 0 && record->app_id != (uint32_t)app_id) return false;
+    if (feature_id >= 0 && record->feature_id != (uint32_t)feature_id) return false;
+    return true;
+}
+
+static size_t emit_record(const alert_log_reader_t *reader, size_t index, const query_t *query,
+                          int64_t app_id, int64_t feature_id) {
+    alert_log_record_t record;
+    if (alert_log_read(reader, index, &record) != 0) return 0;
+    if (!record_matches(&record, query, app_id, feature_id)) return 0;
+
+    if (!query->count_only) {
+        char line[ALERT_LINE_LEN];
+        anomaly_alert_t alert;
+        alert_log_to_alert(reader, &record, &alert);
+        int len = format_alert_json(&alert, line, sizeof(line));
+        fwrite(line, 1, len, stdout);
+    }
+    return 1;
+}
+
+// Records in a segment, from its size alone
+static size_t segment_record_count(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0 || st.st_size < ALERT_LOG_HEADER_SIZE) return 0;
+    return (st.st_size - ALERT_LOG_HEADER_SIZE) / ALERT_LOG_RECORD_SIZE;
+}
+
+static size_t query_segment(const char *path, const query_t *query) {
+    // A sealed segment outside the time range is skipped on its index
+    // header alone, before the segment and its strings are read
+    index_view_t view;
+    bool indexed = open_index(path, segment_record_count(path), &view) == 0;
+    if (indexed && (view.header->record_count == 0 ||
+                    view.header->max_timestamp_ns < query->since_ns ||
+                    view.header->min_timestamp_ns > query->until_ns)) {
+        munmap(view.map, view.size);
+        return 0;
+    }
+
+    alert_log_reader_t reader;
+    if (alert_log_reader_open(&reader, path) != 0) {
+        if (indexed) munmap(view.map, view.size);
+        return 0;
+    }
+    if (indexed && view.header->record_count != reader.record_count) {
+        munmap(view.map, view.size);
+        indexed = false;
+    }
+
+    int64_t app_id = -1, feature_id = -1;
+    if (query->feature) feature_id = feature_index(query->feature);
+    if (query->app && (app_id = alert_log_find_string(&reader, query->app)) < 0) {
+        if (indexed) munmap(view.map, view.size);
+        alert_log_reader_close(&reader);
+        return 0;
+    }
+
+    size_t matches = 0;
+    if (!indexed) {
+        // Active or unindexed segment: sequential scan
+        for (size_t i = 0; i < reader.record_count; i++) {
+            matches += emit_record(&reader, i, query, app_id, feature_id);
+        }
+        alert_log_reader_close(&reader);
+        return matches;
+    }
+
+    size_t lo, hi;
+    time_range(&view, query, &lo, &hi);
+
+    if (app_id < 0 && feature_id < 0) {
+        for (size_t i = lo; i < hi; i++) {
+            matches += emit_record(&reader, i, query, app_id, feature_id);
+        }
+    } else {
+        // Gather candidate record numbers from the postings inside [lo, hi)
+        uint32_t *candidates = malloc(reader.record_count * sizeof(uint32_t));
+        size_t num_candidates = 0;
+        int lists = 0;
+
+        for (uint32_t p = 0; candidates && p < view.header->num_postings; p++) {
+            const alert_index_posting_t *posting = &view.postings[p];
+            if (app_id >= 0 && posting->app_id != (uint32_t)app_id) continue;
+            if (feature_id >= 0 && posting->feature_id != (uint32_t)feature_id) continue;
+
+            const uint32_t *list = view.entries + posting->offset;
+            size_t start = lower_bound(list, posting->count, (uint32_t)lo);
+            size_t end = lower_bound(list, posting->count, (uint32_t)hi);
+            memcpy(candidates + num_candidates, list + start, (end - start) * sizeof(uint32_t));
+            num_candidates += end - start;
+            lists++;
+        }
+
+        if (lists > 1) {
+            qsort(candidates, num_candidates, sizeof(uint32_t), compare_u32);
+        }
+        for (size_t i = 0; i < num_candidates; i++) {
+            matches += emit_record(&reader, candidates[i], query, app_id, feature_id);
+        }
+        free(candidates);
+    }
+
+    munmap(view.map, view.size);
+    alert_log_reader_close(&reader);
+    return matches;
+}
+
+static int segment_filter(const struct dirent *entry) {
+    size_t len = strlen(entry->d_name);
+    return strncmp(entry->d_name, "seg_", 4) == 0 && len > 8 &&
+           strcmp(entry->d_name + len - 4, ".hal") == 0;
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    const char *store_dir = NULL;
+    query_t query;
+    memset(&query, 0, sizeof(query));
+    query.until_ns = UINT64_MAX;
+
+    static struct option long_options[] = {
+        {"store",    required_argument, 0, 's'},
+        {"app",      required_argument, 0, 'a'},
+        {"feature",  required_argument, 0, 'f'},
+        {"severity", required_argument, 0, 'l'},
+        {"since",    required_argument, 0, 'S'},
+        {"until",    required_argument, 0, 'U'},
+        {"count",    no_argument,       0, 'n'},
+        {"help",     no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "s:a:f:l:S:U:nh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 's':
+                store_dir = optarg;
+                break;
+            case 'a':
+                query.app = optarg;
+                break;
+            case 'f':
+                if (feature_index(optarg) < 0) {
+                    fprintf(stderr, "Unknown feature: %s\n", optarg);
+                    return 1;
+                }
+                query.feature = optarg;
+                break;
+            case 'l':
+                if ((query.min_severity = parse_severity(optarg)) < 0) {
+                    fprintf(stderr, "Unknown severity: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'S':
+                if (parse_time(optarg, &query.since_ns) != 0) {
+                    fprintf(stderr, "Invalid time: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'U':
+                if (parse_time(optarg, &query.until_ns) != 0) {
+                    fprintf(stderr, "Invalid time: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'n':
+                query.count_only = true;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (!store_dir) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    struct dirent **segments;
+    int num_segments = scandir(store_dir, &segments, segment_filter, alphasort);
+    if (num_segments < 0) {
+        fprintf(stderr, "Cannot open alert store: %s\n", store_dir);
+        return 1;
+    }
+
+    size_t total = 0;
+    char path[ALERT_SEGMENT_PATH_LEN];
+    for (int i = 0; i < num_segments; i++) {
+        if (snprintf(path, sizeof(path), "%s/%s", store_dir, segments[i]->d_name) < (int)sizeof(path)) {
+            total += query_segment(path, &query);
+        } else {
+            fprintf(stderr, "Skipping segment with too long a path: %s\n", segments[i]->d_name);
+        }
+        free(segments[i]);
+    }
+    free(segments);
+
+    if (query.count_only) {
+        printf("%zu\n", total);
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+#include "hpc_ids.h"
+#include <getopt.h>
+#include <sys/mman.h>
+
+// Live view of a running hpc_ids. Refreshes read the shared-memory table
+// directly; only an idle segment is re-opened, to follow a restarted hpc_ids.
+
+#define DEFAULT_NAME "/hpc_ids"
+#define DEFAULT_REFRESH_MS 1000
+#define REMAP_IDLE_SECONDS 2.0
+
+static const char *severity_names[] = {"normal", "medium", "high", "critical"};
+
+void print_usage(const char *program_name) {
+    printf("Usage: %s [OPTIONS]\n", program_name);
+    printf("Show the live per-target telemetry of a running hpc_ids\n\n");
+    printf("Options:\n");
+    printf("  -n, --name NAME        Shared-memory segment (telemetry_shm, default: %s)\n", DEFAULT_NAME);
+    printf("  -i, --interval-ms MS   Refresh period (default: %d)\n", DEFAULT_REFRESH_MS);
+    printf("  -1, --once             Print one snapshot and exit\n");
+    printf("  -a, --all              Include targets whose monitoring has ended\n");
+    printf("  -h, --help             Show this help message\n");
+    printf("\nExamples:\n");
+    printf("  %s\n", program_name);
+    printf("  %s --once --all\n", program_name);
+}
+
+static double realtime_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void print_slot(const telemetry_header_t *header, const telemetry_slot_t *slot, double now) {
+    int worst = -1;
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        if (!(slot->present_mask & (1u << f))) continue;
+        if (worst < 0 || fabs(slot->z_scores[f]) > fabs(slot->z_scores[worst])) worst = f;
+    }
+    int severity = slot->severity >= 0 && slot->severity <= 3 ? slot->severity : 0;
+
+    printf("%-20.20s %8lu %5d  %-8s %5u %7lu %7.1f%s", slot->target, (unsigned long)slot->sequence,
+           slot->phase, severity_names[severity], slot->anomalies, (unsigned long)slot->total_anomalies,
+           now - slot->updated, slot->active ? "" : " ended");
+    if (worst >= 0) printf("  %s z=%.2f", header->feature_names[worst], slot->z_scores[worst]);
+    printf("\n");
+
+    int column = 0;
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        if (!(slot->present_mask & (1u << f))) continue;
+        printf("  %18.18s %10.4g (%+6.2f)", header->feature_names[f],
+               slot->features[f], slot->z_scores[f]);
+        if (++column == 3) {
+            printf("\n");
+            column = 0;
+        }
+    }
+    if (column) printf("\n");
+
+    printf("  pipeline");
+    for (int s = STAGE_COLLECTION; s < PIPELINE_STAGES; s++) {
+        printf("  %s %lu", pipeline_stage_name((pipeline_stage_id_t)s), (unsigned long)slot->stage_processed[s]);
+        if (slot->stage_busy_ns[s]) printf(" (%.1f ms)", slot->stage_busy_ns[s] / 1e6);
+        if (slot->queue_capacity[s]) printf(" q %u/%u", slot->queue_depth[s], slot->queue_capacity[s]);
+    }
+    printf("\n");
+}
+
+// Returns the number of targets shown
+static int print_table(const telemetry_segment_t *segment, bool all) {
+    const telemetry_header_t *header = &segment->header;
+    double now = realtime_seconds();
+    telemetry_slot_t copy;
+    int shown = 0;
+
+    printf("hpc_ids pid %d, publishing for %.0f s\n", header->pid, now - header->started);
+    printf("%-20s %8s %5s  %-8s %5s %7s %7s  %s\n", "TARGET", "SEQ", "PHASE", "SEVERITY", "ANOM", "TOTAL",
+           "AGE(s)", "WORST");
+    for (int s = 0; s < TELEMETRY_SLOTS; s++) {
+        const telemetry_slot_t *slot = &segment->slots[s];
+        if (!__atomic_load_n(&slot->active, __ATOMIC_ACQUIRE) && !(all && slot->target[0])) continue;
+        if (!telemetry_snapshot(slot, &copy)) {
+            printf("%-20.20s (being updated)\n", slot->target);
+            continue;
+        }
+        if (!copy.active && !all) continue;
+        print_slot(header, &copy, now);
+        shown++;
+    }
+    if (shown == 0) printf("(no monitored targets)\n");
+    return shown;
+}
+
+// The newest slot update, to tell an idle segment from a live one
+static double last_update(const telemetry_segment_t *segment) {
+    double newest = segment->header.started;
+    for (int s = 0; s < TELEMETRY_SLOTS; s++) {
+        double updated = segment->slots[s].updated;
+        if (updated > newest) newest = updated;
+    }
+    return newest;
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    const char *name = DEFAULT_NAME;
+    int refresh_ms = DEFAULT_REFRESH_MS;
+    bool once = false;
+    bool all = false;
+
+    static struct option long_options[] = {
+        {"name",        required_argument, 0, 'n'},
+        {"interval-ms", required_argument, 0, 'i'},
+        {"once",        no_argument,       0, '1'},
+        {"all",         no_argument,       0, 'a'},
+        {"help",        no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "n:i:1ah", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'n':
+                name = optarg;
+                break;
+            case 'i':
+                refresh_ms = atoi(optarg);
+                break;
+            case '1':
+                once = true;
+                break;
+            case 'a':
+                all = true;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (refresh_ms <= 0) {
+        fprintf(stderr, "Error: Refresh period must be positive\n");
+        return 1;
+    }
+
+    size_t size = 0;
+    const telemetry_segment_t *segment = telemetry_map(name, &size);
+    if (!segment && once) {
+        fprintf(stderr, "No telemetry at %s (is hpc_ids monitoring with telemetry_shm set?)\n", name);
+        return 1;
+    }
+
+    struct timespec period = { refresh_ms / 1000, (long)(refresh_ms % 1000) * 1000000L };
+    for (;;) {
+        if (!once) printf("\033[H\033[2J");
+        if (segment) {
+            print_table(segment, all);
+        } else {
+            printf("Waiting for telemetry at %s...\n", name);
+        }
+        fflush(stdout);
+        if (once) break;
+        nanosleep(&period, NULL);
+
+        // A restarted hpc_ids publishes a new segment under the same name
+        if (!segment || realtime_seconds() - last_update(segment) > REMAP_IDLE_SECONDS) {
+            size_t next_size = 0;
+            const telemetry_segment_t *next = telemetry_map(name, &next_size);
+            if (next && segment && next->header.pid == segment->header.pid &&
+                next->header.started == segment->header.started) {
+                munmap((void *)next, next_size);
+            } else if (next) {
+                if (segment) munmap((void *)segment, size);
+                segment = next;
+                size = next_size;
+            }
+        }
+    }
+
+    if (segment) munmap((void *)segment, size);
+    return 0;
+}
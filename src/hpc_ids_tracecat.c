@@ -0,0 +1,102 @@
+#include "hpc_ids.h"
+#include <getopt.h>
+
+void print_usage(const char *program_name) {
+    printf("Usage: %s [OPTIONS] TRACE_FILE\n", program_name);
+    printf("Convert a raw counter trace back to perf stat -x , interval output\n\n");
+    printf("Options:\n");
+    printf("  -o, --output FILE      Write CSV to FILE instead of stdout\n");
+    printf("  -s, --stats            Only scan the trace and print size and speed statistics\n");
+    printf("  -h, --help             Show this help message\n");
+    printf("\nExamples:\n");
+    printf("  %s trace_matmul_1759420184.hpct > matmul.csv\n", program_name);
+    printf("  %s --stats trace_matmul_1759420184.hpct\n", program_name);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char *argv[]) {
+    int opt;
+    const char *output_file = NULL;
+    bool stats = false;
+
+    static struct option long_options[] = {
+        {"output", required_argument, 0, 'o'},
+        {"stats",  no_argument,       0, 's'},
+        {"help",   no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "o:sh", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'o':
+                output_file = optarg;
+                break;
+            case 's':
+                stats = true;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (optind >= argc) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    trace_reader_t *reader = malloc(sizeof(trace_reader_t));
+    if (!reader || trace_reader_open(reader, argv[optind]) != 0) {
+        free(reader);
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (output_file) {
+        out = fopen(output_file, "w");
+        if (!out) {
+            fprintf(stderr, "Cannot open output file: %s\n", output_file);
+            trace_reader_close(reader);
+            free(reader);
+            return 1;
+        }
+    }
+
+    // Same field layout perf stat -I -x , prints, so --replay reads it back
+    uint64_t readings = 0;
+    int status;
+    double start = now_seconds();
+    while ((status = trace_reader_next(reader)) > 0) {
+        for (uint32_t i = 0; i < reader->count; i++) {
+            for (int e = 0; e < reader->num_events; e++) {
+                if (!(reader->masks[i] & (1ULL << e))) continue;
+                readings++;
+                if (stats) continue;
+                fprintf(out, "%.6f,%lu,,%s,,,,\n", reader->times[i] / 1e6,
+                        (unsigned long)reader->values[e][i], reader->events[e]);
+            }
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    if (stats) {
+        fprintf(stderr, "%s: %lu intervals in %lu blocks, %d events, %zu bytes "
+                        "(%.2f bytes per reading), scanned at %.0f MB/s\n",
+                reader->target, (unsigned long)reader->intervals, (unsigned long)reader->blocks,
+                reader->num_events, reader->size, readings ? (double)reader->size / readings : 0.0,
+                elapsed > 0 ? reader->size / elapsed / 1e6 : 0.0);
+    }
+
+    if (out != stdout) fclose(out);
+    trace_reader_close(reader);
+    free(reader);
+    return status < 0 ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+#include "hpc_ids.h"
+#include "hpcids.h"
+
+// The embedding API: the same configuration, baselines and detection path
+// as hpc_ids, with counts handed in by the host instead of read from perf.
+// All state hangs off the handle.
+
+struct hpcids {
+    hpc_ids_t ids;
+    target_state_t *targets;
+    int num_targets;
+    int target_capacity;
+    hpc_measurement_t interval[MAX_EVENTS];  // counter names filled in once
+};
+
+hpcids_t *hpcids_create(const char *config_file) {
+    hpcids_t *handle = calloc(1, sizeof(hpcids_t));
+    if (!handle) return NULL;
+    if (hpc_ids_init_embedded(&handle->ids, config_file) != 0) {
+        free(handle);
+        return NULL;
+    }
+
+    const config_t *config = &handle->ids.config;
+    for (int e = 0; e < config->num_events; e++) {
+        strcpy(handle->interval[e].counter, config->perf_events[e]);
+        handle->interval[e].duration_ms = config->sampling_interval_ms;
+    }
+    start_alert_output(&handle->ids);
+    return handle;
+}
+
+void hpcids_destroy(hpcids_t *handle) {
+    if (!handle) return;
+    hpcids_flush(handle);
+    for (int t = 0; t < handle->num_targets; t++) {
+        detach_target(&handle->ids, &handle->targets[t]);
+    }
+    free(handle->targets);
+    hpc_ids_cleanup(&handle->ids);
+    free(handle);
+}
+
+int hpcids_load_baselines(hpcids_t *handle) {
+    hpc_ids_t *ids = &handle->ids;
+    // A mapped store already holds every app
+    if (ids->baseline_store.header) return ids->num_apps;
+
+    pthread_mutex_lock(&ids->baseline_lock);
+    ids->app_baselines.max_entries = 0;  // asked for all of them, none may be evicted
+    int count = load_app_baselines(ids);
+    pthread_mutex_unlock(&ids->baseline_lock);
+    return count;
+}
+
+int hpcids_watch_baselines(hpcids_t *handle) {
+    if (handle->ids.watcher.running) return 0;
+    return baseline_watcher_start(&handle->ids);
+}
+
+int hpcids_num_events(const hpcids_t *handle) {
+    return handle->ids.config.num_events;
+}
+
+const char *hpcids_event_name(const hpcids_t *handle, int event) {
+    if (event < 0 || event >= handle->ids.config.num_events) return NULL;
+    return handle->ids.config.perf_events[event];
+}
+
+int hpcids_target_add(hpcids_t *handle, const char *app_name) {
+    if (handle->num_targets == handle->target_capacity) {
+        int capacity = handle->target_capacity ? handle->target_capacity * 2 : 16;
+        target_state_t *targets = realloc(handle->targets, capacity * sizeof(target_state_t));
+        if (!targets) return -1;
+        handle->targets = targets;
+        handle->target_capacity = capacity;
+    }
+
+    target_state_t *target = &handle->targets[handle->num_targets];
+    if (attach_target(&handle->ids, target, app_name, 0) != 0) return -1;
+    return handle->num_targets++;
+}
+
+int hpcids_push(hpcids_t *handle, const hpcids_interval_t *intervals, size_t count,
+                hpcids_verdict_t *verdicts) {
+    hpc_ids_t *ids = &handle->ids;
+    int anomalies = 0;
+
+    // Check the whole batch first so a bad interval leaves no target state changed
+    for (size_t i = 0; i < count; i++) {
+        const hpcids_interval_t *interval = &intervals[i];
+        if (interval->target < 0 || interval->target >= handle->num_targets ||
+            interval->num_counts < 0 || interval->num_counts > ids->config.num_events ||
+            (interval->num_counts > 0 && !interval->counts)) {
+            return -1;
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        const hpcids_interval_t *interval = &intervals[i];
+        hpcids_verdict_t *verdict = &verdicts[i];
+        memset(verdict, 0, sizeof(hpcids_verdict_t));
+
+        // Only the values change between intervals; names were set at create
+        for (int e = 0; e < interval->num_counts; e++) {
+            handle->interval[e].wall_time = interval->timestamp;
+            handle->interval[e].perf_time = interval->timestamp;
+            handle->interval[e].value = interval->counts[e];
+        }
+
+        feature_vector_t features;
+        if (engineer_features(handle->interval, interval->num_counts, &features) != 0) continue;
+        features.wall_time = interval->timestamp;
+
+        target_state_t *target = &handle->targets[interval->target];
+        verdict->scored = 1;
+        verdict->anomalies = detect_anomalies(ids, target, &features);
+        verdict->phase = target->last_phase;
+        if (target->last_feature >= 0) {
+            verdict->feature = feature_table[target->last_feature].name;
+            verdict->z_score = target->last_max_z;
+            verdict->severity = (hpcids_severity_t)get_severity_level(target->last_max_z, &ids->config);
+        }
+        anomalies += verdict->anomalies;
+    }
+    return anomalies;
+}
+
+void hpcids_flush(hpcids_t *handle) {
+    for (int t = 0; t < handle->num_targets; t++) {
+        flush_target_alerts(&handle->ids, &handle->targets[t]);
+    }
+}
@@ -8,7 +8,9 @@ int parse_perf_line(const char *line, double wall_time, hpc_measurement_t *measu
     
     int field = 0;
     int result = -1;
+#ifdef DEBUG_PARSING
     static int debug_count = 0;
+#endif
     
     measurement->wall_time = wall_time;
     measurement->duration_ms = SAMPLING_INTERVAL_MS;
@@ -74,9 +76,11 @@ int parse_perf_line(const char *line, double wall_time, hpc_measurement_t *measu
     if (field >= 4 && strlen(measurement->counter) > 0) { 
         // We need at least timestamp, value, empty, counter
         result = 0;
+        #ifdef DEBUG_PARSING
         if (debug_count == 0 && strstr(line, "cycles") != NULL) {
             debug_count = 1; // Only debug first cycles line
         }
+        #endif
     }
     
 cleanup:
@@ -84,24 +88,28 @@ cleanup:
     return result;
 }
 
-int execute_perf_command(const char *cmd, hpc_measurement_t *measurements, int *count, int timeout) {
-    if (!cmd || !measurements || !count) return -1;
-    
-    FILE *fp;
+// perf -I prints one line per counter per interval, all with the interval's
+// timestamp. An interval is handed to on_interval as soon as its expected
+// number of lines has arrived (<not counted> ones included), so it is scored
+// at its own boundary rather than when the next one starts. With expected 0,
+// or once perf prints more lines than expected, intervals are closed when
+// the next one starts (or the input ends). Memory use does not depend on how
+// long perf runs. Returns the number of counter readings, or -1 if there
+// were none.
+static int read_perf_stream(FILE *fp, int timeout, bool progress, int expected,
+                            perf_interval_fn on_interval, void *context) {
     char line[MAX_LINE_LEN];
-    *count = 0;
-    
-    fprintf(stderr, "Executing: %s\n", cmd);
-    
-    fp = popen(cmd, "r");
-    if (!fp) {
-        fprintf(stderr, "Failed to execute perf command: %s\n", strerror(errno));
-        return -1;
-    }
+    hpc_measurement_t interval[MAX_EVENTS];
+    int interval_count = 0;
+    int interval_lines = 0;
+    double interval_time = 0;
+    double handed_time = -1;    // timestamp of the last interval handed off complete
+    int count = 0;
+    bool stopped = false;
     
     time_t start_time = time(NULL);
     
-    while (fgets(line, sizeof(line), fp) && *count < MAX_SAMPLES) {
+    while (!stopped && fgets(line, sizeof(line), fp)) {
         if (timeout > 0 && (time(NULL) - start_time) > timeout) {
             fprintf(stderr, "Command timeout after %d seconds\n", timeout);
             break;
@@ -119,47 +127,120 @@ int execute_perf_command(const char *cmd, hpc_measurement_t *measurements, int *
         
         double wall_time = (double)time(NULL);
         hpc_measurement_t measurement;
+        memset(&measurement, 0, sizeof(measurement));
+        
+        bool parsed = parse_perf_line(line, wall_time, &measurement) == 0;
+        if (!parsed && !strstr(line, "<not ")) {
+            #ifdef DEBUG_PARSING
+            if (count <= 3) { // Debug failed parsing
+                fprintf(stderr, "Failed to parse line: %s", line);
+            }
+            #endif
+            continue;
+        }
+        
+        // 1 ms tolerance on the interval timestamp
+        if (expected > 0 && interval_lines == 0 && fabs(measurement.perf_time - handed_time) < 0.001) {
+            fprintf(stderr, "Warning: perf prints more than %d counters per interval, "
+                    "grouping them by timestamp\n", expected);
+            expected = 0;
+        }
+        if (interval_lines > 0 && fabs(measurement.perf_time - interval_time) >= 0.001) {
+            if (interval_count > 0) {
+                stopped = on_interval(context, interval, interval_count) != 0;
+            }
+            interval_count = 0;
+            interval_lines = 0;
+        }
+        interval_time = measurement.perf_time;
+        interval_lines++;
         
-        if (parse_perf_line(line, wall_time, &measurement) == 0) {
-            measurements[*count] = measurement;
-            (*count)++;
+        if (parsed) {
+            if (interval_count < MAX_EVENTS) {
+                interval[interval_count++] = measurement;
+            }
+            count++;
             
             #ifdef DEBUG_PARSING
-            if (*count <= 3) { // Debug first few measurements
+            if (count <= 3) { // Debug first few measurements
                 fprintf(stderr, "Parsed measurement %d: counter='%s', value=%lu, time=%.3f\n", 
-                        *count, measurement.counter, measurement.value, measurement.perf_time);
+                        count, measurement.counter, measurement.value, measurement.perf_time);
                 fprintf(stderr, "Original line: %s", line);
             }
             #endif
             
-            if (*count % 100 == 0) {
-                fprintf(stderr, "Collected %d measurements so far...\n", *count);
+            if (progress && count % 100 == 0) {
+                fprintf(stderr, "Collected %d measurements so far...\n", count);
             }
-        } else {
-            #ifdef DEBUG_PARSING
-            if (*count <= 3) { // Debug failed parsing
-                fprintf(stderr, "Failed to parse line: %s", line);
+        }
+        
+        if (!stopped && expected > 0 && interval_lines == expected) {
+            handed_time = interval_time;
+            if (interval_count > 0) {
+                stopped = on_interval(context, interval, interval_count) != 0;
             }
-            #endif
+            interval_count = 0;
+            interval_lines = 0;
         }
     }
     
-    pclose(fp);
+    if (!stopped && interval_count > 0) {
+        on_interval(context, interval, interval_count);
+    }
     
-    if (*count == 0) {
+    if (count == 0) {
         fprintf(stderr, "Warning: No valid measurements collected\n");
         return -1; // Only fail if no data collected
-    } else {
-        fprintf(stderr, "Total measurements collected: %d\n", *count);
     }
+    return count;
+}
+
+// expected is the number of counters perf was asked for (see read_perf_stream)
+int stream_perf_command(const char *cmd, int timeout, int expected, perf_interval_fn on_interval, void *context) {
+    if (!cmd || !on_interval) return -1;
+    
+    fprintf(stderr, "Executing: %s\n", cmd);
+    
+    FILE *fp = popen(cmd, "r");
+    if (!fp) {
+        fprintf(stderr, "Failed to execute perf command: %s\n", strerror(errno));
+        return -1;
+    }
+    
+    int count = read_perf_stream(fp, timeout, true, expected, on_interval, context);
+    pclose(fp);
     
     // Success if we collected data, regardless of exit status
     // (timeout command returns non-zero when it kills the process)
-    return 0;
+    if (count > 0) {
+        fprintf(stderr, "Total measurements collected: %d\n", count);
+    }
+    return count;
+}
+
+// Same grouping for recorded `perf stat -x ,` output; "-" reads stdin.
+// A recording may hold other events than the config, so intervals are
+// closed on the timestamp change.
+// Counter traces written by the recorder are recognised by their magic.
+int stream_perf_file(const char *path, perf_interval_fn on_interval, void *context) {
+    if (!path || !on_interval) return -1;
+    
+    if (strcmp(path, "-") != 0 && trace_file_detect(path)) {
+        return stream_trace_file(path, on_interval, context);
+    }
+    
+    FILE *fp = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!fp) {
+        fprintf(stderr, "Cannot open perf recording %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    
+    int count = read_perf_stream(fp, 0, false, 0, on_interval, context);
+    if (fp != stdin) fclose(fp);
+    return count;
 }
 
-char* get_app_name_from_pid(pid_t pid) {
-    static char app_name[128];
+char* get_app_name_from_pid(pid_t pid, char *app_name, size_t size) {
     char path[256];
     char link[256];
     ssize_t len;
@@ -168,7 +249,7 @@ char* get_app_name_from_pid(pid_t pid) {
     len = readlink(path, link, sizeof(link) - 1);
     
     if (len == -1) {
-        strcpy(app_name, "unknown");
+        snprintf(app_name, size, "unknown");
         return app_name;
     }
     
@@ -176,11 +257,7 @@ char* get_app_name_from_pid(pid_t pid) {
     
     // Extract basename
     char *basename = strrchr(link, '/');
-    if (basename) {
-        strcpy(app_name, basename + 1);
-    } else {
-        strcpy(app_name, link);
-    }
+    snprintf(app_name, size, "%s", basename ? basename + 1 : link);
     
     return app_name;
 }
@@ -200,6 +277,11 @@ int build_perf_command(const config_t *config, const char *target, char *cmd_buf
             snprintf(cmd_buffer, buffer_size,
                 "perf stat --no-big-num -I %d -x , -e %s -p %s 2>&1",
                 config->sampling_interval_ms, events_str, target + 4);
+        } else if (config->monitor_cpus[0]) {
+            // perf keeps the caller's (housekeeping) affinity; only the app is moved
+            snprintf(cmd_buffer, buffer_size,
+                "perf stat --no-big-num -I %d -x , -e %s taskset -c %s %s 2>&1",
+                config->sampling_interval_ms, events_str, config->monitor_cpus, target);
         } else {
             snprintf(cmd_buffer, buffer_size,
                 "perf stat --no-big-num -I %d -x , -e %s %s 2>&1",
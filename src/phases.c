@@ -0,0 +1,237 @@
+#include "hpc_ids.h"
+
+#define PHASE_MAX_ITERATIONS 50
+#define PHASE_MIN_GAIN 0.5        // each extra phase must halve the within-phase spread
+#define PHASE_MIN_FRACTION 0.05   // and hold at least 5% of the samples
+
+static double feature_value(const feature_vector_t *features, int f) {
+    return *(const double *)((const char *)features + feature_table[f].value_offset);
+}
+
+static const baseline_stats_t* whole_run_stats(const baseline_t *baseline, int f) {
+    return (const baseline_stats_t *)((const char *)baseline + feature_table[f].baseline_offset);
+}
+
+// Distances are measured in whole-run MADs so no feature dominates by scale.
+// Energy features the baseline lacks get a zero scale and never move a point.
+static void compute_phase_scale(baseline_t *baseline) {
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        const baseline_stats_t *stats = whole_run_stats(baseline, f);
+        double scale = fmax(stats->mad, fmax(fabs(stats->median) * 1e-6, 1e-12));
+        bool missing = (ENERGY_FEATURE_MASK & ~baseline->energy_mask) & (1u << f);
+        baseline->phase_scale[f] = missing ? 0.0 : 1.0 / scale;
+    }
+}
+
+// Value used for clustering: an interval without a reading of an energy
+// feature sits at the whole-run median
+static double clustering_value(const baseline_t *baseline, const feature_vector_t *features, int f) {
+    if ((ENERGY_FEATURE_MASK & ~features->energy_mask) & (1u << f)) return whole_run_stats(baseline, f)->median;
+    return feature_value(features, f);
+}
+
+// Deterministic so recollecting the same samples gives the same phases
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static double squared_distance(const double *a, const double *b) {
+    double sum = 0.0;
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        double d = a[f] - b[f];
+        sum += d * d;
+    }
+    return sum;
+}
+
+// k-means++ seeding followed by Lloyd iterations over standardized points.
+// Returns the total within-cluster sum of squares.
+static double kmeans(const double *points, int count, int k, double *centers, int *assign,
+                     double *nearest, int *sizes) {
+    uint64_t rng = 0x9e3779b97f4a7c15ULL;
+    memcpy(centers, &points[(next_random(&rng) % count) * NUM_FEATURES], NUM_FEATURES * sizeof(double));
+    for (int i = 0; i < count; i++) nearest[i] = squared_distance(&points[i * NUM_FEATURES], centers);
+
+    for (int c = 1; c < k; c++) {
+        double total = 0.0;
+        for (int i = 0; i < count; i++) total += nearest[i];
+        double target = (next_random(&rng) >> 11) * (1.0 / 9007199254740992.0) * total;
+        int chosen = count - 1;
+        for (int i = 0; i < count; i++) {
+            target -= nearest[i];
+            if (target <= 0) {
+                chosen = i;
+                break;
+            }
+        }
+        memcpy(&centers[c * NUM_FEATURES], &points[chosen * NUM_FEATURES], NUM_FEATURES * sizeof(double));
+        for (int i = 0; i < count; i++) {
+            double d = squared_distance(&points[i * NUM_FEATURES], &centers[c * NUM_FEATURES]);
+            if (d < nearest[i]) nearest[i] = d;
+        }
+    }
+
+    double sse = 0.0;
+    for (int iteration = 0; iteration < PHASE_MAX_ITERATIONS; iteration++) {
+        bool changed = iteration == 0;
+        sse = 0.0;
+        for (int i = 0; i < count; i++) {
+            int best = 0;
+            double best_d = INFINITY;
+            for (int c = 0; c < k; c++) {
+                double d = squared_distance(&points[i * NUM_FEATURES], &centers[c * NUM_FEATURES]);
+                if (d < best_d) {
+                    best_d = d;
+                    best = c;
+                }
+            }
+            if (assign[i] != best) changed = true;
+            assign[i] = best;
+            sse += best_d;
+        }
+        if (!changed) break;
+
+        memset(centers, 0, k * NUM_FEATURES * sizeof(double));
+        memset(sizes, 0, k * sizeof(int));
+        for (int i = 0; i < count; i++) {
+            sizes[assign[i]]++;
+            for (int f = 0; f < NUM_FEATURES; f++) centers[assign[i] * NUM_FEATURES + f] += points[i * NUM_FEATURES + f];
+        }
+        for (int c = 0; c < k; c++) {
+            for (int f = 0; f < NUM_FEATURES; f++) {
+                centers[c * NUM_FEATURES + f] /= sizes[c] > 0 ? sizes[c] : 1;
+            }
+        }
+    }
+
+    memset(sizes, 0, k * sizeof(int));
+    for (int i = 0; i < count; i++) sizes[assign[i]]++;
+    return sse;
+}
+
+// Split the samples into at most max_phases phases. A split into k phases is
+// kept only if it halves the within-phase spread of the k-1 split and every
+// phase has enough samples for its own median/MAD; unimodal apps stay at
+// one phase. Expects the whole-run statistics in baseline to be filled in.
+// Returns the number of phases (1 if no split was kept), or -1 when scratch
+// is exhausted.
+int compute_baseline_phases(baseline_t *baseline, const feature_vector_t *features, int count,
+                            int max_phases, int min_samples, arena_t *scratch) {
+    baseline->num_phases = 0;
+    if (max_phases > MAX_PHASES) max_phases = MAX_PHASES;
+    int min_phase_samples = min_samples;
+    if (min_phase_samples < (int)(count * PHASE_MIN_FRACTION)) min_phase_samples = (int)(count * PHASE_MIN_FRACTION);
+    if (max_phases < 2 || count < 2 * min_phase_samples) return 1;
+
+    compute_phase_scale(baseline);
+
+    size_t mark = arena_mark(scratch);
+    double *points = arena_alloc(scratch, (size_t)count * NUM_FEATURES * sizeof(double));
+    double *nearest = arena_alloc(scratch, (size_t)count * sizeof(double));
+    int *assign = arena_alloc(scratch, (size_t)count * sizeof(int));
+    int *best_assign = arena_alloc(scratch, (size_t)count * sizeof(int));
+    double *values = arena_alloc(scratch, (size_t)count * sizeof(double));
+    if (!points || !nearest || !assign || !best_assign || !values) {
+        arena_release(scratch, mark);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        for (int f = 0; f < NUM_FEATURES; f++) {
+            points[i * NUM_FEATURES + f] = clustering_value(baseline, &features[i], f) * baseline->phase_scale[f];
+        }
+    }
+
+    double centers[MAX_PHASES * NUM_FEATURES];
+    int sizes[MAX_PHASES];
+    memset(best_assign, 0, count * sizeof(int));
+    int best_k = 1;
+    double best_sse = 0.0;
+
+    // Spread of a single phase around its mean
+    double mean[NUM_FEATURES] = {0};
+    for (int i = 0; i < count; i++) {
+        for (int f = 0; f < NUM_FEATURES; f++) mean[f] += points[i * NUM_FEATURES + f] / count;
+    }
+    for (int i = 0; i < count; i++) best_sse += squared_distance(&points[i * NUM_FEATURES], mean);
+
+    for (int k = 2; k <= max_phases; k++) {
+        memset(assign, 0xff, count * sizeof(int));
+        double sse = kmeans(points, count, k, centers, assign, nearest, sizes);
+        bool balanced = true;
+        for (int c = 0; c < k; c++) balanced = balanced && sizes[c] >= min_phase_samples;
+        if (!balanced || sse > (1.0 - PHASE_MIN_GAIN) * best_sse) break;
+        best_k = k;
+        best_sse = sse;
+        memcpy(best_assign, assign, count * sizeof(int));
+    }
+
+    if (best_k > 1) {
+        baseline->num_phases = best_k;
+        for (int p = 0; p < best_k; p++) {
+            baseline_phase_t *phase = &baseline->phases[p];
+            for (int f = 0; f < NUM_FEATURES; f++) {
+                int n = 0, members = 0;
+                double sum = 0.0;
+                for (int i = 0; i < count; i++) {
+                    if (best_assign[i] != p) continue;
+                    members++;
+                    sum += clustering_value(baseline, &features[i], f);
+                    if ((ENERGY_FEATURE_MASK & ~features[i].energy_mask) & (1u << f)) continue;
+                    values[n++] = feature_value(&features[i], f);
+                }
+                if (n > 0) {
+                    compute_baseline_stats(&phase->stats[f], values, n);
+                } else {
+                    memset(&phase->stats[f], 0, sizeof(baseline_stats_t));
+                }
+                baseline->centroids[f][p] = sum / members;
+                phase->weight = (double)members / count;
+            }
+        }
+    }
+
+    arena_release(scratch, mark);
+    return best_k;
+}
+
+// Centroids of unused phase slots never win, so the distance loop always
+// runs over all MAX_PHASES slots and the compiler can vectorize it
+void prepare_phase_scoring(baseline_t *baseline) {
+    if (baseline->num_phases < 2 || baseline->num_phases > MAX_PHASES) baseline->num_phases = 0;
+    compute_phase_scale(baseline);
+    for (int p = 0; p < baseline->num_phases; p++) {
+        for (int f = 0; f < NUM_FEATURES; f++) {
+            baseline_stats_t *stats = &baseline->phases[p].stats[f];
+            stats->inv_mad = 1.0 / ((stats->mad < 1e-9) ? 1e-9 : stats->mad);
+        }
+    }
+    for (int p = baseline->num_phases; p < MAX_PHASES; p++) {
+        for (int f = 0; f < NUM_FEATURES; f++) baseline->centroids[f][p] = INFINITY;
+    }
+}
+
+// Index of the phase whose centroid is nearest, or -1 for single-phase baselines
+int baseline_nearest_phase(const baseline_t *baseline, const feature_vector_t *features) {
+    if (baseline->num_phases < 2) return -1;
+
+    double distance[MAX_PHASES] = {0};
+    uint32_t missing = ENERGY_FEATURE_MASK & ~features->energy_mask;
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        if (missing & (1u << f)) continue;
+        double x = feature_value(features, f);
+        double scale = baseline->phase_scale[f];
+        for (int p = 0; p < MAX_PHASES; p++) {
+            double d = (x - baseline->centroids[f][p]) * scale;
+            distance[p] += d * d;
+        }
+    }
+
+    int best = 0;
+    for (int p = 1; p < baseline->num_phases; p++) {
+        if (distance[p] < distance[best]) best = p;
+    }
+    return best;
+}
@@ -0,0 +1,319 @@
+#include "hpc_ids.h"
+#include <linux/futex.h>
+#include <sys/syscall.h>
+
+#define RING_SPINS 16   // yields before a waiting side goes to sleep
+
+static uint64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void futex_wait(uint32_t *word, uint32_t expected) {
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, NULL, NULL, 0);
+}
+
+// Wake the other side if it went to sleep. Paired with the sleeper storing
+// its flag before re-checking the ring (both sequentially consistent), so a
+// wake-up can never fall between that check and the futex wait.
+static void wake_if_sleeping(uint32_t *sleeping) {
+    if (__atomic_load_n(sleeping, __ATOMIC_SEQ_CST)) {
+        __atomic_store_n(sleeping, 0, __ATOMIC_SEQ_CST);
+        syscall(SYS_futex, sleeping, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+    }
+}
+
+int spsc_ring_init(spsc_ring_t *ring, size_t slot_size, size_t capacity) {
+    memset(ring, 0, sizeof(spsc_ring_t));
+    size_t rounded = 1;
+    while (rounded < capacity) rounded <<= 1;
+    ring->slots = calloc(rounded, slot_size);
+    if (!ring->slots) return -1;
+    ring->slot_size = slot_size;
+    ring->capacity = rounded;
+    return 0;
+}
+
+void spsc_ring_destroy(spsc_ring_t *ring) {
+    free(ring->slots);
+    ring->slots = NULL;
+}
+
+// Producer: the next free slot, waiting while the ring is full
+void* spsc_ring_reserve(spsc_ring_t *ring) {
+    size_t head = ring->head;
+    if (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= ring->capacity) {
+        ring->full_waits++;
+        for (int spin = 0; head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) >= ring->capacity; spin++) {
+            if (spin < RING_SPINS) {
+                sched_yield();
+                continue;
+            }
+            __atomic_store_n(&ring->producer_sleeping, 1, __ATOMIC_SEQ_CST);
+            if (head - __atomic_load_n(&ring->tail, __ATOMIC_SEQ_CST) >= ring->capacity) {
+                futex_wait(&ring->producer_sleeping, 1);
+            }
+            __atomic_store_n(&ring->producer_sleeping, 0, __ATOMIC_RELAXED);
+        }
+    }
+    return ring->slots + (head & (ring->capacity - 1)) * ring->slot_size;
+}
+
+void spsc_ring_commit(spsc_ring_t *ring) {
+    size_t head = ring->head + 1;
+    __atomic_store_n(&ring->head, head, __ATOMIC_SEQ_CST);
+    size_t depth = head - __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    if (depth > ring->max_depth) ring->max_depth = depth;
+    wake_if_sleeping(&ring->consumer_sleeping);
+}
+
+// Consumer: the oldest committed slot, waiting while the ring is empty.
+// NULL once the producer has closed the ring and every slot was drained.
+void* spsc_ring_peek(spsc_ring_t *ring) {
+    size_t tail = ring->tail;
+    for (int spin = 0; ; spin++) {
+        if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != tail) {
+            return ring->slots + (tail & (ring->capacity - 1)) * ring->slot_size;
+        }
+        if (__atomic_load_n(&ring->closed, __ATOMIC_ACQUIRE)) {
+            // Everything committed before the close is visible now
+            if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != tail) continue;
+            return NULL;
+        }
+        if (spin == 0) ring->empty_waits++;
+        if (spin < RING_SPINS) {
+            sched_yield();
+            continue;
+        }
+        __atomic_store_n(&ring->consumer_sleeping, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&ring->head, __ATOMIC_SEQ_CST) == tail &&
+            !__atomic_load_n(&ring->closed, __ATOMIC_SEQ_CST)) {
+            futex_wait(&ring->consumer_sleeping, 1);
+        }
+        __atomic_store_n(&ring->consumer_sleeping, 0, __ATOMIC_RELAXED);
+    }
+}
+
+void spsc_ring_release(spsc_ring_t *ring) {
+    __atomic_store_n(&ring->tail, ring->tail + 1, __ATOMIC_SEQ_CST);
+    wake_if_sleeping(&ring->producer_sleeping);
+}
+
+// Producer: no more slots will be committed
+void spsc_ring_close(spsc_ring_t *ring) {
+    __atomic_store_n(&ring->closed, true, __ATOMIC_SEQ_CST);
+    wake_if_sleeping(&ring->consumer_sleeping);
+}
+
+size_t spsc_ring_depth(const spsc_ring_t *ring) {
+    size_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+}
+
+const char* pipeline_stage_name(pipeline_stage_id_t stage) {
+    switch (stage) {
+        case STAGE_COLLECTION: return "collection";
+        case STAGE_FEATURES:   return "features";
+        case STAGE_SCORING:    return "scoring";
+        case STAGE_OUTPUT:     return "output";
+    }
+    return "unknown";
+}
+
+// Only the stage's own thread writes its counters; telemetry reads them live
+static void stage_account(pipeline_stage_t *stage, uint64_t start) {
+    __atomic_store_n(&stage->busy_ns, stage->busy_ns + (monotonic_ns() - start), __ATOMIC_RELAXED);
+    __atomic_store_n(&stage->processed, stage->processed + 1, __ATOMIC_RELAXED);
+}
+
+// Scoring stage work for one interval
+static void score_features(pipeline_t *pipeline, const feature_vector_t *features) {
+    int anomalies = detect_anomalies(pipeline->ids, pipeline->target, features);
+    pipeline->anomalies += anomalies;
+    if (pipeline->telemetry) telemetry_publish(pipeline, features, anomalies);
+}
+
+// Feature stage work for one interval: record it, then derive its features
+static bool extract_features(pipeline_t *pipeline, pipeline_interval_t *interval,
+                             feature_vector_t *features) {
+    if (pipeline->trace) {
+        trace_writer_append(pipeline->trace, interval->measurements, interval->count);
+    }
+    if (interval->counters < pipeline->min_counters ||
+        engineer_features(interval->measurements, interval->count, features) != 0) {
+        return false;
+    }
+    // Recordings carry no wall clock; seconds since perf started stand in
+    // for it so the same input always yields the same alerts and cooldowns.
+    // Alerts add the target's time_base (the replay epoch) to date them.
+    if (pipeline->replay) features->wall_time = interval->measurements[0].perf_time;
+    return true;
+}
+
+static void* feature_stage(void *arg) {
+    pipeline_t *pipeline = arg;
+    pipeline_stage_t *stage = &pipeline->stages[STAGE_FEATURES];
+    pipeline_interval_t *interval;
+
+    while ((interval = spsc_ring_peek(&pipeline->intervals)) != NULL) {
+        uint64_t start = monotonic_ns();
+        feature_vector_t features;
+        bool scored = extract_features(pipeline, interval, &features);
+        spsc_ring_release(&pipeline->intervals);
+        stage_account(stage, start);
+
+        if (scored) {
+            *(feature_vector_t *)spsc_ring_reserve(&pipeline->features) = features;
+            spsc_ring_commit(&pipeline->features);
+        }
+    }
+    spsc_ring_close(&pipeline->features);
+    return NULL;
+}
+
+// Intervals reach scoring in perf order, so cooldowns and aggregation see
+// the same sequence as on a single thread
+static void* scoring_stage(void *arg) {
+    pipeline_t *pipeline = arg;
+    pipeline_stage_t *stage = &pipeline->stages[STAGE_SCORING];
+    const feature_vector_t *features;
+
+    while ((features = spsc_ring_peek(&pipeline->features)) != NULL) {
+        uint64_t start = monotonic_ns();
+        score_features(pipeline, features);
+        spsc_ring_release(&pipeline->features);
+        stage_account(stage, start);
+    }
+    return NULL;
+}
+
+// The calling thread is the collection stage. With pipeline_threads the
+// feature and scoring stages get a thread each; otherwise, or if a thread
+// cannot be started, every stage runs on the caller in turn.
+int pipeline_start(pipeline_t *pipeline, hpc_ids_t *ids, target_state_t *target, trace_writer_t *trace,
+                   int min_counters, bool replay) {
+    memset(pipeline, 0, sizeof(pipeline_t));
+    pipeline->ids = ids;
+    pipeline->target = target;
+    pipeline->trace = trace;
+    pipeline->min_counters = min_counters;
+    pipeline->replay = replay;
+    pipeline->telemetry = telemetry_claim(&ids->telemetry, target);
+    const config_t *config = &ids->config;
+
+    // perf is started after this and inherits the collection CPU, keeping
+    // the pipe between it and its reader on one core
+    if (config->pipeline_cpus[STAGE_COLLECTION] >= 0 &&
+        pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &pipeline->saved_affinity) == 0) {
+        pipeline->restore_affinity = placement_pin_thread(pthread_self(), config->pipeline_cpus[STAGE_COLLECTION]) == 0;
+    }
+
+    if (!config->pipeline_threads) return 0;
+
+    size_t capacity = config->pipeline_queue_capacity > 0 ? (size_t)config->pipeline_queue_capacity
+                                                          : PIPELINE_QUEUE_CAPACITY;
+    if (spsc_ring_init(&pipeline->intervals, sizeof(pipeline_interval_t), capacity) != 0 ||
+        spsc_ring_init(&pipeline->features, sizeof(feature_vector_t), capacity) != 0) {
+        fprintf(stderr, "Warning: cannot allocate pipeline queues, running stages on one thread\n");
+        spsc_ring_destroy(&pipeline->intervals);
+        spsc_ring_destroy(&pipeline->features);
+        return 0;
+    }
+
+    // Scoring first: if the feature thread then fails, closing its input
+    // is enough to stop it again
+    pipeline_stage_t *scoring = &pipeline->stages[STAGE_SCORING];
+    pipeline_stage_t *features = &pipeline->stages[STAGE_FEATURES];
+    scoring->started = pthread_create(&scoring->thread, NULL, scoring_stage, pipeline) == 0;
+    features->started = scoring->started &&
+                        pthread_create(&features->thread, NULL, feature_stage, pipeline) == 0;
+    if (!features->started) {
+        if (scoring->started) {
+            spsc_ring_close(&pipeline->features);
+            pthread_join(scoring->thread, NULL);
+            scoring->started = false;
+        }
+        fprintf(stderr, "Warning: cannot start pipeline threads, running stages on one thread\n");
+        spsc_ring_destroy(&pipeline->intervals);
+        spsc_ring_destroy(&pipeline->features);
+        return 0;
+    }
+    placement_pin_thread(features->thread, config->pipeline_cpus[STAGE_FEATURES]);
+    placement_pin_thread(scoring->thread, config->pipeline_cpus[STAGE_SCORING]);
+    pipeline->threaded = true;
+    return 0;
+}
+
+// Collection stage: the slot to fill with the next interval. Waits while
+// the feature stage is a full queue behind.
+pipeline_interval_t* pipeline_reserve(pipeline_t *pipeline) {
+    pipeline_interval_t *interval = pipeline->threaded ? spsc_ring_reserve(&pipeline->intervals)
+                                                       : &pipeline->scratch;
+    pipeline->reserved_ns = monotonic_ns();
+    return interval;
+}
+
+void pipeline_submit(pipeline_t *pipeline) {
+    if (pipeline->threaded) {
+        spsc_ring_commit(&pipeline->intervals);
+        stage_account(&pipeline->stages[STAGE_COLLECTION], pipeline->reserved_ns);
+        return;
+    }
+    stage_account(&pipeline->stages[STAGE_COLLECTION], pipeline->reserved_ns);
+
+    uint64_t start = monotonic_ns();
+    feature_vector_t features;
+    bool scored = extract_features(pipeline, &pipeline->scratch, &features);
+    stage_account(&pipeline->stages[STAGE_FEATURES], start);
+    if (scored) {
+        start = monotonic_ns();
+        score_features(pipeline, &features);
+        stage_account(&pipeline->stages[STAGE_SCORING], start);
+    }
+}
+
+// Drain every queued interval through scoring and stop the stage threads
+void pipeline_finish(pipeline_t *pipeline) {
+    if (pipeline->threaded && pipeline->stages[STAGE_FEATURES].started) {
+        spsc_ring_close(&pipeline->intervals);
+        pthread_join(pipeline->stages[STAGE_FEATURES].thread, NULL);
+        pthread_join(pipeline->stages[STAGE_SCORING].thread, NULL);
+        pipeline->stages[STAGE_FEATURES].started = false;
+        pipeline->stages[STAGE_SCORING].started = false;
+        spsc_ring_destroy(&pipeline->intervals);
+        spsc_ring_destroy(&pipeline->features);
+    }
+    if (pipeline->telemetry) {
+        telemetry_release(pipeline->telemetry);
+        pipeline->telemetry = NULL;
+    }
+    if (pipeline->restore_affinity) {
+        pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &pipeline->saved_affinity);
+        pipeline->restore_affinity = false;
+    }
+}
+
+// One line per stage: work done, and for the queue it feeds, the deepest
+// it got and how often the stage had to wait for room (backpressure)
+void pipeline_report(const pipeline_t *pipeline) {
+    const spsc_ring_t *queues[] = { &pipeline->intervals, &pipeline->features };
+    printf("Pipeline stages (%s):\n", pipeline->threaded ? "threaded" : "single thread");
+    for (int s = STAGE_COLLECTION; s <= STAGE_SCORING; s++) {
+        const pipeline_stage_t *stage = &pipeline->stages[s];
+        printf("  %-10s %8lu items %10.3f ms busy", pipeline_stage_name((pipeline_stage_id_t)s),
+               (unsigned long)stage->processed, stage->busy_ns / 1e6);
+        if (s < STAGE_SCORING && queues[s]->capacity > 0) {
+            printf("  queue max %zu/%zu, %lu full waits", queues[s]->max_depth, queues[s]->capacity,
+                   (unsigned long)queues[s]->full_waits);
+        }
+        printf("\n");
+    }
+    const alert_writer_t *writer = &pipeline->ids->alert_writer;
+    if (writer->running) {
+        printf("  %-10s %8lu items  queue %zu/%zu, %lu dropped\n", pipeline_stage_name(STAGE_OUTPUT),
+               (unsigned long)__atomic_load_n(&writer->written, __ATOMIC_RELAXED),
+               __atomic_load_n(&writer->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&writer->tail, __ATOMIC_ACQUIRE),
+               writer->capacity, (unsigned long)__atomic_load_n(&writer->dropped, __ATOMIC_RELAXED));
+    }
+}
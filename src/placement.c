@@ -0,0 +1,174 @@
+#include "hpc_ids.h"
+
+// Format a CPU set as a kernel-style cpulist ("0-3,8")
+int format_cpu_list(const cpu_set_t *set, char *buffer, size_t size) {
+    size_t len = 0;
+    buffer[0] = '\0';
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, set)) continue;
+        int last = cpu;
+        while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, set)) last++;
+
+        int n = last > cpu ? snprintf(buffer + len, size - len, "%s%d-%d", len ? "," : "", cpu, last)
+                           : snprintf(buffer + len, size - len, "%s%d", len ? "," : "", cpu);
+        if (n < 0 || (size_t)n >= size - len) return -1;
+        len += n;
+        cpu = last;
+    }
+    return 0;
+}
+
+// Resolve where the workload and the IDS itself run. The monitored app gets
+// monitor_cpus (or the single core_affinity CPU); perf, parsing, the alert
+// writer and the baseline watcher get housekeeping_cpus, which defaults to
+// every usable CPU on a physical core the workload does not use.
+int placement_init(placement_t *placement, config_t *config) {
+    memset(placement, 0, sizeof(placement_t));
+    if (sched_getaffinity(0, sizeof(cpu_set_t), &placement->allowed) != 0) {
+        perror("sched_getaffinity");
+        return -1;
+    }
+
+    cpu_topology_t *topology = malloc(sizeof(cpu_topology_t));
+    if (!topology || topology_load(topology, &placement->allowed) <= 0) {
+        free(topology);
+        return -1;
+    }
+
+    cpu_set_t requested;
+    CPU_ZERO(&requested);
+    if (config->monitor_cpus[0]) {
+        if (parse_cpu_list(config->monitor_cpus, &requested) < 0) {
+            fprintf(stderr, "Warning: invalid monitor_cpus '%s'\n", config->monitor_cpus);
+            CPU_ZERO(&requested);
+        }
+    } else if (config->core_affinity >= 0 && config->core_affinity < CPU_SETSIZE) {
+        CPU_SET(config->core_affinity, &requested);
+    }
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (!CPU_ISSET(cpu, &requested)) continue;
+        if (topology_find(topology, cpu)) {
+            CPU_SET(cpu, &placement->monitor);
+        } else {
+            fprintf(stderr, "Warning: monitor CPU %d is not available to this process\n", cpu);
+        }
+    }
+    placement->pin_monitor = CPU_COUNT(&placement->monitor) > 0;
+
+    if (config->housekeeping_cpus[0]) {
+        cpu_set_t housekeeping;
+        if (parse_cpu_list(config->housekeeping_cpus, &housekeeping) < 0) {
+            fprintf(stderr, "Warning: invalid housekeeping_cpus '%s'\n", config->housekeeping_cpus);
+        } else {
+            for (int i = 0; i < topology->num_cpus; i++) {
+                if (CPU_ISSET(topology->cpus[i].cpu, &housekeeping)) {
+                    CPU_SET(topology->cpus[i].cpu, &placement->housekeeping);
+                }
+            }
+        }
+    } else if (placement->pin_monitor) {
+        // Non-isolated CPUs whose physical core carries no monitor CPU
+        for (int i = 0; i < topology->num_cpus; i++) {
+            const cpu_info_t *info = &topology->cpus[i];
+            bool shared = false;
+            for (int j = 0; j < topology->num_cpus && !shared; j++) {
+                shared = CPU_ISSET(topology->cpus[j].cpu, &placement->monitor) &&
+                         topology->cpus[j].core_id == info->core_id;
+            }
+            if (!shared && !info->isolated) CPU_SET(info->cpu, &placement->housekeeping);
+        }
+    }
+    placement->pin_housekeeping = CPU_COUNT(&placement->housekeeping) > 0;
+
+    // Warn about any physical core carrying both sides
+    for (int i = 0; i < topology->num_cpus; i++) {
+        const cpu_info_t *hk = &topology->cpus[i];
+        if (!CPU_ISSET(hk->cpu, &placement->housekeeping)) continue;
+        for (int j = 0; j < topology->num_cpus; j++) {
+            const cpu_info_t *mon = &topology->cpus[j];
+            if (!CPU_ISSET(mon->cpu, &placement->monitor) || mon->core_id != hk->core_id) continue;
+            placement->shared_core = true;
+            if (mon->cpu == hk->cpu) {
+                fprintf(stderr, "Warning: CPU %d is both a monitor and a housekeeping CPU\n", mon->cpu);
+            } else {
+                fprintf(stderr, "Warning: housekeeping CPU %d is an SMT sibling of monitor CPU %d\n",
+                        hk->cpu, mon->cpu);
+            }
+        }
+    }
+    if (placement->pin_monitor && !placement->pin_housekeeping) {
+        placement->shared_core = true;
+        fprintf(stderr, "Warning: no housekeeping CPU left, the IDS will share cores with the workload\n");
+    }
+    free(topology);
+
+    format_cpu_list(&placement->monitor, placement->monitor_list, sizeof(placement->monitor_list));
+    format_cpu_list(&placement->housekeeping, placement->housekeeping_list,
+                    sizeof(placement->housekeeping_list));
+
+    // Normalised lists are what perf commands and metadata use from here on
+    memcpy(config->monitor_cpus, placement->monitor_list, CPU_LIST_LEN);
+    memcpy(config->housekeeping_cpus, placement->housekeeping_list, CPU_LIST_LEN);
+    config->monitor_cpus[CPU_LIST_LEN - 1] = '\0';
+    config->housekeeping_cpus[CPU_LIST_LEN - 1] = '\0';
+
+    if (!config->quiet) {
+        printf("Placement: workload on %s, IDS on %s\n",
+               placement->pin_monitor ? placement->monitor_list : "any CPU",
+               placement->pin_housekeeping ? placement->housekeeping_list : "any CPU");
+    }
+    return 0;
+}
+
+// Pin the calling thread to the housekeeping CPUs. Threads and processes it
+// creates afterwards (alert writer, watcher, perf) inherit the mask.
+int placement_apply_self(const placement_t *placement) {
+    if (!placement->pin_housekeeping) return 0;
+    if (sched_setaffinity(0, sizeof(cpu_set_t), &placement->housekeeping) != 0) {
+        perror("sched_setaffinity");
+        return -1;
+    }
+    return 0;
+}
+
+// Pin every thread of an already running process to the monitor CPUs
+int placement_pin_pid(const placement_t *placement, pid_t pid) {
+    if (!placement->pin_monitor) return 0;
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/task", (int)pid);
+    DIR *dir = opendir(path);
+    if (!dir) {
+        return sched_setaffinity(pid, sizeof(cpu_set_t), &placement->monitor);
+    }
+
+    int failures = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        pid_t tid = (pid_t)atoi(entry->d_name);
+        if (sched_setaffinity(tid, sizeof(cpu_set_t), &placement->monitor) != 0) failures++;
+    }
+    closedir(dir);
+
+    if (failures > 0) {
+        fprintf(stderr, "Warning: could not pin %d threads of PID %d to CPUs %s\n",
+                failures, (int)pid, placement->monitor_list);
+        return -1;
+    }
+    return 0;
+}
+
+// Pin one thread to a single CPU; a negative cpu leaves it where it is
+int placement_pin_thread(pthread_t thread, int cpu) {
+    if (cpu < 0) return 0;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(thread, sizeof(set), &set) != 0) {
+        fprintf(stderr, "Warning: cannot pin thread to CPU %d\n", cpu);
+        return -1;
+    }
+    return 0;
+}
@@ -1,111 +1,315 @@
 #include "hpc_ids.h"
+#include <stddef.h>
 
-// Simple JSON value extractor - finds "key": value pairs
-char* extract_json_string(const char *json, const char *key) {
-    static char result[256];
-    char search_pattern[128];
-    snprintf(search_pattern, sizeof(search_pattern), "\"%s\":", key);
-    
-    char *start = strstr(json, search_pattern);
-    if (!start) return NULL;
-    
-    start += strlen(search_pattern);
-    // Skip whitespace
-    while (*start == ' ' || *start == '\t' || *start == '\n') start++;
-    
-    if (*start == '"') {
-        start++; // Skip opening quote
-        char *end = strchr(start, '"');
-        if (!end) return NULL;
-        
-        size_t len = end - start;
-        if (len >= sizeof(result)) len = sizeof(result) - 1;
-        strncpy(result, start, len);
-        result[len] = '\0';
-        return result;
+#define JSON_MAX_DEPTH 64
+
+// Single-pass tokenizer. All state lives in the parser and the document,
+// so separate documents can be parsed and queried from different threads.
+typedef struct {
+    const char *text;
+    size_t length;
+    size_t pos;
+    json_doc_t *doc;
+} json_parser_t;
+
+static int parse_value(json_parser_t *p, int depth);
+
+static void skip_whitespace(json_parser_t *p) {
+    while (p->pos < p->length) {
+        char c = p->text[p->pos];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+        p->pos++;
+    }
+}
+
+static int new_token(json_parser_t *p, json_type_t type, size_t start) {
+    json_doc_t *doc = p->doc;
+    if (doc->num_tokens == doc->capacity) {
+        size_t capacity = doc->capacity ? doc->capacity * 2 : 64;
+        json_token_t *tokens = realloc(doc->tokens, capacity * sizeof(json_token_t));
+        if (!tokens) return -1;
+        doc->tokens = tokens;
+        doc->capacity = capacity;
+    }
+    json_token_t *token = &doc->tokens[doc->num_tokens];
+    token->type = type;
+    token->start = start;
+    token->end = start;
+    token->size = 0;
+    token->next = 0;
+    return doc->num_tokens++;
+}
+
+static int finish_token(json_parser_t *p, int idx, size_t end) {
+    p->doc->tokens[idx].end = end;
+    p->doc->tokens[idx].next = p->doc->num_tokens;
+    return idx;
+}
+
+static int parse_string(json_parser_t *p) {
+    if (p->pos >= p->length || p->text[p->pos] != '"') return -1;
+    size_t start = ++p->pos;
+
+    // Jump between quotes with memchr; a quote preceded by an odd run of
+    // backslashes is escaped and scanning continues past it
+    const char *end = p->text + p->length;
+    const char *cursor = p->text + start;
+    for (;;) {
+        const char *quote = memchr(cursor, '"', end - cursor);
+        if (!quote) return -1;
+
+        size_t backslashes = 0;
+        while (quote - backslashes > p->text + start && quote[-1 - (ptrdiff_t)backslashes] == '\\') {
+            backslashes++;
+        }
+        if (backslashes % 2 == 0) {
+            int idx = new_token(p, JSON_STRING, start);
+            if (idx < 0) return -1;
+            p->pos = quote - p->text;
+            finish_token(p, idx, p->pos);
+            p->pos++;
+            return idx;
+        }
+        cursor = quote + 1;
+    }
+}
+
+static int parse_number(json_parser_t *p) {
+    size_t start = p->pos;
+    bool digits = false;
+    while (p->pos < p->length) {
+        char c = p->text[p->pos];
+        if (c >= '0' && c <= '9') digits = true;
+        else if (c != '-' && c != '+' && c != '.' && c != 'e' && c != 'E') break;
+        p->pos++;
+    }
+    if (!digits) return -1;
+
+    int idx = new_token(p, JSON_NUMBER, start);
+    return idx < 0 ? -1 : finish_token(p, idx, p->pos);
+}
+
+static int parse_literal(json_parser_t *p, const char *word, json_type_t type) {
+    size_t len = strlen(word);
+    if (p->length - p->pos < len || memcmp(p->text + p->pos, word, len) != 0) return -1;
+
+    int idx = new_token(p, type, p->pos);
+    if (idx < 0) return -1;
+    p->pos += len;
+    return finish_token(p, idx, p->pos);
+}
+
+static int parse_container(json_parser_t *p, int depth, bool object) {
+    if (depth >= JSON_MAX_DEPTH) return -1;
+
+    int idx = new_token(p, object ? JSON_OBJECT : JSON_ARRAY, p->pos);
+    if (idx < 0) return -1;
+    char close = object ? '}' : ']';
+    p->pos++;
+
+    skip_whitespace(p);
+    if (p->pos < p->length && p->text[p->pos] == close) {
+        p->pos++;
+        return finish_token(p, idx, p->pos);
+    }
+
+    uint32_t size = 0;
+    while (p->pos < p->length) {
+        if (object) {
+            if (parse_string(p) < 0) return -1;
+            skip_whitespace(p);
+            if (p->pos >= p->length || p->text[p->pos] != ':') return -1;
+            p->pos++;
+        }
+        if (parse_value(p, depth + 1) < 0) return -1;
+        size++;
+
+        skip_whitespace(p);
+        if (p->pos >= p->length) return -1;
+        char c = p->text[p->pos++];
+        if (c == close) {
+            p->doc->tokens[idx].size = size;
+            return finish_token(p, idx, p->pos);
+        }
+        if (c != ',') return -1;
+        skip_whitespace(p);
+    }
+    return -1;
+}
+
+static int parse_value(json_parser_t *p, int depth) {
+    skip_whitespace(p);
+    if (p->pos >= p->length) return -1;
+
+    switch (p->text[p->pos]) {
+        case '{': return parse_container(p, depth, true);
+        case '[': return parse_container(p, depth, false);
+        case '"': return parse_string(p);
+        case 't': return parse_literal(p, "true", JSON_BOOL);
+        case 'f': return parse_literal(p, "false", JSON_BOOL);
+        case 'n': return parse_literal(p, "null", JSON_NULL);
+        default:  return parse_number(p);
     }
-    
-    return NULL;
-}
-
-double extract_json_double(const char *json, const char *key) {
-    char search_pattern[128];
-    snprintf(search_pattern, sizeof(search_pattern), "\"%s\":", key);
-    
-    char *start = strstr(json, search_pattern);
-    if (!start) return -1.0;
-    
-    start += strlen(search_pattern);
-    // Skip whitespace
-    while (*start == ' ' || *start == '\t' || *start == '\n') start++;
-    
-    return atof(start);
-}
-
-int extract_json_int(const char *json, const char *key) {
-    char search_pattern[128];
-    snprintf(search_pattern, sizeof(search_pattern), "\"%s\":", key);
-    
-    char *start = strstr(json, search_pattern);
-    if (!start) return -1;
-    
-    start += strlen(search_pattern);
-    // Skip whitespace
-    while (*start == ' ' || *start == '\t' || *start == '\n') start++;
-    
-    return atoi(start);
-}
-
-bool extract_json_bool(const char *json, const char *key) {
-    char search_pattern[128];
-    snprintf(search_pattern, sizeof(search_pattern), "\"%s\":", key);
-    
-    char *start = strstr(json, search_pattern);
-    if (!start) return false;
-    
-    start += strlen(search_pattern);
-    // Skip whitespace
-    while (*start == ' ' || *start == '\t' || *start == '\n') start++;
-    
-    return (strncmp(start, "true", 4) == 0);
-}
-
-// Extract array of strings from JSON
-int extract_json_string_array(const char *json, const char *key, char results[][64], int max_items) {
-    char search_pattern[128];
-    snprintf(search_pattern, sizeof(search_pattern), "\"%s\":", key);
-    
-    char *start = strstr(json, search_pattern);
-    if (!start) return 0;
-    
-    start += strlen(search_pattern);
-    // Skip whitespace
-    while (*start == ' ' || *start == '\t' || *start == '\n') start++;
-    
-    if (*start != '[') return 0;
-    start++; // Skip opening bracket
-    
+}
+
+// Tokenize text, which must be NUL terminated and outlive doc. Returns 0 on
+// success, -1 on malformed input or allocation failure.
+int json_parse(json_doc_t *doc, const char *text, size_t length) {
+    memset(doc, 0, sizeof(json_doc_t));
+    if (length > UINT32_MAX) return -1;
+    doc->text = text;
+    doc->length = length;
+
+    json_parser_t parser = { text, length, 0, doc };
+    if (parse_value(&parser, 0) < 0) {
+        json_free(doc);
+        return -1;
+    }
+    skip_whitespace(&parser);
+    if (parser.pos != length) {
+        json_free(doc);
+        return -1;
+    }
+    return 0;
+}
+
+void json_free(json_doc_t *doc) {
+    free(doc->tokens);
+    memset(doc, 0, sizeof(json_doc_t));
+}
+
+static bool key_equals(const json_doc_t *doc, const json_token_t *key, const char *name, size_t len) {
+    return key->end - key->start == len && memcmp(doc->text + key->start, name, len) == 0;
+}
+
+// Resolve a dot-separated path below token parent (0 = document root).
+// Numeric segments index arrays. Returns the token index or -1.
+int json_find(const json_doc_t *doc, int parent, const char *path) {
+    if (parent < 0 || (size_t)parent >= doc->num_tokens) return -1;
+
+    int current = parent;
+    const char *segment = path;
+    while (*segment) {
+        const char *dot = strchr(segment, '.');
+        size_t len = dot ? (size_t)(dot - segment) : strlen(segment);
+        const json_token_t *container = &doc->tokens[current];
+        int child = current + 1;
+        int found = -1;
+
+        if (container->type == JSON_OBJECT) {
+            for (uint32_t i = 0; i < container->size; i++) {
+                if (key_equals(doc, &doc->tokens[child], segment, len)) {
+                    found = child + 1;
+                    break;
+                }
+                child = doc->tokens[child + 1].next;
+            }
+        } else if (container->type == JSON_ARRAY) {
+            char *end;
+            unsigned long index = strtoul(segment, &end, 10);
+            if (end != segment + len) return -1;
+            for (uint32_t i = 0; i < container->size; i++) {
+                if (i == index) {
+                    found = child;
+                    break;
+                }
+                child = doc->tokens[child].next;
+            }
+        }
+
+        if (found < 0) return -1;
+        current = found;
+        segment = dot ? dot + 1 : segment + len;
+    }
+    return current;
+}
+
+static const json_token_t* find_typed(const json_doc_t *doc, int parent, const char *path, json_type_t type) {
+    int idx = json_find(doc, parent, path);
+    if (idx < 0 || doc->tokens[idx].type != type) return NULL;
+    return &doc->tokens[idx];
+}
+
+// Raw (still escaped) string contents, pointing into the source text
+int json_get_view(const json_doc_t *doc, int parent, const char *path, json_view_t *view) {
+    const json_token_t *token = find_typed(doc, parent, path, JSON_STRING);
+    if (!token) return -1;
+    view->ptr = doc->text + token->start;
+    view->len = token->end - token->start;
+    return 0;
+}
+
+static size_t unescape(const char *src, size_t len, char *buffer, size_t size) {
+    size_t out = 0;
+    for (size_t i = 0; i < len && out + 1 < size; i++) {
+        char c = src[i];
+        if (c == '\\' && i + 1 < len) {
+            c = src[++i];
+            switch (c) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u': {
+                    // Only ASCII code points are decoded; anything else becomes '?'
+                    unsigned int code = 0;
+                    if (i + 4 < len && sscanf(src + i + 1, "%4x", &code) == 1) i += 4;
+                    c = code < 0x80 ? (char)code : '?';
+                    break;
+                }
+                default: break;
+            }
+        }
+        buffer[out++] = c;
+    }
+    buffer[out] = '\0';
+    return out;
+}
+
+// Copy an unescaped string into buffer, truncating to size - 1 bytes
+int json_get_string(const json_doc_t *doc, int parent, const char *path, char *buffer, size_t size) {
+    json_view_t view;
+    if (size == 0 || json_get_view(doc, parent, path, &view) != 0) return -1;
+    unescape(view.ptr, view.len, buffer, size);
+    return 0;
+}
+
+int json_get_double(const json_doc_t *doc, int parent, const char *path, double *value) {
+    const json_token_t *token = find_typed(doc, parent, path, JSON_NUMBER);
+    if (!token) return -1;
+    // The token is always followed by a non-numeric byte, so strtod stops at its end
+    *value = strtod(doc->text + token->start, NULL);
+    return 0;
+}
+
+int json_get_int(const json_doc_t *doc, int parent, const char *path, int *value) {
+    double number;
+    if (json_get_double(doc, parent, path, &number) != 0) return -1;
+    *value = (int)number;
+    return 0;
+}
+
+int json_get_bool(const json_doc_t *doc, int parent, const char *path, bool *value) {
+    const json_token_t *token = find_typed(doc, parent, path, JSON_BOOL);
+    if (!token) return -1;
+    *value = doc->text[token->start] == 't';
+    return 0;
+}
+
+// Extract array of strings; non-string elements are skipped
+int json_get_string_array(const json_doc_t *doc, int parent, const char *path, char results[][64], int max_items) {
+    const json_token_t *array = find_typed(doc, parent, path, JSON_ARRAY);
+    if (!array) return 0;
+
     int count = 0;
-    while (*start && *start != ']' && count < max_items) {
-        // Skip whitespace and commas
-        while (*start == ' ' || *start == '\t' || *start == '\n' || *start == ',') start++;
-        
-        if (*start == '"') {
-            start++; // Skip opening quote
-            char *end = strchr(start, '"');
-            if (!end) break;
-            
-            int len = end - start;
-            if (len >= 64) len = 63;
-            strncpy(results[count], start, len);
-            results[count][len] = '\0';
-            count++;
-            
-            start = end + 1;
-        } else {
-            break;
+    size_t child = (array - doc->tokens) + 1;
+    for (uint32_t i = 0; i < array->size && count < max_items; i++) {
+        const json_token_t *token = &doc->tokens[child];
+        if (token->type == JSON_STRING) {
+            unescape(doc->text + token->start, token->end - token->start, results[count++], 64);
         }
+        child = token->next;
     }
-    
     return count;
-}
\ No newline at end of file
+}
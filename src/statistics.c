@@ -42,27 +42,244 @@ double compute_robust_z_score(double value, double median, double mad) {
     return (value - median) / adjusted_mad;
 }
 
+// Fill in the per-feature scoring constants after a baseline is loaded or computed
+void prepare_baseline_scoring(baseline_t *baseline) {
+    const double epsilon = 1e-9;
+    baseline->energy_mask = 0;
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        baseline_stats_t *stats = (baseline_stats_t *)((char *)baseline + feature_table[f].baseline_offset);
+        stats->inv_mad = 1.0 / ((stats->mad < epsilon) ? epsilon : stats->mad);
+        if ((ENERGY_FEATURE_MASK & (1u << f)) && stats->samples > 0) baseline->energy_mask |= 1u << f;
+    }
+    prepare_phase_scoring(baseline);
+}
+
+static double sorted_median(const double *sorted, int count) {
+    return (count % 2 == 0) ? (sorted[count/2 - 1] + sorted[count/2]) / 2.0 : sorted[count/2];
+}
+
+// Distribution-free 95% interval for the median of sorted data: the order
+// statistics at n/2 -+ 1.96 sqrt(n)/2 (normal approximation to the binomial).
+// Returns the half-width.
+static double median_ci_halfwidth(const double *sorted, int count) {
+    double spread = 1.96 * sqrt((double)count) / 2.0;
+    int lo = (int)floor(count / 2.0 - spread);
+    int hi = (int)ceil(count / 2.0 + spread);
+    if (lo < 0) lo = 0;
+    if (hi > count - 1) hi = count - 1;
+    return (sorted[hi] - sorted[lo]) / 2.0;
+}
+
 int compute_baseline_stats(baseline_stats_t *stats, double *values, int count) {
+    memset(stats, 0, sizeof(baseline_stats_t));
     if (count == 0) {
-        memset(stats, 0, sizeof(baseline_stats_t));
         return -1;
     }
     
-    stats->median = compute_median(values, count);
-    stats->mad = compute_mad(values, count, stats->median);
-    stats->samples = count;
+    double *sorted = malloc(count * sizeof(double));
+    if (!sorted) return -1;
+    memcpy(sorted, values, count * sizeof(double));
+    qsort(sorted, count, sizeof(double), compare_doubles);
     
-    // Find min and max
-    stats->min = values[0];
-    stats->max = values[0];
-    for (int i = 1; i < count; i++) {
-        if (values[i] < stats->min) stats->min = values[i];
-        if (values[i] > stats->max) stats->max = values[i];
+    stats->median = sorted_median(sorted, count);
+    stats->median_ci = median_ci_halfwidth(sorted, count);
+    stats->min = sorted[0];
+    stats->max = sorted[count - 1];
+    
+    // The MAD is the median of the absolute deviations, so the same bound
+    // applies to them. It ignores the uncertainty in the median itself.
+    for (int i = 0; i < count; i++) {
+        sorted[i] = fabs(values[i] - stats->median);
     }
+    qsort(sorted, count, sizeof(double), compare_doubles);
+    stats->mad = sorted_median(sorted, count);
+    stats->mad_ci = median_ci_halfwidth(sorted, count);
     
+    stats->samples = count;
+    stats->inv_mad = 1.0 / ((stats->mad < 1e-9) ? 1e-9 : stats->mad);
+    
+    free(sorted);
     return 0;
 }
 
+// Worst confidence half-width over all features, in units of the feature's
+// MAD: the error it would introduce into a robust z-score. Features with a
+// zero MAD count as precise only if their intervals are zero as well.
+double baseline_precision(const baseline_t *baseline) {
+    double worst = 0.0;
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        if ((ENERGY_FEATURE_MASK & ~baseline->energy_mask) & (1u << f)) continue;
+        const baseline_stats_t *stats =
+            (const baseline_stats_t *)((const char *)baseline + feature_table[f].baseline_offset);
+        double width = fmax(stats->median_ci, stats->mad_ci);
+        double precision = stats->mad > 1e-12 ? width / stats->mad : (width > 0.0 ? INFINITY : 0.0);
+        if (precision > worst) worst = precision;
+    }
+    return worst;
+}
+
+// Two-sample Kolmogorov-Smirnov test. Returns the asymptotic p-value and
+// stores the D statistic (largest gap between the empirical CDFs), or NAN
+// for both if the samples could not be copied.
+double ks_two_sample(const double *a, int n, const double *b, int m, double *statistic) {
+    if (n == 0 || m == 0) {
+        if (statistic) *statistic = 0.0;
+        return 1.0;
+    }
+    
+    double *x = malloc(n * sizeof(double));
+    double *y = malloc(m * sizeof(double));
+    if (!x || !y) {
+        free(x);
+        free(y);
+        if (statistic) *statistic = NAN;
+        return NAN;
+    }
+    memcpy(x, a, n * sizeof(double));
+    memcpy(y, b, m * sizeof(double));
+    qsort(x, n, sizeof(double), compare_doubles);
+    qsort(y, m, sizeof(double), compare_doubles);
+    
+    double d = 0.0;
+    int i = 0, j = 0;
+    while (i < n && j < m) {
+        double v = x[i] <= y[j] ? x[i] : y[j];
+        while (i < n && x[i] <= v) i++;
+        while (j < m && y[j] <= v) j++;
+        double gap = fabs((double)i / n - (double)j / m);
+        if (gap > d) d = gap;
+    }
+    free(x);
+    free(y);
+    if (statistic) *statistic = d;
+    
+    // Kolmogorov distribution with the Stephens small-sample correction
+    double en = sqrt((double)n * m / (n + m));
+    double lambda = (en + 0.12 + 0.11 / en) * d;
+    if (lambda < 1e-3) return 1.0;
+    double p = 0.0, sign = 1.0;
+    for (int k = 1; k <= 100; k++) {
+        double term = sign * exp(-2.0 * k * k * lambda * lambda);
+        p += term;
+        if (fabs(term) < 1e-10) break;
+        sign = -sign;
+    }
+    p *= 2.0;
+    return p < 0.0 ? 0.0 : (p > 1.0 ? 1.0 : p);
+}
+
+typedef struct {
+    double value;
+    int group;
+} ranked_value_t;
+
+static int compare_ranked(const void *a, const void *b) {
+    double diff = ((const ranked_value_t *)a)->value - ((const ranked_value_t *)b)->value;
+    return (diff > 0) - (diff < 0);
+}
+
+// Mann-Whitney U test (normal approximation with tie and continuity
+// corrections). Returns the two-sided p-value and stores the z score; NAN
+// if the samples could not be ranked.
+double mann_whitney_u(const double *a, int n, const double *b, int m, double *z_score) {
+    if (z_score) *z_score = 0.0;
+    if (n == 0 || m == 0) return 1.0;
+    
+    int total = n + m;
+    ranked_value_t *all = malloc(total * sizeof(ranked_value_t));
+    if (!all) {
+        if (z_score) *z_score = NAN;
+        return NAN;
+    }
+    for (int i = 0; i < n; i++) all[i] = (ranked_value_t){a[i], 0};
+    for (int j = 0; j < m; j++) all[n + j] = (ranked_value_t){b[j], 1};
+    qsort(all, total, sizeof(ranked_value_t), compare_ranked);
+    
+    double rank_sum = 0.0, tie_term = 0.0;
+    for (int i = 0; i < total; ) {
+        int k = i;
+        while (k < total && all[k].value == all[i].value) k++;
+        double rank = (i + 1 + k) / 2.0;   // average of ranks i+1 .. k
+        for (int t = i; t < k; t++) {
+            if (all[t].group == 0) rank_sum += rank;
+        }
+        double ties = k - i;
+        tie_term += ties * ties * ties - ties;
+        i = k;
+    }
+    free(all);
+    
+    double u = rank_sum - (double)n * (n + 1) / 2.0;
+    double mean = (double)n * m / 2.0;
+    double variance = (double)n * m / 12.0 * ((total + 1) - tie_term / ((double)total * (total - 1)));
+    if (variance <= 0.0) return 1.0;
+    
+    double diff = fabs(u - mean) - 0.5;
+    double z = (diff > 0.0 ? diff : 0.0) / sqrt(variance);
+    if (z_score) *z_score = u >= mean ? z : -z;
+    return erfc(z / sqrt(2.0));
+}
+
+// Regularized incomplete beta function I_x(a, b), Lentz's continued fraction
+static double incomplete_beta(double a, double b, double x) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    if (x > (a + 1.0) / (a + b + 2.0)) return 1.0 - incomplete_beta(b, a, 1.0 - x);
+    
+    double front = exp(lgamma(a + b) - lgamma(a) - lgamma(b) + a * log(x) + b * log1p(-x)) / a;
+    double f = 1.0, c = 1.0, d = 0.0;
+    for (int i = 0; i <= 200; i++) {
+        int m = i / 2;
+        double numerator;
+        if (i == 0) numerator = 1.0;
+        else if (i % 2 == 0) numerator = (m * (b - m) * x) / ((a + 2.0 * m - 1.0) * (a + 2.0 * m));
+        else numerator = -((a + m) * (a + b + m) * x) / ((a + 2.0 * m) * (a + 2.0 * m + 1.0));
+        
+        d = 1.0 + numerator * d;
+        if (fabs(d) < 1e-30) d = 1e-30;
+        d = 1.0 / d;
+        c = 1.0 + numerator / c;
+        if (fabs(c) < 1e-30) c = 1e-30;
+        f *= c * d;
+        if (fabs(1.0 - c * d) < 1e-12) break;
+    }
+    return front * (f - 1.0);
+}
+
+// Welch's unequal-variance t-test from summary statistics. Returns the
+// two-sided p-value and stores t (positive when a's mean is larger).
+double welch_t_test(double mean_a, double var_a, int n, double mean_b, double var_b, int m,
+                    double *t_stat) {
+    if (t_stat) *t_stat = 0.0;
+    if (n < 2 || m < 2) return 1.0;
+    
+    double se_a = var_a / n, se_b = var_b / m;
+    double se = se_a + se_b;
+    if (se <= 0.0) return mean_a == mean_b ? 1.0 : 0.0;
+    
+    double t = (mean_a - mean_b) / sqrt(se);
+    double df = se * se / (se_a * se_a / (n - 1) + se_b * se_b / (m - 1));
+    if (t_stat) *t_stat = t;
+    return incomplete_beta(df / 2.0, 0.5, df / (df + t * t));
+}
+
+// Two-sided Student t critical value: P(|T| > t) = 1 - confidence with df
+// degrees of freedom (df may be fractional, as from Welch's test)
+double student_t_quantile(double confidence, double df) {
+    if (df <= 0.0 || confidence <= 0.0) return 0.0;
+    if (confidence >= 1.0) return INFINITY;
+    
+    double alpha = 1.0 - confidence;
+    double lo = 0.0, hi = 1.0;
+    while (incomplete_beta(df / 2.0, 0.5, df / (df + hi * hi)) > alpha && hi < 1e6) hi *= 2.0;
+    for (int i = 0; i < 100 && hi - lo > 1e-9 * hi; i++) {
+        double mid = 0.5 * (lo + hi);
+        if (incomplete_beta(df / 2.0, 0.5, df / (df + mid * mid)) > alpha) lo = mid;
+        else hi = mid;
+    }
+    return 0.5 * (lo + hi);
+}
+
 int engineer_features(hpc_measurement_t *measurements, int count, feature_vector_t *features) {
     if (!measurements || !features || count <= 0) return -1;
     
@@ -70,6 +287,8 @@ int engineer_features(hpc_measurement_t *measurements, int count, feature_vector
     uint64_t cycles = 0, instructions = 0, branches = 0, branch_misses = 0;
     uint64_t cache_refs = 0, cache_misses = 0, l1d_misses = 0;
     uint64_t itlb_misses = 0, dtlb_misses = 0;
+    uint64_t energy_uj[3] = {0};   // package, cores, DRAM, from the energy meter
+    uint32_t energy_found = 0;
     
     int counters_found = 0;
     
@@ -112,14 +331,27 @@ int engineer_features(hpc_measurement_t *measurements, int count, feature_vector
         } else if (strcmp(counter, "dTLB-load-misses") == 0) {
             dtlb_misses = value;
             counters_found++;
+        } else if (strcmp(counter, "energy-pkg") == 0) {
+            energy_uj[0] = value;
+            energy_found |= 1u << FEATURE_PACKAGE_JOULES | 1u << FEATURE_NJ_PER_INSTRUCTION;
+        } else if (strcmp(counter, "energy-cores") == 0) {
+            energy_uj[1] = value;
+            energy_found |= 1u << FEATURE_CORE_JOULES;
+        } else if (strcmp(counter, "energy-ram") == 0) {
+            energy_uj[2] = value;
+            energy_found |= 1u << FEATURE_DRAM_JOULES;
         }
     }
     
-    // Debug: show what counters we found
+    // Debug: show what counters we found (disabled for production)
+    #ifdef DEBUG_PARSING
     fprintf(stderr, "Feature engineering: found %d counters out of %d measurements\n", 
             counters_found, count);
     fprintf(stderr, "  cycles=%lu, instructions=%lu, branches=%lu\n", 
             cycles, instructions, branches);
+    #else
+    (void)counters_found;
+    #endif
     
     // Check minimum required counters
     if (cycles == 0 || instructions == 0) {
@@ -130,7 +362,9 @@ int engineer_features(hpc_measurement_t *measurements, int count, feature_vector
     
     // Initialize feature vector
     memset(features, 0, sizeof(feature_vector_t));
-    features->wall_time = (double)time(NULL);
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    features->wall_time = now.tv_sec + now.tv_nsec / 1e9;
     
     // Compute IPC (Instructions Per Cycle)
     features->ipc = (double)instructions / (double)cycles;
@@ -161,10 +395,19 @@ int engineer_features(hpc_measurement_t *measurements, int count, feature_vector
         features->dtlb_mpki = 0.0;
     }
     
-    // Debug output
+    // Energy over the same interval; 1 uJ per instruction is 1000 nJ
+    features->package_joules = energy_uj[0] / 1e6;
+    features->core_joules = energy_uj[1] / 1e6;
+    features->dram_joules = energy_uj[2] / 1e6;
+    features->nj_per_instruction = energy_uj[0] * 1e3 / (double)instructions;
+    features->energy_mask = energy_found;
+    
+    // Debug output, off by default: a line per interval dominates the cost
+    #ifdef DEBUG_PARSING
     fprintf(stderr, "Computed features: IPC=%.3f, BMR=%.4f, CMR=%.4f, L1D=%.2f, iTLB=%.2f, dTLB=%.2f\n",
             features->ipc, features->branch_miss_rate, features->cache_miss_rate,
             features->l1d_mpki, features->itlb_mpki, features->dtlb_mpki);
+    #endif
     
     return 0;
 }
\ No newline at end of file
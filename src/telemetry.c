@@ -0,0 +1,228 @@
+#include "hpc_ids.h"
+#include <sys/mman.h>
+
+// Publisher side runs in hpc_ids; hpc_ids_top maps the same segment
+// read-only and copies slots out with telemetry_snapshot.
+
+#define SNAPSHOT_RETRIES 64
+
+static double realtime_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Pid of the hpc_ids still publishing under name, 0 if the segment is
+// missing, unreadable or left behind by a process that has exited
+static pid_t segment_owner(const char *name) {
+    int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return 0;
+    telemetry_header_t header;
+    ssize_t got = read(fd, &header, sizeof(header));
+    close(fd);
+    if (got != (ssize_t)sizeof(header) || header.magic != TELEMETRY_MAGIC || header.pid <= 0) return 0;
+
+    pid_t pid = (pid_t)header.pid;
+    if (pid == getpid()) return 0;
+    return kill(pid, 0) == 0 || errno == EPERM ? pid : 0;
+}
+
+// Replaces a segment left behind by an earlier run: readers that still map
+// the old one keep a consistent (frozen) view, new readers find this one.
+// A segment whose hpc_ids is still running is left alone.
+int telemetry_open(telemetry_t *telemetry, const char *name) {
+    memset(telemetry, 0, sizeof(telemetry_t));
+    if (name[0] != '/' || strchr(name + 1, '/')) {
+        fprintf(stderr, "Warning: telemetry_shm must look like /name, got '%s'\n", name);
+        return -1;
+    }
+
+    pid_t owner = segment_owner(name);
+    if (owner) {
+        fprintf(stderr, "Warning: telemetry segment %s is in use by pid %d, not publishing\n",
+                name, (int)owner);
+        return -1;
+    }
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Warning: cannot create telemetry segment %s: %s\n", name, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || ftruncate(fd, sizeof(telemetry_segment_t)) != 0) {
+        fprintf(stderr, "Warning: cannot size telemetry segment %s: %s\n", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    telemetry_segment_t *segment = mmap(NULL, sizeof(telemetry_segment_t), PROT_READ | PROT_WRITE,
+                                        MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) {
+        fprintf(stderr, "Warning: cannot map telemetry segment %s: %s\n", name, strerror(errno));
+        shm_unlink(name);
+        return -1;
+    }
+
+    // Fresh pages are zero: every slot is inactive with an even sequence
+    telemetry_header_t *header = &segment->header;
+    header->version = TELEMETRY_VERSION;
+    header->num_slots = TELEMETRY_SLOTS;
+    header->slot_size = sizeof(telemetry_slot_t);
+    header->num_features = NUM_FEATURES;
+    header->pid = (int32_t)getpid();
+    header->started = realtime_seconds();
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        snprintf(header->feature_names[f], sizeof(header->feature_names[f]), "%s", feature_table[f].name);
+    }
+    // Readers check the magic last, so a half-written header is never used
+    __atomic_store_n(&header->magic, TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+
+    telemetry->segment = segment;
+    telemetry->inode = st.st_ino;
+    snprintf(telemetry->name, sizeof(telemetry->name), "%s", name);
+    printf("Publishing live telemetry to shared memory %s\n", name);
+    return 0;
+}
+
+void telemetry_close(telemetry_t *telemetry) {
+    if (!telemetry->segment) return;
+    munmap(telemetry->segment, sizeof(telemetry_segment_t));
+    telemetry->segment = NULL;
+
+    // Leave the name alone if a later hpc_ids has taken it over
+    int fd = shm_open(telemetry->name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return;
+    struct stat st;
+    bool ours = fstat(fd, &st) == 0 && st.st_ino == telemetry->inode;
+    close(fd);
+    if (ours) shm_unlink(telemetry->name);
+}
+
+static void slot_write_begin(telemetry_slot_t *slot) {
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void slot_write_end(telemetry_slot_t *slot) {
+    __atomic_store_n(&slot->seq, slot->seq + 1, __ATOMIC_RELEASE);
+}
+
+// A free slot for target, NULL if not publishing or all are taken. Slots
+// of finished targets keep their last values until reused.
+telemetry_slot_t* telemetry_claim(telemetry_t *telemetry, const target_state_t *target) {
+    if (!telemetry->segment) return NULL;
+    for (int s = 0; s < TELEMETRY_SLOTS; s++) {
+        telemetry_slot_t *slot = &telemetry->segment->slots[s];
+        uint32_t inactive = 0;
+        if (!__atomic_compare_exchange_n(&slot->active, &inactive, 1, false,
+                                         __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            continue;
+        }
+        slot_write_begin(slot);
+        uint32_t seq = slot->seq;
+        memset((char *)slot + sizeof(slot->seq), 0, sizeof(telemetry_slot_t) - sizeof(slot->seq));
+        slot->seq = seq;
+        slot->active = 1;
+        snprintf(slot->target, sizeof(slot->target), "%s", target->label);
+        snprintf(slot->name, sizeof(slot->name), "%s", target->name);
+        slot->updated = realtime_seconds();
+        slot_write_end(slot);
+        return slot;
+    }
+    fprintf(stderr, "Warning: all %d telemetry slots in use, %s is not published\n",
+            TELEMETRY_SLOTS, target->label);
+    return NULL;
+}
+
+void telemetry_release(telemetry_slot_t *slot) {
+    slot_write_begin(slot);
+    slot->updated = realtime_seconds();
+    slot_write_end(slot);
+    __atomic_store_n(&slot->active, 0, __ATOMIC_RELEASE);
+}
+
+// Called by the scoring stage after each scored interval. Only this thread
+// writes the slot; the copy is a few hundred bytes and no system call.
+void telemetry_publish(const pipeline_t *pipeline, const feature_vector_t *features, int anomalies) {
+    telemetry_slot_t *slot = pipeline->telemetry;
+    const target_state_t *target = pipeline->target;
+
+    slot_write_begin(slot);
+    uint32_t present = 0;
+    for (int f = 0; f < NUM_FEATURES; f++) {
+        slot->features[f] = *(const double *)((const char *)features + feature_table[f].value_offset);
+        slot->z_scores[f] = target->last_z[f];
+        if (!isnan(target->last_z[f])) present |= 1u << f;
+    }
+    slot->present_mask = present;
+    slot->phase = target->last_phase;
+    slot->severity = target->last_feature >= 0 ? get_severity_level(target->last_max_z, &pipeline->ids->config) : 0;
+    slot->anomalies = (uint32_t)anomalies;
+    slot->total_anomalies += (uint64_t)anomalies;
+    slot->sequence++;
+    slot->timestamp = target->time_base + features->wall_time;
+    slot->updated = realtime_seconds();
+
+    for (int s = 0; s < PIPELINE_STAGES; s++) {
+        slot->stage_processed[s] = __atomic_load_n(&pipeline->stages[s].processed, __ATOMIC_RELAXED);
+        slot->stage_busy_ns[s] = __atomic_load_n(&pipeline->stages[s].busy_ns, __ATOMIC_RELAXED);
+    }
+    if (pipeline->threaded) {
+        slot->queue_depth[STAGE_FEATURES] = (uint32_t)spsc_ring_depth(&pipeline->intervals);
+        slot->queue_capacity[STAGE_FEATURES] = (uint32_t)pipeline->intervals.capacity;
+        slot->queue_depth[STAGE_SCORING] = (uint32_t)spsc_ring_depth(&pipeline->features);
+        slot->queue_capacity[STAGE_SCORING] = (uint32_t)pipeline->features.capacity;
+    }
+    const alert_writer_t *writer = &pipeline->ids->alert_writer;
+    if (writer->running) {
+        size_t tail = __atomic_load_n(&writer->tail, __ATOMIC_ACQUIRE);
+        slot->queue_depth[STAGE_OUTPUT] = (uint32_t)(__atomic_load_n(&writer->head, __ATOMIC_ACQUIRE) - tail);
+        slot->queue_capacity[STAGE_OUTPUT] = (uint32_t)writer->capacity;
+        slot->stage_processed[STAGE_OUTPUT] = __atomic_load_n(&writer->written, __ATOMIC_RELAXED);
+    }
+    slot_write_end(slot);
+}
+
+// Map a published segment read-only. NULL if there is none or its layout
+// is not the one this build knows.
+const telemetry_segment_t* telemetry_map(const char *name, size_t *size) {
+    int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(telemetry_segment_t)) {
+        close(fd);
+        return NULL;
+    }
+    const telemetry_segment_t *segment = mmap(NULL, sizeof(telemetry_segment_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED) return NULL;
+
+    const telemetry_header_t *header = &segment->header;
+    if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) != TELEMETRY_MAGIC ||
+        header->version != TELEMETRY_VERSION || header->num_slots != TELEMETRY_SLOTS ||
+        header->slot_size != sizeof(telemetry_slot_t) || header->num_features != NUM_FEATURES) {
+        munmap((void *)segment, sizeof(telemetry_segment_t));
+        return NULL;
+    }
+    *size = sizeof(telemetry_segment_t);
+    return segment;
+}
+
+// Consistent copy of a slot. Retries while the writer is inside or moved
+// on during the copy; false if it never settled (e.g. the writer died
+// mid-update).
+bool telemetry_snapshot(const telemetry_slot_t *slot, telemetry_slot_t *copy) {
+    for (int attempt = 0; attempt < SNAPSHOT_RETRIES; attempt++) {
+        uint32_t before = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (before & 1) {
+            sched_yield();
+            continue;
+        }
+        memcpy(copy, slot, sizeof(telemetry_slot_t));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == before) return true;
+    }
+    return false;
+}
@@ -0,0 +1,161 @@
+#include "hpc_ids.h"
+
+#define SYSFS_CPU "/sys/devices/system/cpu"
+
+// Parse a kernel cpulist ("0-3,8,10-11") into set. Returns the CPU count or -1.
+int parse_cpu_list(const char *list, cpu_set_t *set) {
+    CPU_ZERO(set);
+    const char *p = list;
+    while (*p && *p != '\n') {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= CPU_SETSIZE) return -1;
+        long last = first;
+        if (*end == '-') {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first || last >= CPU_SETSIZE) return -1;
+        }
+        for (long cpu = first; cpu <= last; cpu++) CPU_SET(cpu, set);
+        p = end;
+        if (*p == ',') p++;
+        else if (*p && *p != '\n') return -1;
+    }
+    return CPU_COUNT(set);
+}
+
+static int read_sysfs_line(const char *path, char *buffer, size_t size) {
+    FILE *file = fopen(path, "r");
+    if (!file) return -1;
+    char *line = fgets(buffer, size, file);
+    fclose(file);
+    return line ? 0 : -1;
+}
+
+// Lowest CPU in a sysfs cpulist file, used as a stable id for the group
+static int first_cpu_in(const char *path) {
+    char line[4096];
+    cpu_set_t set;
+    if (read_sysfs_line(path, line, sizeof(line)) != 0 || parse_cpu_list(line, &set) <= 0) return -1;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &set)) return cpu;
+    }
+    return -1;
+}
+
+static int llc_group(int cpu) {
+    // The last-level cache is the highest cache index with the highest level
+    char path[MAX_PATH_LEN];
+    int best_level = 0, group = -1;
+    for (int index = 0; index < 8; index++) {
+        char line[32];
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/cache/index%d/level", cpu, index);
+        if (read_sysfs_line(path, line, sizeof(line)) != 0) break;
+        int level = atoi(line);
+        if (level >= best_level) {
+            snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/cache/index%d/shared_cpu_list", cpu, index);
+            int first = first_cpu_in(path);
+            if (first >= 0) {
+                best_level = level;
+                group = first;
+            }
+        }
+    }
+    return group;
+}
+
+// Describe the CPUs this process may run on. Each CPU gets the lowest
+// sibling of its physical core and of its last-level cache as group ids,
+// so SMT siblings and LLC sharers compare equal. Without sysfs topology
+// every CPU is treated as its own core and cache. allowed restricts the
+// CPUs considered; NULL means the calling thread's current affinity.
+int topology_load(cpu_topology_t *topology, const cpu_set_t *allowed_cpus) {
+    memset(topology, 0, sizeof(cpu_topology_t));
+
+    cpu_set_t allowed;
+    if (allowed_cpus) {
+        allowed = *allowed_cpus;
+    } else if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        perror("sched_getaffinity");
+        return -1;
+    }
+
+    char line[4096];
+    cpu_set_t isolated;
+    if (read_sysfs_line(SYSFS_CPU "/isolated", line, sizeof(line)) == 0 &&
+        parse_cpu_list(line, &isolated) > 0) {
+        topology->has_isolated = true;
+    } else {
+        CPU_ZERO(&isolated);
+    }
+
+    bool missing = false;
+    char path[MAX_PATH_LEN];
+    for (int cpu = 0; cpu < CPU_SETSIZE && topology->num_cpus < MAX_CPUS; cpu++) {
+        // isolcpus CPUs are outside the default affinity mask but usable when pinned
+        if (!CPU_ISSET(cpu, &allowed) && !CPU_ISSET(cpu, &isolated)) continue;
+
+        cpu_info_t *info = &topology->cpus[topology->num_cpus++];
+        info->cpu = cpu;
+        info->isolated = CPU_ISSET(cpu, &isolated);
+
+        snprintf(path, sizeof(path), SYSFS_CPU "/cpu%d/topology/thread_siblings_list", cpu);
+        info->core_id = first_cpu_in(path);
+        info->llc_id = llc_group(cpu);
+        if (info->core_id < 0) {
+            info->core_id = cpu;
+            missing = true;
+        }
+        if (info->llc_id < 0) info->llc_id = info->core_id;
+    }
+
+    if (missing) {
+        fprintf(stderr, "Warning: CPU topology unavailable, assuming no SMT or shared caches\n");
+    }
+    return topology->num_cpus;
+}
+
+const cpu_info_t* topology_find(const cpu_topology_t *topology, int cpu) {
+    for (int i = 0; i < topology->num_cpus; i++) {
+        if (topology->cpus[i].cpu == cpu) return &topology->cpus[i];
+    }
+    return NULL;
+}
+
+// Pick at most max_cpus CPUs so that no two share a physical core
+// (ISOLATION_SMT) or a last-level cache (ISOLATION_LLC). Kernel-isolated
+// CPUs are used exclusively when there are any.
+int topology_select_cpus(const cpu_topology_t *topology, isolation_policy_t policy,
+                         int *cpus, int max_cpus) {
+    int count = 0;
+    for (int i = 0; i < topology->num_cpus && count < max_cpus; i++) {
+        const cpu_info_t *info = &topology->cpus[i];
+        if (topology->has_isolated && !info->isolated) continue;
+
+        bool conflict = false;
+        for (int j = 0; j < count && !conflict; j++) {
+            const cpu_info_t *taken = topology_find(topology, cpus[j]);
+            if (policy == ISOLATION_SMT) conflict = taken->core_id == info->core_id;
+            if (policy == ISOLATION_LLC) conflict = taken->llc_id == info->llc_id;
+        }
+        if (!conflict) cpus[count++] = info->cpu;
+    }
+    return count;
+}
+
+int parse_isolation_policy(const char *name, isolation_policy_t *policy) {
+    if (strcmp(name, "none") == 0) *policy = ISOLATION_NONE;
+    else if (strcmp(name, "smt") == 0) *policy = ISOLATION_SMT;
+    else if (strcmp(name, "llc") == 0) *policy = ISOLATION_LLC;
+    else return -1;
+    return 0;
+}
+
+const char* isolation_policy_name(isolation_policy_t policy) {
+    switch (policy) {
+        case ISOLATION_NONE: return "none";
+        case ISOLATION_SMT:  return "smt";
+        case ISOLATION_LLC:  return "llc";
+    }
+    return "unknown";
+}
@@ -0,0 +1,347 @@
+#include "hpc_ids.h"
+#include "byte_io.h"
+#include <sys/mman.h>
+
+// Consecutive interval counts of one event differ by a few percent, so the
+// zig-zagged delta usually fits in two or three varint bytes
+static uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ (uint64_t)-(int64_t)(delta >> 63);
+}
+
+static uint64_t unzigzag(uint64_t value) {
+    return (value >> 1) ^ (uint64_t)-(int64_t)(value & 1);
+}
+
+static size_t put_varint(uint8_t *p, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+// Returns bytes consumed, 0 if the varint runs past end or is too long
+static size_t get_varint(const uint8_t *p, const uint8_t *end, uint64_t *value) {
+    uint64_t v = 0;
+    for (size_t n = 0; n < 10 && p + n < end; n++) {
+        v |= (uint64_t)(p[n] & 0x7f) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *value = v;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+// With energy, the meter's pseudo-counters get columns after the perf
+// events (when they fit), so replaying the trace reproduces energy features
+int trace_writer_open(trace_writer_t *writer, const char *path, const char *target,
+                      const config_t *config, bool energy) {
+    memset(writer, 0, sizeof(trace_writer_t));
+    writer->num_events = config->num_events;
+    for (int e = 0; e < config->num_events; e++) {
+        strcpy(writer->events[e], config->perf_events[e]);
+    }
+    if (energy && writer->num_events + ENERGY_EVENTS <= MAX_EVENTS) {
+        strcpy(writer->events[writer->num_events++], "energy-pkg");
+        strcpy(writer->events[writer->num_events++], "energy-cores");
+        strcpy(writer->events[writer->num_events++], "energy-ram");
+    }
+
+    // Header: magic, version, event count, block size, start time, then
+    // length-prefixed target and event names
+    uint8_t header[TRACE_HEADER_SIZE + 256 + MAX_EVENTS * 64];
+    memset(header, 0, TRACE_HEADER_SIZE);
+    memcpy(header, TRACE_MAGIC, strlen(TRACE_MAGIC));
+    put_u16(header + 8, TRACE_VERSION);
+    put_u16(header + 10, (uint16_t)writer->num_events);
+    put_u32(header + 12, TRACE_BLOCK_INTERVALS);
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    put_u64(header + 16, (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec);
+    put_u32(header + 24, (uint32_t)config->sampling_interval_ms);
+
+    size_t len = TRACE_HEADER_SIZE;
+    size_t target_len = strnlen(target, 255);
+    header[len++] = (uint8_t)target_len;
+    memcpy(header + len, target, target_len);
+    len += target_len;
+    for (int e = 0; e < writer->num_events; e++) {
+        size_t name_len = strnlen(writer->events[e], 63);
+        header[len++] = (uint8_t)name_len;
+        memcpy(header + len, writer->events[e], name_len);
+        len += name_len;
+    }
+    put_u32(header + 28, (uint32_t)len);
+
+    writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (writer->fd < 0) {
+        fprintf(stderr, "Cannot create counter trace %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    if (write_all(writer->fd, header, len) != 0) {
+        close(writer->fd);
+        writer->fd = -1;
+        return -1;
+    }
+    writer->bytes = len;
+    return 0;
+}
+
+// Column-major block: time, presence mask, then one column per event. Each
+// column starts from an absolute value so blocks decode independently; the
+// footer gives every column's byte length and min/max, so readers can skip
+// whole blocks or columns without decoding them.
+static int trace_writer_flush(trace_writer_t *writer) {
+    if (writer->count == 0) return 0;
+
+    int columns = TRACE_FIXED_COLUMNS + writer->num_events;
+    uint8_t footer[(TRACE_FIXED_COLUMNS + MAX_EVENTS) * TRACE_FOOTER_ENTRY];
+    uint8_t *payload = writer->buffer + TRACE_BLOCK_HEADER;
+    size_t len = 0;
+
+    for (int c = 0; c < columns; c++) {
+        const uint64_t *column = c == 0 ? writer->times : c == 1 ? writer->masks
+                               : writer->values[c - TRACE_FIXED_COLUMNS];
+        uint64_t bit = c >= TRACE_FIXED_COLUMNS ? 1ULL << (c - TRACE_FIXED_COLUMNS) : 0;
+        uint64_t min = UINT64_MAX, max = 0, previous = 0;
+        size_t start = len;
+        for (uint32_t i = 0; i < writer->count; i++) {
+            len += put_varint(payload + len, zigzag(column[i] - previous));
+            previous = column[i];
+            if (bit && !(writer->masks[i] & bit)) continue;
+            if (column[i] < min) min = column[i];
+            if (column[i] > max) max = column[i];
+        }
+        uint8_t *entry = footer + c * TRACE_FOOTER_ENTRY;
+        put_u32(entry, (uint32_t)(len - start));
+        put_u64(entry + 4, min);
+        put_u64(entry + 12, max);
+    }
+
+    size_t footer_len = columns * TRACE_FOOTER_ENTRY;
+    memcpy(payload + len, footer, footer_len);
+    put_u32(writer->buffer, TRACE_BLOCK_MAGIC);
+    put_u32(writer->buffer + 4, writer->count);
+    put_u32(writer->buffer + 8, (uint32_t)len);
+    put_u32(writer->buffer + 12, (uint32_t)footer_len);
+
+    size_t total = TRACE_BLOCK_HEADER + len + footer_len;
+    writer->count = 0;
+    if (write_all(writer->fd, writer->buffer, total) != 0) {
+        writer->write_errors++;
+        return -1;
+    }
+    writer->blocks++;
+    writer->bytes += total;
+    return 0;
+}
+
+// Record one perf interval. Counters are matched to columns by name;
+// perf reports them in -e order, so the positional guess nearly always hits.
+int trace_writer_append(trace_writer_t *writer, const hpc_measurement_t *measurements, int count) {
+    if (writer->fd < 0 || count <= 0) return -1;
+
+    uint32_t i = writer->count;
+    uint64_t mask = 0;
+    for (int e = 0; e < writer->num_events; e++) {
+        writer->values[e][i] = i > 0 ? writer->values[e][i - 1] : 0;
+    }
+    for (int m = 0; m < count; m++) {
+        int e = m < writer->num_events && strcmp(measurements[m].counter, writer->events[m]) == 0 ? m : -1;
+        for (int k = 0; e < 0 && k < writer->num_events; k++) {
+            if (strcmp(measurements[m].counter, writer->events[k]) == 0) e = k;
+        }
+        if (e < 0) continue;
+        writer->values[e][i] = measurements[m].value;
+        mask |= 1ULL << e;
+    }
+    writer->times[i] = (uint64_t)llround(measurements[0].perf_time * 1e6);
+    writer->masks[i] = mask;
+    writer->intervals++;
+    writer->readings += count;
+
+    if (++writer->count == TRACE_BLOCK_INTERVALS) {
+        return trace_writer_flush(writer);
+    }
+    return 0;
+}
+
+void trace_writer_close(trace_writer_t *writer) {
+    if (writer->fd < 0) return;
+    trace_writer_flush(writer);
+    close(writer->fd);
+    writer->fd = -1;
+}
+
+void trace_writer_report(const trace_writer_t *writer) {
+    printf("Counter trace: %lu intervals in %lu blocks, %lu bytes (%.2f bytes per reading)%s\n",
+           (unsigned long)writer->intervals, (unsigned long)writer->blocks, (unsigned long)writer->bytes,
+           writer->readings ? (double)writer->bytes / writer->readings : 0.0,
+           writer->write_errors ? ", write errors" : "");
+}
+
+int trace_reader_open(trace_reader_t *reader, const char *path) {
+    memset(reader, 0, sizeof(trace_reader_t));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "Cannot open counter trace: %s\n", path);
+        return -1;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < TRACE_HEADER_SIZE) {
+        fprintf(stderr, "Not a counter trace: %s\n", path);
+        close(fd);
+        return -1;
+    }
+
+    void *data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        fprintf(stderr, "Cannot map counter trace: %s\n", path);
+        return -1;
+    }
+    // Blocks are decoded front to back exactly once
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    const uint8_t *header = data;
+    reader->data = data;
+    reader->size = st.st_size;
+    size_t header_len = get_u32(header + 28);
+    if (memcmp(header, TRACE_MAGIC, strlen(TRACE_MAGIC)) != 0 || get_u16(header + 8) != TRACE_VERSION ||
+        get_u16(header + 10) > MAX_EVENTS || get_u32(header + 12) != TRACE_BLOCK_INTERVALS ||
+        header_len > reader->size) {
+        fprintf(stderr, "Unsupported counter trace format: %s\n", path);
+        trace_reader_close(reader);
+        return -1;
+    }
+    reader->num_events = get_u16(header + 10);
+    reader->start_ns = get_u64(header + 16);
+    reader->sampling_interval_ms = get_u32(header + 24);
+
+    // Length-prefixed target and event names
+    size_t pos = TRACE_HEADER_SIZE;
+    for (int n = -1; n < reader->num_events; n++) {
+        if (pos >= header_len || pos + 1 + header[pos] > header_len) {
+            fprintf(stderr, "Truncated counter trace header: %s\n", path);
+            trace_reader_close(reader);
+            return -1;
+        }
+        size_t len = header[pos++];
+        char *name = n < 0 ? reader->target : reader->events[n];
+        memcpy(name, header + pos, len);
+        name[len] = '\0';
+        pos += len;
+    }
+    reader->offset = header_len;
+    return 0;
+}
+
+void trace_reader_close(trace_reader_t *reader) {
+    if (reader->data) {
+        munmap((void *)reader->data, reader->size);
+    }
+    reader->data = NULL;
+}
+
+// Decode the next block into reader->times/masks/values. Returns 1 if a
+// block was decoded, 0 at the end of the trace (including a block cut
+// short by a crash), -1 if the trace is corrupt.
+int trace_reader_next(trace_reader_t *reader) {
+    if (reader->offset + TRACE_BLOCK_HEADER > reader->size) return 0;
+
+    const uint8_t *block = reader->data + reader->offset;
+    uint32_t count = get_u32(block + 4);
+    size_t payload_len = get_u32(block + 8);
+    size_t footer_len = get_u32(block + 12);
+    int columns = TRACE_FIXED_COLUMNS + reader->num_events;
+    if (get_u32(block) != TRACE_BLOCK_MAGIC || count == 0 || count > TRACE_BLOCK_INTERVALS ||
+        footer_len != (size_t)columns * TRACE_FOOTER_ENTRY) {
+        fprintf(stderr, "Corrupt counter trace block at offset %zu\n", reader->offset);
+        return -1;
+    }
+    if (reader->offset + TRACE_BLOCK_HEADER + payload_len + footer_len > reader->size) return 0;
+
+    const uint8_t *p = block + TRACE_BLOCK_HEADER;
+    const uint8_t *footer = p + payload_len;
+    for (int c = 0; c < columns; c++) {
+        const uint8_t *entry = footer + c * TRACE_FOOTER_ENTRY;
+        const uint8_t *end = p + get_u32(entry);
+        uint64_t *column = c == 0 ? reader->times : c == 1 ? reader->masks
+                         : reader->values[c - TRACE_FIXED_COLUMNS];
+        if (end > footer) return -1;
+        uint64_t previous = 0;
+        for (uint32_t i = 0; i < count; i++) {
+            uint64_t encoded;
+            size_t n = get_varint(p, end, &encoded);
+            if (n == 0) {
+                fprintf(stderr, "Corrupt counter trace column at offset %zu\n", reader->offset);
+                return -1;
+            }
+            p += n;
+            previous += unzigzag(encoded);
+            column[i] = previous;
+        }
+        reader->min[c] = get_u64(entry + 4);
+        reader->max[c] = get_u64(entry + 12);
+        p = end;
+    }
+
+    reader->count = count;
+    reader->blocks++;
+    reader->intervals += count;
+    reader->offset += TRACE_BLOCK_HEADER + payload_len + footer_len;
+    return 1;
+}
+
+bool trace_file_detect(const char *path) {
+    char magic[8] = {0};
+    FILE *file = fopen(path, "rb");
+    if (!file) return false;
+    size_t n = fread(magic, 1, sizeof(magic), file);
+    fclose(file);
+    return n == sizeof(magic) && memcmp(magic, TRACE_MAGIC, strlen(TRACE_MAGIC)) == 0;
+}
+
+// Hand every recorded interval to on_interval as perf measurements, so a
+// trace replays through the same path as perf output. Returns the number of
+// counter readings, or -1 if the trace could not be read or held none.
+int stream_trace_file(const char *path, perf_interval_fn on_interval, void *context) {
+    trace_reader_t *reader = malloc(sizeof(trace_reader_t));
+    if (!reader || trace_reader_open(reader, path) != 0) {
+        free(reader);
+        return -1;
+    }
+
+    hpc_measurement_t interval[MAX_EVENTS];
+    int readings = 0;
+    bool stopped = false;
+    int status;
+    while (!stopped && (status = trace_reader_next(reader)) > 0) {
+        for (uint32_t i = 0; i < reader->count && !stopped; i++) {
+            int n = 0;
+            double perf_time = reader->times[i] / 1e6;
+            for (int e = 0; e < reader->num_events; e++) {
+                if (!(reader->masks[i] & (1ULL << e))) continue;
+                hpc_measurement_t *m = &interval[n++];
+                memset(m, 0, sizeof(*m));
+                m->perf_time = perf_time;
+                m->wall_time = reader->start_ns / 1e9 + perf_time;
+                m->duration_ms = reader->sampling_interval_ms;
+                m->value = reader->values[e][i];
+                strcpy(m->counter, reader->events[e]);
+            }
+            if (n == 0) continue;
+            readings += n;
+            stopped = on_interval(context, interval, n) != 0;
+        }
+    }
+
+    trace_reader_close(reader);
+    free(reader);
+    return readings > 0 ? readings : -1;
+}
@@ -0,0 +1,617 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <time.h>
+#include <getopt.h>
+
+// Synthetic workload with tunable branch entropy, working set, TLB spread
+// and code footprint, run as a schedule of phases. Anomalous behaviour can
+// be injected at a given second; every phase change and injection is
+// logged as a JSON line with its wall-clock time so alerts can be matched
+// against it.
+
+#define PAGE_BYTES 4096
+#define LINE_BYTES 64
+#define MAX_PHASES 16
+#define MAX_INJECTIONS 8
+#define CHUNK_OPS 65536          // work between clock checks, tens of microseconds
+#define BRANCH_OUTCOMES 65536
+#define THRASH_WAYS 32           // lines per eviction set, above common associativity
+#define THRASH_SETS 64
+#define THRASH_WAY_STRIDE (256 * 1024)
+#define CHASE_BYTES (64 * 1024 * 1024)
+
+typedef enum {
+    KERNEL_COMPUTE,
+    KERNEL_BRANCH,
+    KERNEL_MEMORY,
+    KERNEL_TLB,
+    KERNEL_ICACHE,
+    KERNEL_MIXED,
+    KERNEL_CACHE_THRASH,
+    KERNEL_MINING,
+    KERNEL_POINTER_CHASE,
+    NUM_KERNELS
+} kernel_t;
+
+static const char *kernel_names[NUM_KERNELS] = {
+    "compute", "branch", "memory", "tlb", "icache", "mixed",
+    "cache_thrash", "mining", "pointer_chase"
+};
+
+typedef struct {
+    kernel_t kernel;
+    double seconds;
+} phase_t;
+
+typedef struct {
+    kernel_t kernel;
+    double start;
+    double seconds;
+    bool active;
+    bool done;
+} injection_t;
+
+typedef struct {
+    double duration;
+    double branch_entropy;     // 0 = perfectly predictable, 1 = coin flips
+    size_t working_set;
+    size_t stride;
+    size_t pages;
+    size_t code_kb;
+    uint64_t seed;
+    phase_t phases[MAX_PHASES];
+    int num_phases;
+    injection_t injections[MAX_INJECTIONS];
+    int num_injections;
+} workload_t;
+
+// Volatile so the branch kernel keeps real conditional branches
+static volatile uint64_t taken_count;
+static volatile uint64_t not_taken_count;
+static uint64_t checksum;
+
+static uint8_t *branch_outcomes;
+static uint8_t *memory_buffer;
+static uint8_t *tlb_buffer;
+static uint8_t *thrash_buffer;
+static uint32_t *chase_buffer;
+static uint32_t chase_index;
+static size_t memory_offset;
+static size_t memory_lane;     // line within the stride the current pass uses
+static size_t tlb_page;
+static size_t code_cursor;
+static size_t code_functions;
+static uint64_t mining_nonce;
+
+static double wall_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static double monotonic_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static uint64_t next_random(uint64_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+// --- Code footprint: 1024 distinct functions, called round-robin over as
+// many as the requested footprint covers
+
+#define CODE_ROUND x = (x ^ (x >> 29)) * (0x9e3779b97f4a7c15ULL + 2 * __COUNTER__);
+#define CODE_FN(name) \
+    static __attribute__((noinline)) uint64_t code_##name(uint64_t x) { \
+        CODE_ROUND CODE_ROUND CODE_ROUND CODE_ROUND \
+        CODE_ROUND CODE_ROUND CODE_ROUND CODE_ROUND \
+        return x; \
+    }
+#define CODE_REF(name) code_##name,
+#define X4(M, p) M(p##0) M(p##1) M(p##2) M(p##3)
+#define X16(M, p) X4(M, p##0) X4(M, p##1) X4(M, p##2) X4(M, p##3)
+#define X64(M, p) X16(M, p##0) X16(M, p##1) X16(M, p##2) X16(M, p##3)
+#define X256(M, p) X64(M, p##0) X64(M, p##1) X64(M, p##2) X64(M, p##3)
+#define X1024(M, p) X256(M, p##0) X256(M, p##1) X256(M, p##2) X256(M, p##3)
+
+X1024(CODE_FN, f)
+
+typedef uint64_t (*code_fn_t)(uint64_t);
+static code_fn_t code_table[] = { X1024(CODE_REF, f) };
+#define NUM_CODE_FUNCTIONS (sizeof(code_table) / sizeof(code_table[0]))
+
+// Average function size from the address span the table covers
+static size_t code_function_bytes(void) {
+    uintptr_t lo = UINTPTR_MAX, hi = 0;
+    for (size_t i = 0; i < NUM_CODE_FUNCTIONS; i++) {
+        uintptr_t address = (uintptr_t)code_table[i];
+        if (address < lo) lo = address;
+        if (address > hi) hi = address;
+    }
+    size_t bytes = (hi - lo) / (NUM_CODE_FUNCTIONS - 1);
+    return bytes > 0 ? bytes : 1;
+}
+
+// --- SHA-256 compression, the inner loop of proof-of-work mining
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+static void sha256_compress(uint32_t state[8], const uint32_t block[16]) {
+    uint32_t w[64];
+    memcpy(w, block, 16 * sizeof(uint32_t));
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = ROTR(w[i - 15], 7) ^ ROTR(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = ROTR(w[i - 2], 17) ^ ROTR(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 64; i++) {
+        uint32_t t1 = h + (ROTR(e, 6) ^ ROTR(e, 11) ^ ROTR(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[i] + w[i];
+        uint32_t t2 = (ROTR(a, 2) ^ ROTR(a, 13) ^ ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+// --- Kernels: each does about CHUNK_OPS units of work and returns
+
+// Four independent multiply-add chains: ALU bound, high IPC, no memory traffic
+static void run_compute(void) {
+    uint64_t a = checksum, b = a + 1, c = a + 2, d = a + 3;
+    for (uint64_t i = 0; i < CHUNK_OPS / 4; i++) {
+        a = a * 6364136223846793005ULL + i;
+        b = b * 6364136223846793005ULL + i;
+        c = c * 6364136223846793005ULL + i;
+        d = d * 6364136223846793005ULL + i;
+    }
+    checksum = a ^ b ^ c ^ d;
+}
+
+static void run_branch(void) {
+    for (size_t i = 0; i < CHUNK_OPS; i++) {
+        if (branch_outcomes[i & (BRANCH_OUTCOMES - 1)]) taken_count++;
+        else not_taken_count++;
+    }
+}
+
+static void run_memory(const workload_t *w) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < CHUNK_OPS / 4; i++) {
+        memory_buffer[memory_offset]++;
+        sum += memory_buffer[memory_offset];
+        memory_offset += w->stride;
+        if (memory_offset >= w->working_set) {
+            memory_lane = (memory_lane + LINE_BYTES) % w->stride;
+            memory_offset = memory_lane;
+        }
+    }
+    checksum += sum;
+}
+
+// One line per page, at a rotating offset so the lines do not all share a cache set
+static void run_tlb(const workload_t *w) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < CHUNK_OPS / 8; i++) {
+        size_t page = (tlb_page * 2654435761u) % w->pages;
+        size_t offset = (page * LINE_BYTES) % PAGE_BYTES;
+        sum += tlb_buffer[page * PAGE_BYTES + offset]++;
+        tlb_page++;
+    }
+    checksum += sum;
+}
+
+static void run_icache(void) {
+    uint64_t x = checksum | 1;
+    for (size_t i = 0; i < CHUNK_OPS / 32; i++) {
+        x = code_table[code_cursor](x);
+        if (++code_cursor >= code_functions) code_cursor = 0;
+    }
+    checksum = x;
+}
+
+// Prime+probe style: walk eviction sets far larger than the cache ways
+static void run_cache_thrash(void) {
+    uint64_t sum = 0;
+    for (size_t i = 0; i < CHUNK_OPS / 16; i++) {
+        size_t set = i % THRASH_SETS;
+        for (size_t way = 0; way < THRASH_WAYS; way++) {
+            sum += thrash_buffer[way * THRASH_WAY_STRIDE + set * LINE_BYTES]++;
+        }
+    }
+    checksum += sum;
+}
+
+static void run_mining(void) {
+    uint32_t block[16] = {0};
+    for (size_t i = 0; i < CHUNK_OPS / 512; i++) {
+        uint32_t state[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+            0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+        block[3] = (uint32_t)mining_nonce++;
+        sha256_compress(state, block);
+        checksum += state[0];
+    }
+}
+
+// Dependent loads over a random cycle, so every access misses
+static void run_pointer_chase(void) {
+    uint32_t index = chase_index;
+    for (size_t i = 0; i < CHUNK_OPS / 16; i++) index = chase_buffer[index];
+    chase_index = index;
+    checksum += index;
+}
+
+static void run_kernel(const workload_t *w, kernel_t kernel) {
+    switch (kernel) {
+        case KERNEL_COMPUTE: run_compute(); break;
+        case KERNEL_BRANCH: run_branch(); break;
+        case KERNEL_MEMORY: run_memory(w); break;
+        case KERNEL_TLB: run_tlb(w); break;
+        case KERNEL_ICACHE: run_icache(); break;
+        case KERNEL_MIXED:
+            run_branch();
+            run_memory(w);
+            run_tlb(w);
+            run_icache();
+            break;
+        case KERNEL_CACHE_THRASH: run_cache_thrash(); break;
+        case KERNEL_MINING: run_mining(); break;
+        case KERNEL_POINTER_CHASE: run_pointer_chase(); break;
+        default: break;
+    }
+}
+
+static int parse_kernel(const char *name, size_t length, kernel_t *kernel) {
+    for (int k = 0; k < NUM_KERNELS; k++) {
+        if (strlen(kernel_names[k]) == length && strncmp(kernel_names[k], name, length) == 0) {
+            *kernel = (kernel_t)k;
+            return 0;
+        }
+    }
+    fprintf(stderr, "Unknown kernel: %.*s\n", (int)length, name);
+    return -1;
+}
+
+// Sizes accept K, M and G suffixes
+static int parse_size(const char *text, size_t *value) {
+    char *end;
+    double number = strtod(text, &end);
+    if (end == text || number < 0) return -1;
+    switch (*end) {
+        case 'k': case 'K': number *= 1024; end++; break;
+        case 'm': case 'M': number *= 1024 * 1024; end++; break;
+        case 'g': case 'G': number *= 1024.0 * 1024 * 1024; end++; break;
+        default: break;
+    }
+    if (*end != '\0') return -1;
+    *value = (size_t)number;
+    return 0;
+}
+
+// "compute:2,branch:3,mixed:5", repeated until the duration is used up
+static int parse_phases(workload_t *w, const char *spec) {
+    w->num_phases = 0;
+    const char *cursor = spec;
+    while (*cursor) {
+        const char *colon = strchr(cursor, ':');
+        const char *comma = strchr(cursor, ',');
+        if (!comma) comma = cursor + strlen(cursor);
+        if (w->num_phases >= MAX_PHASES || !colon || colon > comma) {
+            fprintf(stderr, "Invalid phase schedule: %s\n", spec);
+            return -1;
+        }
+        phase_t *phase = &w->phases[w->num_phases++];
+        if (parse_kernel(cursor, colon - cursor, &phase->kernel) != 0) return -1;
+        phase->seconds = atof(colon + 1);
+        if (phase->seconds <= 0) {
+            fprintf(stderr, "Invalid phase length in: %s\n", spec);
+            return -1;
+        }
+        cursor = *comma ? comma + 1 : comma;
+    }
+    return w->num_phases > 0 ? 0 : -1;
+}
+
+// "pointer_chase@5:3" runs pointer chasing from second 5 for 3 seconds
+static int parse_injection(workload_t *w, const char *spec) {
+    const char *at = strchr(spec, '@');
+    if (w->num_injections >= MAX_INJECTIONS || !at) {
+        fprintf(stderr, "Invalid injection: %s\n", spec);
+        return -1;
+    }
+    injection_t *injection = &w->injections[w->num_injections];
+    memset(injection, 0, sizeof(*injection));
+    if (parse_kernel(spec, at - spec, &injection->kernel) != 0) return -1;
+    if (injection->kernel < KERNEL_CACHE_THRASH) {
+        fprintf(stderr, "Injections must be cache_thrash, mining or pointer_chase\n");
+        return -1;
+    }
+    char *end;
+    injection->start = strtod(at + 1, &end);
+    injection->seconds = *end == ':' ? atof(end + 1) : 5.0;
+    if (injection->start < 0 || injection->seconds <= 0) {
+        fprintf(stderr, "Invalid injection time: %s\n", spec);
+        return -1;
+    }
+    w->num_injections++;
+    return 0;
+}
+
+// monotonic is CLOCK_MONOTONIC at the event; elapsed is relative to the
+// start of the schedule, negative for the exec event before buffer setup
+static void log_event(FILE *log, const char *event, kernel_t kernel, double monotonic, double elapsed) {
+    fprintf(log, "{\"event\": \"%s\", \"kernel\": \"%s\", \"wall_time\": %.6f, \"monotonic\": %.9f, "
+                 "\"elapsed\": %.6f, \"pid\": %d}\n",
+            event, kernel_names[kernel], wall_seconds(), monotonic, elapsed, (int)getpid());
+    fflush(log);
+}
+
+static bool uses_kernel(const workload_t *w, kernel_t kernel) {
+    for (int i = 0; i < w->num_phases; i++) {
+        if (w->phases[i].kernel == kernel) return true;
+        if (w->phases[i].kernel == KERNEL_MIXED && kernel >= KERNEL_BRANCH && kernel <= KERNEL_ICACHE) return true;
+    }
+    for (int i = 0; i < w->num_injections; i++) {
+        if (w->injections[i].kernel == kernel) return true;
+    }
+    return false;
+}
+
+// Touches every page up front so page faults do not land in the first phase
+static void *alloc_buffer(size_t bytes) {
+    void *buffer = NULL;
+    if (posix_memalign(&buffer, PAGE_BYTES, bytes) != 0) return NULL;
+    memset(buffer, 1, bytes);
+    return buffer;
+}
+
+static int setup_buffers(workload_t *w) {
+    uint64_t rng = w->seed;
+
+    if (uses_kernel(w, KERNEL_BRANCH)) {
+        branch_outcomes = malloc(BRANCH_OUTCOMES);
+        if (!branch_outcomes) return -1;
+        for (size_t i = 0; i < BRANCH_OUTCOMES; i++) {
+            // With probability `entropy` the outcome is a coin flip,
+            // otherwise it follows a short periodic pattern
+            double u = (next_random(&rng) >> 11) * (1.0 / 9007199254740992.0);
+            branch_outcomes[i] = u < w->branch_entropy ? (next_random(&rng) & 1) : ((i % 4) != 0);
+        }
+    }
+    if (uses_kernel(w, KERNEL_MEMORY) && !(memory_buffer = alloc_buffer(w->working_set))) return -1;
+    if (uses_kernel(w, KERNEL_TLB) && !(tlb_buffer = alloc_buffer(w->pages * PAGE_BYTES))) return -1;
+    if (uses_kernel(w, KERNEL_CACHE_THRASH) &&
+        !(thrash_buffer = alloc_buffer((size_t)THRASH_WAYS * THRASH_WAY_STRIDE))) {
+        return -1;
+    }
+    if (uses_kernel(w, KERNEL_POINTER_CHASE)) {
+        // Sattolo's shuffle gives a single cycle through every slot
+        size_t slots = CHASE_BYTES / sizeof(uint32_t);
+        chase_buffer = malloc(CHASE_BYTES);
+        if (!chase_buffer) return -1;
+        for (size_t i = 0; i < slots; i++) chase_buffer[i] = (uint32_t)i;
+        for (size_t i = slots - 1; i > 0; i--) {
+            size_t j = next_random(&rng) % i;
+            uint32_t tmp = chase_buffer[i];
+            chase_buffer[i] = chase_buffer[j];
+            chase_buffer[j] = tmp;
+        }
+    }
+
+    code_functions = w->code_kb * 1024 / code_function_bytes();
+    if (code_functions < 1) code_functions = 1;
+    if (code_functions > NUM_CODE_FUNCTIONS) code_functions = NUM_CODE_FUNCTIONS;
+    return 0;
+}
+
+void print_usage(const char *program_name) {
+    printf("Usage: %s [OPTIONS]\n", program_name);
+    printf("Synthetic workload for baseline collection, detection accuracy and overhead runs\n\n");
+    printf("Options:\n");
+    printf("  -d, --duration SEC         Total run time (default: 10)\n");
+    printf("  -b, --branch-entropy P     Fraction of unpredictable branches, 0..1 (default: 0.5)\n");
+    printf("  -w, --working-set SIZE     Memory kernel footprint, K/M/G suffixes (default: 4M)\n");
+    printf("  -s, --stride SIZE          Memory kernel stride (default: 64)\n");
+    printf("  -t, --pages N              Pages the TLB kernel spreads over (default: 1024)\n");
+    printf("  -c, --code-kb KB           Instruction footprint of the icache kernel (default: 64)\n");
+    printf("  -p, --phases SCHEDULE      kernel:seconds list, cycled (default: mixed:10)\n");
+    printf("                             kernels: compute, branch, memory, tlb, icache, mixed\n");
+    printf("  -i, --inject KIND@SEC[:LEN] Switch to an anomalous kernel at SEC for LEN seconds (default 5);\n");
+    printf("                             kinds: cache_thrash, mining, pointer_chase. Repeatable\n");
+    printf("  -l, --log FILE             Write phase and injection events here (default: stderr)\n");
+    printf("  -S, --seed N               Random seed for branch outcomes and chase order (default: 1)\n");
+    printf("  -h, --help                 Show this help message\n");
+    printf("\nExamples:\n");
+    printf("  %s --phases compute:2,branch:2,memory:2 --duration 30\n", program_name);
+    printf("  %s --working-set 64M --stride 4096 --inject pointer_chase@20:5 --log events.jsonl\n",
+           program_name);
+}
+
+int main(int argc, char *argv[]) {
+    // Counting under perf starts at exec; the exec event lets a harness
+    // place injections on perf's time axis
+    double exec_time = monotonic_seconds();
+    workload_t w;
+    memset(&w, 0, sizeof(w));
+    w.duration = 10.0;
+    w.branch_entropy = 0.5;
+    w.working_set = 4 * 1024 * 1024;
+    w.stride = LINE_BYTES;
+    w.pages = 1024;
+    w.code_kb = 64;
+    w.seed = 1;
+    const char *log_file = NULL;
+    bool phases_set = false;
+    int opt;
+
+    static struct option long_options[] = {
+        {"duration",       required_argument, 0, 'd'},
+        {"branch-entropy", required_argument, 0, 'b'},
+        {"working-set",    required_argument, 0, 'w'},
+        {"stride",         required_argument, 0, 's'},
+        {"pages",          required_argument, 0, 't'},
+        {"code-kb",        required_argument, 0, 'c'},
+        {"phases",         required_argument, 0, 'p'},
+        {"inject",         required_argument, 0, 'i'},
+        {"log",            required_argument, 0, 'l'},
+        {"seed",           required_argument, 0, 'S'},
+        {"help",           no_argument,       0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    while ((opt = getopt_long(argc, argv, "d:b:w:s:t:c:p:i:l:S:h", long_options, NULL)) != -1) {
+        switch (opt) {
+            case 'd':
+                w.duration = atof(optarg);
+                break;
+            case 'b':
+                w.branch_entropy = atof(optarg);
+                break;
+            case 'w':
+                if (parse_size(optarg, &w.working_set) != 0) {
+                    fprintf(stderr, "Invalid working set: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 's':
+                if (parse_size(optarg, &w.stride) != 0) {
+                    fprintf(stderr, "Invalid stride: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 't':
+                w.pages = strtoul(optarg, NULL, 10);
+                break;
+            case 'c':
+                w.code_kb = strtoul(optarg, NULL, 10);
+                break;
+            case 'p':
+                if (parse_phases(&w, optarg) != 0) return 1;
+                phases_set = true;
+                break;
+            case 'i':
+                if (parse_injection(&w, optarg) != 0) return 1;
+                break;
+            case 'l':
+                log_file = optarg;
+                break;
+            case 'S':
+                w.seed = strtoull(optarg, NULL, 0);
+                if (w.seed == 0) w.seed = 1;
+                break;
+            case 'h':
+                print_usage(argv[0]);
+                return 0;
+            default:
+                print_usage(argv[0]);
+                return 1;
+        }
+    }
+
+    if (w.duration <= 0 || w.branch_entropy < 0 || w.branch_entropy > 1 || w.pages == 0 ||
+        w.stride == 0 || w.working_set < w.stride) {
+        fprintf(stderr, "Invalid workload parameters\n");
+        return 1;
+    }
+    if (!phases_set) {
+        w.phases[0].kernel = KERNEL_MIXED;
+        w.phases[0].seconds = w.duration;
+        w.num_phases = 1;
+    }
+
+    FILE *log = stderr;
+    if (log_file) {
+        log = fopen(log_file, "w");
+        if (!log) {
+            fprintf(stderr, "Cannot open log file: %s\n", log_file);
+            return 1;
+        }
+    }
+
+    if (setup_buffers(&w) != 0) {
+        fprintf(stderr, "Cannot allocate workload buffers\n");
+        return 1;
+    }
+
+    printf("Running synthetic workload: %.1fs, %d phase(s), %d injection(s), "
+           "branch entropy %.2f, working set %zu B / stride %zu B, %zu pages, %zu KB code\n",
+           w.duration, w.num_phases, w.num_injections, w.branch_entropy, w.working_set, w.stride,
+           w.pages, code_functions * code_function_bytes() / 1024);
+    fflush(stdout);
+
+    double start = monotonic_seconds();
+    double elapsed = 0.0;
+    double phase_end = 0.0;
+    int phase = -1;
+    uint64_t chunks = 0;
+    log_event(log, "exec", w.phases[0].kernel, exec_time, exec_time - start);
+
+    while ((elapsed = monotonic_seconds() - start) < w.duration) {
+        if (elapsed >= phase_end) {
+            phase = (phase + 1) % w.num_phases;
+            phase_end += w.phases[phase].seconds;
+            log_event(log, "phase", w.phases[phase].kernel, start + elapsed, elapsed);
+        }
+
+        // An active injection replaces the scheduled phase
+        kernel_t kernel = w.phases[phase].kernel;
+        for (int i = 0; i < w.num_injections; i++) {
+            injection_t *injection = &w.injections[i];
+            if (!injection->active && !injection->done && elapsed >= injection->start) {
+                injection->active = true;
+                log_event(log, "inject_start", injection->kernel, start + elapsed, elapsed);
+            }
+            if (injection->active && elapsed >= injection->start + injection->seconds) {
+                injection->active = false;
+                injection->done = true;
+                log_event(log, "inject_end", injection->kernel, start + elapsed, elapsed);
+            }
+            if (injection->active) kernel = injection->kernel;
+        }
+
+        run_kernel(&w, kernel);
+        chunks++;
+    }
+
+    for (int i = 0; i < w.num_injections; i++) {
+        if (w.injections[i].active) {
+            log_event(log, "inject_end", w.injections[i].kernel, start + elapsed, elapsed);
+        }
+    }
+
+    printf("Workload completed: %lu chunks, checksum %lu\n", (unsigned long)chunks,
+           (unsigned long)(checksum + taken_count - not_taken_count));
+
+    if (log != stderr) fclose(log);
+    free(branch_outcomes);
+    free(memory_buffer);
+    free(tlb_buffer);
+    free(thrash_buffer);
+    free(chase_buffer);
+    return 0;
+}